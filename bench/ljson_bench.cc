@@ -0,0 +1,115 @@
+/*
+ * Throughput of the parse modes, stringify and free, in MB/s of json text.
+ *
+ *     Bench [file.json] [runs]
+ *
+ * Without a file a json of about 16 MB is generated: an array of records with
+ * integers, doubles, short and long strings, escapes and small nested containers.
+ * Every figure is the best of the runs.
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include "lightjson.h"
+
+using namespace ljson;
+
+static std::string generate(size_t size) {
+    std::string json = "[";
+    unsigned seed = 12345;
+    for (size_t i = 0; json.size() < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        char buf[512];
+        snprintf(buf, sizeof(buf),
+            "%s{\"id\":%zu,\"score\":%u.%03u,\"active\":%s,\"name\":\"user_%u\","
+            "\"description_of_the_record\":\"a somewhat longer string value, with \\\"escapes\\\" \\u00e9 and \\n\","
+            "\"tags\":[\"a\",\"bb\",\"ccc\"],\"position\":{\"x\":%d,\"y\":-%d.5e-3},\"parent\":null}",
+            i == 0 ? "" : ",\n  ", i, seed % 1000, seed % 997, (seed & 1) ? "true" : "false",
+            seed % 100000, (int)(seed % 4096), (int)(seed % 777));
+        json += buf;
+    }
+    json += "]";
+    return json;
+}
+
+template <typename Function>
+static double best_seconds(int runs, Function function) {
+    double best = 1e30;
+    for (int i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+static void report(const char* name, size_t bytes, double seconds) {
+    printf("%-28s %10.1f MB/s\n", name, bytes / seconds / (1024.0 * 1024.0));
+}
+
+int main(int argc, char* argv[]) {
+    std::string json;
+    if (argc > 1) {
+        std::ifstream in(argv[1], std::ios::binary);
+        if (!in) {
+            std::cerr << "cannot read " << argv[1] << std::endl;
+            return 1;
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        json = buffer.str();
+    } else {
+        json = generate(16 * 1024 * 1024);
+    }
+    int runs = argc > 2 ? atoi(argv[2]) : 10;
+    printf("%zu bytes, best of %d runs\n", json.size(), runs);
+
+    report("ljson_parse + ljson_free", json.size(), best_seconds(runs, [&]() {
+        ljson_value v;
+        ljson_init(&v);
+        if (ljson_parse(&v, json.data(), json.size()) != LJSON_PARSE_OK)
+            abort();
+        ljson_free(&v);
+    }));
+
+    Document document;
+    report("Document::Parse", json.size(), best_seconds(runs, [&]() {
+        if (document.Parse(json.data(), json.size()) != LJSON_PARSE_OK)
+            abort();
+    }));
+
+    std::string copy;
+    report("Document::ParseInsitu", json.size(), best_seconds(runs, [&]() {
+        copy = json;
+        if (document.ParseInsitu(&copy[0], copy.size()) != LJSON_PARSE_OK)
+            abort();
+    }));
+
+    report("ljson_parse_parallel", json.size(), best_seconds(runs, [&]() {
+        ljson_arena arena;
+        ljson_value v;
+        ljson_init(&v);
+        if (ljson_parse_parallel(&v, json.data(), json.size(), 0, &arena) != LJSON_PARSE_OK)
+            abort();
+        ljson_free(&v);
+    }));
+
+    ljson_value v;
+    ljson_init(&v);
+    if (ljson_parse(&v, json.data(), json.size()) != LJSON_PARSE_OK)
+        abort();
+    std::string out;
+    report("ljson_stringify", json.size(), best_seconds(runs, [&]() {
+        out.clear();
+        ljson_stringify(&v, out);
+    }));
+    ljson_free(&v);
+    return 0;
+}
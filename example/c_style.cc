@@ -2,24 +2,22 @@
 #include <fstream>
 #include <string>
 #include <cassert>
-#include <streambuf>
 #include "lightjson.h"
 
 int main() {
 	ljson::ljson_value v;
     ljson_init(&v);
 	
-	std::ifstream json_file("../example.json");
 	std::ofstream out_file("../output.json");
-	std::string str((std::istreambuf_iterator<char>(json_file)),  
-					std::istreambuf_iterator<char>()); 
-	std::cout << "Origin json:" << std::endl;
-	std::cout << str << std::endl << std::endl;
-    int ret = ljson_parse(&v, str);
+    int ret = ljson_parse_file(&v, "../example.json");
 	if (ret != 0) {
 		std::cerr << "Parse Fail!" << std::endl;
 		return 1;
  	}
+	std::string str;
+	ljson_stringify(&v, str);
+	std::cout << "Parsed json:" << std::endl;
+	std::cout << str << std::endl << std::endl;
 	std::cout << "Success!" << std::endl;
 
 	ljson::ljson_value & v_i = ljson::objectAccess(&v, "i");
@@ -1,24 +1,19 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <streambuf>
 #include "lightjson.h"
 
 int main() {
 	
-	std::ifstream json_file("../example.json");
 	std::ofstream out_file("../output.json");
-	std::string str((std::istreambuf_iterator<char>(json_file)),  
-					std::istreambuf_iterator<char>()); 
-	std::cout << "Origin json:" << std::endl;
-    std::cout << str << std::endl << std::endl;
-    
     ljson::Document js;
-    int ret = js.Parse(str);
+    int ret = js.ParseFile("../example.json");
 	if (ret != 0){
 		std::cerr << "Parse Fail!" << std::endl;
 		return 1;
  	}
+	std::cout << "Parsed json:" << std::endl;
+    std::cout << js << std::endl << std::endl;
 	std::cout << "Success!" << std::endl;
 
 	ljson::Value v = js["i"];
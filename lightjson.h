@@ -14,18 +14,331 @@
 #include <cassert>
 #include <iostream>
 #include <cassert>
-#include <cerrno>
 #include <cmath>
 #include <cstring>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#if defined(__unix__) || defined(__APPLE__)
+#define LJSON_HAS_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define LJSON_HAS_STRING_VIEW
+#endif
+
+/* define LJSON_NO_SIMD to build the scalar parser only */
+#if !defined(LJSON_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+#define LJSON_SSE2
+#include <emmintrin.h>
+#endif
+#if !defined(LJSON_NO_SIMD) && defined(__AVX2__)
+#define LJSON_AVX2
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) \
+    || defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+#define LJSON_LITTLE_ENDIAN
+#endif
 
 namespace ljson {
 
 /*! \brief the basic type of the json struct*/
 typedef enum { LJSON_NULL, LJSON_FALSE, LJSON_TRUE, LJSON_NUMBER, LJSON_STRING, LJSON_ARRAY, LJSON_OBJECT } ljson_type;
 
+/*! \brief the storage flags of a ljson_value*/
+enum {
+    LJSON_FLAG_ARENA = 0x01,    /*!< the payload lives in a ljson_arena, never delete it */
+    LJSON_FLAG_INT64 = 0x02,    /*!< the number is stored in mint64 */
+    LJSON_FLAG_UINT64 = 0x04,   /*!< the number is stored in muint64 */
+    LJSON_FLAG_INSITU = 0x08,   /*!< the string is a slice of the buffer given to ljson_parse_insitu */
+    LJSON_FLAG_SLICE = LJSON_FLAG_ARENA | LJSON_FLAG_INSITU,   /*!< the string is in mslice */
+    LJSON_FLAG_LAZY = 0x10,     /*!< the container is not decoded yet, mlazy finds its json text, see ljson_parse_lazy */
+    LJSON_FLAG_SHORT = 0x20,    /*!< the string is in mshort, see LJSON_SHORT_STRING_MAX */
+    /*!
+     * the container and everything in it live in arenas, buffers or a KeyPool, so ljson_free has nothing
+     * to release there and does not walk it. A parse with an arena sets it, the accessors which hand
+     * out the children for writing clear it
+     */
+    LJSON_FLAG_ARENA_TREE = 0x40
+};
+
+/*! \brief the longest string which is stored inside its ljson_value, without an allocation */
+const size_t LJSON_SHORT_STRING_MAX = 13;
+
+/*! \brief the storage of a LJSON_NUMBER */
+typedef enum { LJSON_NUMBER_DOUBLE, LJSON_NUMBER_INT64, LJSON_NUMBER_UINT64 } ljson_number_type;
+
 typedef struct ljson_value ljson_value;
 typedef struct ljson_member ljson_member;
 
+/*!
+ * \brief a chunked bump allocator. Every allocation is a pointer bump,
+ *          all the memory is released at once by clear() or the destructor
+ */
+class ljson_arena {
+public:
+    explicit ljson_arena(size_t chunk_size = 64 * 1024)
+        : mhead(nullptr), mfree(nullptr), mptr(nullptr), mend(nullptr), mchunk_size(chunk_size) { }
+    ~ljson_arena() { clear(); }
+    ljson_arena(const ljson_arena &) = delete;
+    ljson_arena & operator=(const ljson_arena &) = delete;
+    ljson_arena(ljson_arena && other) noexcept : ljson_arena(other.mchunk_size) { swap(other); }
+    ljson_arena & operator=(ljson_arena && other) noexcept {
+        clear();
+        swap(other);
+        return *this;
+    }
+
+    void swap(ljson_arena & other) noexcept {
+        std::swap(mhead, other.mhead);
+        std::swap(mfree, other.mfree);
+        std::swap(mptr, other.mptr);
+        std::swap(mend, other.mend);
+        std::swap(mchunk_size, other.mchunk_size);
+    }
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        char* p = align_up(mptr, align);
+        if (mptr == nullptr || size > size_t(mend - p)) {
+            add_chunk(size + align);
+            p = align_up(mptr, align);
+        }
+        mptr = p + size;
+        return p;
+    }
+
+    /*! \brief take the allocations of other, they live until this arena releases them. other keeps its free chunks */
+    void splice(ljson_arena & other) {
+        while (other.mhead != nullptr) {
+            chunk* c = other.mhead;
+            other.mhead = c->next;
+            /* behind the head, whose free space is still bumped */
+            if (mhead != nullptr) {
+                c->next = mhead->next;
+                mhead->next = c;
+            } else {
+                c->next = nullptr;
+                mhead = c;
+            }
+        }
+        other.mptr = other.mend = nullptr;
+    }
+
+    /*! \brief release all the allocations but keep the chunks for the next ones, every pointer from this arena becomes invalid */
+    void reset() {
+        while (mhead != nullptr) {
+            chunk* next = mhead->next;
+            mhead->next = mfree;
+            mfree = mhead;
+            mhead = next;
+        }
+        mptr = mend = nullptr;
+    }
+
+    /*! \brief release all the chunks, every pointer from this arena becomes invalid */
+    void clear() {
+        reset();
+        while (mfree != nullptr) {
+            chunk* next = mfree->next;
+            ::operator delete(mfree);
+            mfree = next;
+        }
+    }
+
+private:
+    struct chunk {
+        chunk* next;
+        size_t capacity;
+    };
+
+    static char* align_up(char* p, size_t align) {
+        return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + align - 1) & ~(uintptr_t)(align - 1));
+    }
+
+    void add_chunk(size_t min_size) {
+        chunk* c = nullptr;
+        for (chunk** link = &mfree; *link != nullptr; link = &(*link)->next) {
+            if ((*link)->capacity >= min_size) {
+                c = *link;
+                *link = c->next;
+                break;
+            }
+        }
+        if (c == nullptr) {
+            size_t capacity = min_size > mchunk_size ? min_size : mchunk_size;
+            c = static_cast<chunk*>(::operator new(sizeof(chunk) + capacity));
+            c->capacity = capacity;
+        }
+        c->next = mhead;
+        mhead = c;
+        mptr = reinterpret_cast<char*>(c + 1);
+        mend = mptr + c->capacity;
+    }
+
+    chunk* mhead;
+    chunk* mfree;           /*!< the chunks kept by reset() */
+    char* mptr;
+    char* mend;
+    size_t mchunk_size;
+};
+
+/*!
+ * \brief a whole file in memory: mapped where mmap is available and read into a buffer
+ *          elsewhere, or when the file cannot be mapped. A writable view is private,
+ *          the writes never reach the file
+ */
+class ljson_mapped_file {
+public:
+    ljson_mapped_file() : mdata(nullptr), msize(0), mmapped(false), mempty(0) { }
+    ~ljson_mapped_file() { close(); }
+    ljson_mapped_file(const ljson_mapped_file &) = delete;
+    ljson_mapped_file & operator=(const ljson_mapped_file &) = delete;
+
+    void swap(ljson_mapped_file & other) noexcept {
+        std::swap(mdata, other.mdata);
+        std::swap(msize, other.msize);
+        std::swap(mmapped, other.mmapped);
+        mbuffer.swap(other.mbuffer);
+    }
+
+    /*! \brief load the file at path, false if it cannot be opened or read */
+    bool open(const char* path, bool writable = false) {
+        assert(path != nullptr);
+        close();
+#ifdef LJSON_HAS_MMAP
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)st.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                /* read ahead, the parse goes through the file once from the start */
+                madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+                mdata = static_cast<char*>(p);
+                msize = (size_t)st.st_size;
+                mmapped = true;
+            }
+        }
+        bool ok = true;
+        for (char chunk[64 * 1024]; !mmapped; ) {
+            ssize_t n = ::read(fd, chunk, sizeof(chunk));
+            if (n <= 0) {
+                ok = n == 0;
+                break;
+            }
+            mbuffer.insert(mbuffer.end(), chunk, chunk + n);
+        }
+        ::close(fd);
+#else
+        (void)writable;
+        FILE* f = fopen(path, "rb");
+        if (f == nullptr)
+            return false;
+        char chunk[64 * 1024];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+            mbuffer.insert(mbuffer.end(), chunk, chunk + n);
+        bool ok = ferror(f) == 0;
+        fclose(f);
+#endif
+        if (!ok) {
+            close();
+            return false;
+        }
+        if (!mmapped) {
+            mdata = mbuffer.data();
+            msize = mbuffer.size();
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef LJSON_HAS_MMAP
+        if (mmapped)
+            munmap(mdata, msize);
+#endif
+        std::vector<char>().swap(mbuffer);
+        mdata = nullptr;
+        msize = 0;
+        mmapped = false;
+    }
+
+    /*! \brief the content, it needs no padding nor terminating NUL to be parsed */
+    char* data() { return msize != 0 ? mdata : &mempty; }
+    size_t size() const { return msize; }
+
+private:
+    char* mdata;
+    size_t msize;
+    bool mmapped;
+    char mempty;                /*!< the data of an empty file */
+    std::vector<char> mbuffer;  /*!< the content when it is not mapped */
+};
+
+/*!
+ * \brief the allocator of the containers in ljson_value,
+ *          use the arena if it has one, or the global new/delete
+ */
+template <typename T>
+class ljson_allocator {
+public:
+    typedef T value_type;
+
+    ljson_allocator() : marena(nullptr) { }
+    explicit ljson_allocator(ljson_arena* arena) : marena(arena) { }
+    template <typename U>
+    ljson_allocator(const ljson_allocator<U> & other) : marena(other.arena()) { }
+
+    T* allocate(size_t n) {
+        if (marena != nullptr)
+            return static_cast<T*>(marena->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t) {
+        if (marena == nullptr)
+            ::operator delete(p);
+    }
+
+    ljson_arena* arena() const { return marena; }
+
+private:
+    ljson_arena* marena;
+};
+
+template <typename T, typename U>
+inline bool operator==(const ljson_allocator<T> & a, const ljson_allocator<U> & b) { return a.arena() == b.arena(); }
+template <typename T, typename U>
+inline bool operator!=(const ljson_allocator<T> & a, const ljson_allocator<U> & b) { return a.arena() != b.arena(); }
+
+/*!
+ * \brief the container of the json array. It was std::vector<ljson_value> before the arena:
+ *          the allocator makes it another type, so a std::vector<ljson_value> & can not bind
+ *          to getArray any more. Use ljson_array, or auto, or copy the elements out
+ */
+typedef std::vector<ljson_value, ljson_allocator<ljson_value> > ljson_array;
+class ljson_map;
+struct ljson_lazy_table;
+
 /////////////////////////
 /* The C Stype API     */
 /////////////////////////
@@ -37,81 +350,83 @@ typedef struct ljson_member ljson_member;
  */
 void ljson_free(ljson_value* v);
 
+/*!
+ * \brief decode one level of a lazy container of ljson_parse_lazy, the containers in it stay lazy.
+ *          The accessors of the containers call it, it does nothing on the other values.
+ *          A container is decoded once under a lock, into the arena of the tree,
+ *          so several threads may read the same lazy tree through the const accessors. Writing to the tree still needs the usual exclusion,
+ *          and so does getString of a non-const ljson_value, which may move the string into a std::string
+ * \return ljson_state, LJSON_PARSE_OK unless a member fails to decode, then the container
+ *          keeps the members before it. ljson_parse_lazy checks the same errors as ljson_parse, so it does not happen
+ */
+int ljson_expand(const ljson_value* v);
+
 /*!
  * \brief initailize a ljson_value, use it after declaration
  * \param v the pointer of ljson_value you want to initailize
  */
 inline void ljson_init(ljson_value* v);
-/*! \brief the inner struct of a json, can present all kind of ljson_type*/
-struct ljson_value {
+/*!
+ * \brief the inner struct of a json, can present all kind of ljson_type. It takes 16 bytes:
+ *          the data is packed into 14 of them, so that the type and the flags fit behind it
+ */
+#pragma pack(push, 2)
+struct alignas(8) ljson_value {
     union __data {
-        std::map<std::string, ljson_value> * mobject; /*!< object */
+        ljson_map * mobject;                    /*!< object */
         std::string * mstring;                  /*!< string */
-        std::vector<ljson_value> * marray;      /*!< array */
+        ljson_array * marray;                   /*!< array */
         double mdouble;                         /*!< number */
+        int64_t mint64;                         /*!< integer number */
+        uint64_t muint64;                       /*!< integer number above INT64_MAX */
+        struct {
+            const char * ptr;
+            uint32_t len;
+        } mslice;                               /*!< string in a ljson_arena or an insitu buffer, below 4 GiB */
+        struct {
+            const ljson_lazy_table * table;
+            uint32_t index;
+        } mlazy;                                /*!< lazy container, an entry of the table of ljson_parse_lazy */
+        char mshort[LJSON_SHORT_STRING_MAX + 1];  /*!< short string, its NUL and LJSON_SHORT_STRING_MAX - length in the last byte */
     } data;                         /*!< data part of ljson_value */
-    ljson_type type;                /*!< typr of this ljson_value */
+    ljson_type type : 8;            /*!< typr of this ljson_value */
+    unsigned char flags;            /*!< storage flags, see LJSON_FLAG_ARENA and the others */
 
-    void free() {
-        switch(type) {
-            case LJSON_STRING:
-                assert(data.mstring != nullptr);
-                delete data.mstring;
-                break;
-            case LJSON_ARRAY:
-                assert(data.marray != nullptr);
-                for (auto iter = (data.marray)->begin(); iter != (data.marray)->end(); iter++)
-                    ljson_free(&(*iter));
-                delete data.marray;
-                break;
-            case LJSON_OBJECT:
-                assert(data.mobject != nullptr);
-                for (auto iter = (data.mobject)->begin(); iter != (data.mobject)->end(); iter++)
-                    ljson_free(&(*iter).second);
-                delete data.mobject;
-                break;
-            default:
-                break;
-        }
-        type = LJSON_NULL;
+    ljson_value() { ljson_init(this); }
+    /*! \brief a shallow copy which shares the children, free only one of the two. See copyfrom for a deep copy */
+    ljson_value(const ljson_value &) = default;
+    ljson_value & operator=(const ljson_value &) = default;
+    /*! \brief take the content of other in O(1), other becomes a null */
+    ljson_value(ljson_value && other) noexcept : data(other.data), type(other.type), flags(other.flags) {
+        ljson_init(&other);
     }
-
-    void copyfrom(const ljson_value & copy) {
-        size_t sz;
-        free();
-        switch (copy.type) {
-            case LJSON_NUMBER:
-                data.mdouble = copy.data.mdouble; break;
-            case LJSON_STRING:
-                data.mstring = new std::string();
-                data.mstring->assign(*(copy.data.mstring));
-                break;
-            case LJSON_ARRAY:
-                sz = copy.data.marray->size();
-                data.marray = new std::vector<ljson_value>(sz);
-                //data.marray->assign(copy.data.marray->begin(), copy.data.marray->end());
-                for (size_t i = 0; i < sz; i++) {
-                    ljson_init(&(*data.marray)[i]);
-                    (*data.marray)[i].copyfrom((*copy.data.marray)[i]);
-                }
-                break;
-            case LJSON_OBJECT:
-                data.mobject = new std::map<std::string, ljson_value>;
-                for (auto iter = (copy.data.mobject)->begin(); iter != (copy.data.mobject)->end(); iter++) {
-                    // ljson_value tmp;
-                    // ljson_init(&tmp);
-                    // (*data.mobject)[iter->first] = iter->second;
-                    ljson_init(&(*data.mobject)[iter->first]);
-                    (*data.mobject)[iter->first].copyfrom(iter->second);
-                }
-                //data.mobject->insert(copy.data.mobject->begin(), copy.data.mobject->end());
-                break;
-            default:
-                break;
-        }
-        type = copy.type;
+    /*!
+     * \brief free this value and take the content of other in O(1), other becomes a null.
+     *          other may be inside this value. The storage comes along: a value of an arena
+     *          still lives in that arena
+     */
+    ljson_value & operator=(ljson_value && other) noexcept {
+        ljson_value content(std::move(other));
+        ljson_free(this);
+        swap(content);
+        return *this;
     }
+    /*! \brief exchange the contents in O(1) */
+    void swap(ljson_value & other) noexcept {
+        std::swap(data, other.data);
+        ljson_type t = type;
+        type = other.type;
+        other.type = t;
+        std::swap(flags, other.flags);
+    }
+
+    void free() { ljson_free(this); }
+
+    /*! \brief a deep copy of copy, this value is freed first */
+    void copyfrom(const ljson_value & copy);
 };
+#pragma pack(pop)
+static_assert(sizeof(ljson_value) == 16, "a ljson_value takes 16 bytes");
 
 /*! \brief the struct of the member of json object*/
 struct ljson_member {
@@ -125,6 +440,423 @@ typedef struct {
     ljson_value value;
 } ljson_object;
 
+inline uint64_t ljson_rotl64(uint64_t x, int b) { return (x << b) | (x >> (64 - b)); }
+
+inline void ljson_sip_round(uint64_t & v0, uint64_t & v1, uint64_t & v2, uint64_t & v3) {
+    v0 += v1; v1 = ljson_rotl64(v1, 13); v1 ^= v0; v0 = ljson_rotl64(v0, 32);
+    v2 += v3; v3 = ljson_rotl64(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = ljson_rotl64(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = ljson_rotl64(v1, 17); v1 ^= v2; v2 = ljson_rotl64(v2, 32);
+}
+
+/*!
+ * \brief SipHash-1-3 of a key with a random seed of the process, so that nobody can
+ *          choose keys which collide in the hash index of an object
+ */
+inline uint64_t ljson_hash(const char* key, size_t len) {
+    static const uint64_t seed[2] = {
+        (uint64_t(std::random_device()()) << 32) ^ std::random_device()(),
+        (uint64_t(std::random_device()()) << 32) ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count()
+    };
+    uint64_t v0 = 0x736f6d6570736575ULL ^ seed[0], v1 = 0x646f72616e646f6dULL ^ seed[1];
+    uint64_t v2 = 0x6c7967656e657261ULL ^ seed[0], v3 = 0x7465646279746573ULL ^ seed[1];
+    const char* end = key + (len & ~size_t(7));
+    for (; key != end; key += 8) {
+        uint64_t m;
+        memcpy(&m, key, 8);
+        v3 ^= m;
+        ljson_sip_round(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    uint64_t b = uint64_t(len) << 56;
+    for (size_t i = 0; i < (len & 7); i++)
+        b |= uint64_t((unsigned char)key[i]) << (8 * i);
+    v3 ^= b;
+    ljson_sip_round(v0, v1, v2, v3);
+    v0 ^= b;
+    v2 ^= 0xff;
+    ljson_sip_round(v0, v1, v2, v3);
+    ljson_sip_round(v0, v1, v2, v3);
+    ljson_sip_round(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/*!
+ * \brief a set of interned object keys, which documents and parsers share, also between
+ *          threads: each key is stored once and the members of the objects point to it.
+ *          It keeps at most max_keys keys, the next ones are not interned. The pool must
+ *          outlive every value parsed with it, its keys are only freed by its destructor
+ */
+class KeyPool {
+public:
+    struct Entry {
+        uint64_t hash;      /*!< ljson_hash of the key */
+        std::string key;
+    };
+
+    explicit KeyPool(size_t max_keys = 65536) : mmax_keys(max_keys), msize(0) { }
+    ~KeyPool();
+    KeyPool(const KeyPool &) = delete;
+    KeyPool & operator=(const KeyPool &) = delete;
+
+    /*! \brief the entry of the key, which is added if it is new, nullptr if the pool is full */
+    const Entry* Intern(const char* key, size_t len);
+    const Entry* Intern(const std::string & key) { return Intern(key.data(), key.size()); }
+    /*! \brief the number of keys */
+    size_t Size() const { return msize; }
+private:
+    /* the keys are spread over shards by hash, each one with its lock and open addressing table */
+    enum { SHARD_BITS = 4 };
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Entry*> slots;
+        size_t count = 0;
+    };
+
+    void add_slot(Shard & shard, Entry* e);
+
+    Shard mshards[1 << SHARD_BITS];
+    size_t mmax_keys;
+    std::atomic<size_t> msize;
+};
+
+/*!
+ * \brief the key of an object member in 16 bytes. A key of up to SHORT_MAX chars is stored in
+ *          place. A longer one is a pointer and a length: to chars owned by the key, or to a slice
+ *          of an arena or an insitu buffer which outlives it, or to an entry of a KeyPool. Two keys
+ *          of the same pool are equal if they point to the same entry. Every key ends with a NUL.
+ *          str() makes a std::string, data() and size() read the key in place
+ */
+class ljson_key {
+public:
+    /*! \brief the longest key which is stored in place */
+    static const size_t SHORT_MAX = 14;
+
+    ljson_key() { memset(mbytes, 0, sizeof(mbytes)); }
+    ljson_key(const std::string & key) { assign(key.data(), key.size()); }
+    ljson_key(const char* key) { assign(key, strlen(key)); }
+    ljson_key(const char* key, size_t len) { assign(key, len); }
+    explicit ljson_key(const KeyPool::Entry* entry) { set(entry, 0, POOL); }
+    /*!
+     * \brief a key which points to len chars and a NUL without owning them, they must outlive
+     *          the key. A short key is copied in place
+     */
+    static ljson_key slice(const char* key, size_t len) {
+        ljson_key k;
+        if (len <= SHORT_MAX)
+            k.assign(key, len);
+        else
+            k.set(key, len, SLICE);
+        return k;
+    }
+    /*!
+     * \brief a key which takes over key, allocated by new char[] with len chars and a NUL.
+     *          A short key is copied in place and key is deleted
+     */
+    static ljson_key adopt(char* key, size_t len) {
+        ljson_key k;
+        if (len <= SHORT_MAX) {
+            k.assign(key, len);
+            delete[] key;
+        } else
+            k.set(key, len, OWNED);
+        return k;
+    }
+    /*! \brief a key owns a copy of the chars of another owned key, the others are shared */
+    ljson_key(const ljson_key & other) {
+        if (other.owned())
+            assign(other.data(), other.size());
+        else
+            memcpy(mbytes, other.mbytes, sizeof(mbytes));
+    }
+    ljson_key(ljson_key && other) noexcept {
+        memcpy(mbytes, other.mbytes, sizeof(mbytes));
+        memset(other.mbytes, 0, sizeof(other.mbytes));
+    }
+    ljson_key & operator=(ljson_key other) noexcept {
+        std::swap(mbytes, other.mbytes);
+        return *this;
+    }
+    ~ljson_key() {
+        if (owned())
+            delete[] static_cast<const char*>(pointer());
+    }
+
+    std::string str() const { return std::string(data(), size()); }
+    operator std::string () const { return str(); }
+    const char* data() const {
+        switch (kind()) {
+            case SHORT: return reinterpret_cast<const char*>(mbytes);
+            case POOL:  return entry()->key.data();
+            default:    return static_cast<const char*>(pointer());
+        }
+    }
+    const char* c_str() const { return data(); }
+    size_t size() const {
+        switch (kind()) {
+            case SHORT: return mbytes[TAG] & LENGTH;
+            case POOL:  return entry()->key.size();
+            default:    return length();
+        }
+    }
+    /*! \brief the entry of the pool, nullptr for the other keys */
+    const KeyPool::Entry* entry() const { return kind() == POOL ? static_cast<const KeyPool::Entry*>(pointer()) : nullptr; }
+    /*! \brief whether the chars are allocated by the key, not in place, in an arena, a buffer or a pool */
+    bool owned() const { return kind() == OWNED; }
+    uint64_t hash() const { return kind() == POOL ? entry()->hash : ljson_hash(data(), size()); }
+
+    bool equals(const char* key, size_t len) const {
+        return size() == len && memcmp(data(), key, len) == 0;
+    }
+    bool equals(const ljson_key & other) const {
+        return (kind() == POOL && memcmp(mbytes, other.mbytes, sizeof(mbytes)) == 0) || other.equals(data(), size());
+    }
+private:
+    /*
+     * the last byte is the tag: the kind in its two high bits and the length of a short key in the others.
+     * A short key has its chars and NUL in the bytes before. The others have the pointer in the first
+     * bytes and the length in the 6 bytes from 8
+     */
+    enum { TAG = 15, LENGTH = 63 };
+    enum Kind { SHORT = 0, SLICE = 1 << 6, OWNED = 2 << 6, POOL = 3 << 6 };
+
+    int kind() const { return mbytes[TAG] & ~LENGTH; }
+    const void* pointer() const {
+        const void* p;
+        memcpy(&p, mbytes, sizeof(p));
+        return p;
+    }
+    size_t length() const {
+        uint32_t low;
+        uint16_t high;
+        memcpy(&low, mbytes + 8, 4);
+        memcpy(&high, mbytes + 12, 2);
+        return (size_t)((uint64_t)high << 32 | low);
+    }
+    void set(const void* p, size_t len, Kind kind) {
+        assert((uint64_t)len >> 48 == 0);
+        uint32_t low = (uint32_t)len;
+        uint16_t high = (uint16_t)((uint64_t)len >> 32);
+        memset(mbytes, 0, sizeof(mbytes));
+        memcpy(mbytes, &p, sizeof(p));
+        memcpy(mbytes + 8, &low, 4);
+        memcpy(mbytes + 12, &high, 2);
+        mbytes[TAG] = (unsigned char)kind;
+    }
+    void assign(const char* key, size_t len) {
+        if (len <= SHORT_MAX) {
+            memset(mbytes, 0, sizeof(mbytes));
+            memcpy(mbytes, key, len);
+            mbytes[TAG] = (unsigned char)(SHORT | len);
+            return;
+        }
+        char* chars = new char[len + 1];
+        memcpy(chars, key, len);
+        chars[len] = '\0';
+        set(chars, len, OWNED);
+    }
+
+    alignas(8) unsigned char mbytes[16];
+};
+static_assert(sizeof(ljson_key) == 16, "a ljson_key takes 16 bytes");
+
+inline bool operator==(const ljson_key & a, const ljson_key & b) { return a.equals(b); }
+inline bool operator!=(const ljson_key & a, const ljson_key & b) { return !a.equals(b); }
+inline bool operator<(const ljson_key & a, const ljson_key & b) {
+    int cmp = memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+    return cmp != 0 ? cmp < 0 : a.size() < b.size();
+}
+inline std::ostream & operator<<(std::ostream & out, const ljson_key & key) { return out.write(key.data(), key.size()); }
+
+/*!
+ * \brief the container of the json object: the members in insertion order in one vector.
+ *          A small object is searched linearly. From INDEX_MIN_SIZE members, or after index(),
+ *          it keeps a hash index too: an open addressing table of the positions of the members
+ *          with the hashes of their keys, so a lookup is O(1). Do not change a key through an
+ *          iterator, erase() is O(n).
+ *          getObject returned a std::map<std::string, ljson_value> before. The members of it which
+ *          the callers use are here with the same meaning: find, count, at, operator[], insert,
+ *          emplace, erase, size, empty and clear. Unlike std::map the iteration follows the order
+ *          of the json and not the order of the keys, and a key is a ljson_key, whose str() is the
+ *          std::string. Copy the members and sort them for the order of std::map
+ */
+class ljson_map {
+public:
+    typedef std::pair<ljson_key, ljson_value> value_type;
+    typedef ljson_allocator<value_type> allocator_type;
+    typedef std::vector<value_type, allocator_type>::iterator iterator;
+    typedef std::vector<value_type, allocator_type>::const_iterator const_iterator;
+
+    /*! \brief the size from which an object keeps its index */
+    static const size_t INDEX_MIN_SIZE = 16;
+
+    explicit ljson_map(const allocator_type & alloc = allocator_type())
+        : mmembers(alloc), mindex(ljson_allocator<uint64_t>(alloc)) { }
+
+    iterator begin() { return mmembers.begin(); }
+    iterator end() { return mmembers.end(); }
+    const_iterator begin() const { return mmembers.begin(); }
+    const_iterator end() const { return mmembers.end(); }
+    size_t size() const { return mmembers.size(); }
+    bool empty() const { return mmembers.empty(); }
+    void reserve(size_t n) { mmembers.reserve(n); }
+    /*! \brief whether the object has its hash index */
+    bool indexed() const { return !mindex.empty(); }
+
+    iterator find(const char* key, size_t len) {
+        if (mindex.empty()) {
+            for (auto iter = mmembers.begin(); iter != mmembers.end(); iter++)
+                if (iter->first.equals(key, len))
+                    return iter;
+            return mmembers.end();
+        }
+        return find_indexed(hash_of(ljson_hash(key, len)), [=](const ljson_key & k) { return k.equals(key, len); });
+    }
+    /*! \brief a key of a KeyPool is compared by its entry first, and its hash is not computed again */
+    iterator find(const ljson_key & key) {
+        if (mindex.empty()) {
+            for (auto iter = mmembers.begin(); iter != mmembers.end(); iter++)
+                if (iter->first.equals(key))
+                    return iter;
+            return mmembers.end();
+        }
+        return find_indexed(hash_of(key.hash()), [&](const ljson_key & k) { return k.equals(key); });
+    }
+    iterator find(const std::string & key) { return find(key.data(), key.size()); }
+    iterator find(const char* key) { return find(key, strlen(key)); }
+    const_iterator find(const std::string & key) const { return const_cast<ljson_map*>(this)->find(key); }
+    size_t count(const std::string & key) const { return find(key) != end() ? 1 : 0; }
+    /*! \brief the value of the key, std::out_of_range if there is none, as std::map::at */
+    ljson_value & at(const std::string & key) {
+        auto iter = find(key);
+        if (iter == mmembers.end())
+            throw std::out_of_range("ljson_map::at: no member " + key);
+        return iter->second;
+    }
+    const ljson_value & at(const std::string & key) const { return const_cast<ljson_map*>(this)->at(key); }
+
+    /*! \brief append the member if the key is new, or return the one with the key */
+    std::pair<iterator, bool> emplace(ljson_key key, const ljson_value & value) {
+        if (mindex.empty()) {
+            auto iter = find(key);
+            if (iter != mmembers.end())
+                return std::make_pair(iter, false);
+            mmembers.emplace_back(std::move(key), value);
+            if (mmembers.size() >= INDEX_MIN_SIZE)
+                index();
+        } else {
+            uint32_t hash = hash_of(key.hash());
+            auto iter = find_indexed(hash, [&](const ljson_key & k) { return k.equals(key); });
+            if (iter != mmembers.end())
+                return std::make_pair(iter, false);
+            mmembers.emplace_back(std::move(key), value);
+            if (mmembers.size() * 2 > mindex.size())
+                rehash(mindex.size() * 2);
+            add_slot(mmembers.size() - 1, hash);
+        }
+        return std::make_pair(mmembers.end() - 1, true);
+    }
+    template <typename InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        for (; first != last; first++)
+            emplace(first->first, first->second);
+    }
+    /*! \brief insert a pair of a key and a ljson_value if the key is new, as std::map::insert */
+    template <typename Pair>
+    std::pair<iterator, bool> insert(const Pair & member) { return emplace(member.first, member.second); }
+    /*! \brief the value of the key, a new null member if there is none */
+    ljson_value & operator[](const std::string & key) {
+        auto iter = find(key);
+        return iter != mmembers.end() ? iter->second : emplace(key, ljson_value()).first->second;
+    }
+
+    /*! \brief remove the member, its value is not freed */
+    iterator erase(iterator pos) {
+        size_t i = pos - mmembers.begin();
+        std::rotate(pos, pos + 1, mmembers.end());
+        mmembers.pop_back();
+        if (!mindex.empty())
+            index();
+        return mmembers.begin() + i;
+    }
+    size_t erase(const std::string & key) {
+        auto iter = find(key);
+        if (iter == mmembers.end())
+            return 0;
+        erase(iter);
+        return 1;
+    }
+    void clear() {
+        mmembers.clear();
+        mindex.clear();
+    }
+
+    /*! \brief build the hash index whatever the size, it is kept from now on */
+    void index() {
+        size_t capacity = 8;
+        while (capacity < mmembers.size() * 2)
+            capacity *= 2;
+        mindex.assign(capacity, 0);
+        for (size_t i = 0; i < mmembers.size(); i++)
+            add_slot(i, hash_of(mmembers[i].first.hash()));
+    }
+
+private:
+    static uint32_t hash_of(uint64_t hash) { return (uint32_t)(hash >> 32); }
+
+    template <typename Equal>
+    iterator find_indexed(uint32_t hash, Equal equal) {
+        size_t mask = mindex.size() - 1;
+        for (size_t i = hash & mask; mindex[i] != 0; i = (i + 1) & mask) {
+            if ((uint32_t)(mindex[i] >> 32) == hash && equal(mmembers[(uint32_t)mindex[i] - 1].first))
+                return mmembers.begin() + ((uint32_t)mindex[i] - 1);
+        }
+        return mmembers.end();
+    }
+
+    void add_slot(size_t pos, uint32_t hash) {
+        size_t mask = mindex.size() - 1;
+        size_t i = hash & mask;
+        while (mindex[i] != 0)
+            i = (i + 1) & mask;
+        mindex[i] = (uint64_t(hash) << 32) | (uint32_t)(pos + 1);
+    }
+    /* move the slots to a larger table, with the hashes they keep */
+    void rehash(size_t capacity) {
+        std::vector<uint64_t, ljson_allocator<uint64_t> > old(capacity, 0, mindex.get_allocator());
+        old.swap(mindex);
+        for (auto iter = old.begin(); iter != old.end(); iter++)
+            if (*iter != 0)
+                add_slot((uint32_t)*iter - 1, (uint32_t)(*iter >> 32));
+    }
+
+    std::vector<value_type, allocator_type> mmembers;
+    /*!
+     * the hash index, empty for a small object. A slot has the hash of the key in the high half and
+     * the position of the member + 1 in the low half, 0 if it is empty. It is at most half full
+     */
+    std::vector<uint64_t, ljson_allocator<uint64_t> > mindex;
+};
+
+/*!
+ * \brief the default maximum nesting of the containers of a parse, see LJSON_PARSE_DEPTH_EXCEEDED.
+ *          It may be raised up to SIZE_MAX: the parser and the walks over the tree (free, copy,
+ *          stringify, ljson_index_objects) keep their levels on the heap, not on the call stack
+ */
+const size_t LJSON_MAX_DEPTH = 512;
+
+/*!
+ * \brief the working memory of a parse, which can be kept to parse again without allocating:
+ *          the values and keys of the open containers and the decode buffer of escaped strings
+ */
+struct ljson_parse_buffers {
+    std::vector<ljson_value> values;
+    std::vector<ljson_key> keys;
+    std::string scratch;
+    std::vector<size_t> frames;         /*!< the open containers of the parser */
+    size_t max_depth = LJSON_MAX_DEPTH; /*!< the deepest nesting a parse with these buffers accepts */
+};
+
 /*! \brief the type of the results or error*/
 typedef enum {
     LJSON_PARSE_OK = 0,
@@ -146,10 +878,47 @@ typedef enum {
 
     LJSON_PARSE_MISS_KEY,
     LJSON_PARSE_MISS_COLON,
-    LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET
+    LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET,
+
+    LJSON_PARSE_TERMINATED,
+    LJSON_PARSE_INCOMPLETE,
+    LJSON_PARSE_FILE_ERROR,
+    LJSON_PARSE_DEPTH_EXCEEDED,         /*!< the containers are nested deeper than the max depth */
+    LJSON_PARSE_ADDRESS_TOO_HIGH        /*!< the arena gave an address beyond the 48 bits of ljson_compact */
 } ljson_state;
 
-inline void ljson_init(ljson_value* v) { v->type = LJSON_NULL; }
+/*!
+ * \brief the base of the handlers of ljson_parse_sax, which get the json as a sequence of events.
+ *          Derive it as class MyHandler : public ljson_base_handler<MyHandler> and hide the
+ *          events you want, the others accept everything and the integers go to Number().
+ *          An event returns false to stop the parse with LJSON_PARSE_TERMINATED.
+ *          String() and Key() get str[0, len) without the quotes and escapes, it is only valid
+ *          during the call if copy is true. If copy is false it lives on, in the insitu buffer or in
+ *          the storage the handler gave to Reserve(). EndObject() and EndArray() get the number of
+ *          members or elements
+ */
+template <typename Derived>
+struct ljson_base_handler {
+    bool Null() { return true; }
+    bool Bool(bool) { return true; }
+    bool Number(double) { return true; }
+    bool Int64(int64_t i) { return static_cast<Derived*>(this)->Number((double)i); }
+    bool Uint64(uint64_t u) { return static_cast<Derived*>(this)->Number((double)u); }
+    bool String(const char*, size_t, bool) { return true; }
+    bool Key(const char*, size_t, bool) { return true; }
+    /*!
+     * \brief room for size chars and a NUL, into which the next string (or key if key is true) with
+     *          escapes is decoded. It comes to String() or Key() with copy = false and the handler keeps
+     *          the storage. nullptr lets the parser decode into its own buffer
+     */
+    char* Reserve(size_t, bool) { return nullptr; }
+    bool StartObject() { return true; }
+    bool EndObject(size_t) { return true; }
+    bool StartArray() { return true; }
+    bool EndArray(size_t) { return true; }
+};
+
+inline void ljson_init(ljson_value* v) { v->type = LJSON_NULL; v->flags = 0; }
 
 /*!
  * \brief the same as ljson_free(ljson_value* v)
@@ -161,24 +930,133 @@ inline void setNull(ljson_value & v) { ljson_free(&v); }
  * \brief parse a string to get the ljson_value
  * \param v the pointer of ljson_value you want to store the result of parse
  * \param json the string you want to parse
+ * \param arena the arena to allocate the nodes, strings and containers from,
+ *          nullptr to use the global new/delete. It must outlive v
+ * \return ljson_state
+ */
+int ljson_parse(ljson_value* v, const char* json, ljson_arena* arena = nullptr);
+/*!
+ * \brief parse a buffer of known length, which needs no terminating NUL and no padding.
+ *          A NUL inside the buffer is an error instead of the end of input
+ * \param v the pointer of ljson_value you want to store the result of parse
+ * \param json the json you want to parse, e.g. a slice of a receive buffer
+ * \param len the length of the json
+ * \param arena the arena to allocate the nodes, strings and containers from,
+ *          nullptr to use the global new/delete. It must outlive v
  * \return ljson_state
  */
-int ljson_parse(ljson_value* v, const char* json);
+int ljson_parse(ljson_value* v, const char* json, size_t len, ljson_arena* arena = nullptr);
+/*!
+ * \brief parse with the working memory of the last parse, see ljson_parse_buffers.
+ *          With an arena which is reset() between the parses, a json like the last one
+ *          needs no allocation at all
+ * \param pool the pool to intern the keys of the objects, it must outlive v. nullptr for none
+ */
+int ljson_parse(ljson_value* v, const char* json, size_t len, ljson_arena* arena, ljson_parse_buffers* buffers, KeyPool* pool = nullptr);
 /*!
  * \brief parse a string to get the ljson_value
  * \param v the pointer of ljson_value you want to store the result of parse
  * \param json the string you want to parse
+ * \param arena the arena to allocate the nodes, strings and containers from,
+ *          nullptr to use the global new/delete. It must outlive v
+ * \return ljson_state
+ */
+int ljson_parse(ljson_value* v, const std::string & json, ljson_arena* arena = nullptr);
+#ifdef LJSON_HAS_STRING_VIEW
+/*! \brief parse a std::string_view, see ljson_parse(ljson_value*, const char*, size_t, ljson_arena*) */
+int ljson_parse(ljson_value* v, std::string_view json, ljson_arena* arena = nullptr);
+#endif
+/*!
+ * \brief parse a mutable buffer in place: the strings and keys are unescaped inside it
+ *          and the string values and the keys point into it, so the buffer must outlive v
+ * \param v the pointer of ljson_value you want to store the result of parse
+ * \param buf the json to parse, it is modified, no terminating NUL is needed
+ * \param len the length of the json in buf
+ * \param arena the arena to allocate the containers from, nullptr to use the global new/delete
+ * \return ljson_state
+ */
+int ljson_parse_insitu(ljson_value* v, char* buf, size_t len, ljson_arena* arena = nullptr,
+                       ljson_parse_buffers* buffers = nullptr, KeyPool* pool = nullptr);
+/*!
+ * \brief parse a file, which is mapped into memory read only instead of being copied
+ * \param v the pointer of ljson_value you want to store the result of parse
+ * \param path the path of the file
+ * \param arena the arena to allocate from, nullptr to use the global new/delete
+ * \return ljson_state, LJSON_PARSE_FILE_ERROR if the file cannot be read
+ */
+int ljson_parse_file(ljson_value* v, const char* path, ljson_arena* arena = nullptr);
+/*!
+ * \brief parse a large json on several threads. A root array is cut at its top level commas
+ *          into about one part per thread and the elements of the parts are parsed in parallel,
+ *          straight into the result array. Any other json, or an error, is parsed by ljson_parse.
+ *          The calls share a ParallelParser with one thread per core, which the first call starts.
+ *          A call while another one uses it parses on the calling thread, the cores are busy anyway.
+ *          Keep a ParallelParser of your own for parses which should not wait for each other
+ * \param v the pointer of ljson_value you want to store the result of parse
+ * \param json the json you want to parse
+ * \param len the length of the json
+ * \param threads the most threads to use, 0 for one per core
+ * \param arena the arena to allocate from, nullptr to use the global new/delete. It must outlive v
+ * \return ljson_state, the same as ljson_parse
+ */
+int ljson_parse_parallel(ljson_value* v, const char* json, size_t len, unsigned threads = 0, ljson_arena* arena = nullptr);
+/*!
+ * \brief check a json and keep its containers as their json text, each one is decoded
+ *          on the first access to it. Good to read a few fields of a large json.
+ *          The check records where each container ends and how many members it has,
+ *          so a decode reserves its container and jumps over the containers in it.
+ *          Threads may share the tree for reading, see ljson_expand
+ * \param v the pointer of ljson_value you want to store the result of parse
+ * \param json the json you want to parse, it must outlive v
+ * \param len the length of the json
+ * \param arena the record of the check and the decoded values go there, it must outlive v
  * \return ljson_state
  */
-int ljson_parse(ljson_value* v, const std::string & json);
+int ljson_parse_lazy(ljson_value* v, const char* json, size_t len, ljson_arena* arena);
+/*!
+ * \brief parse a json without building a tree, the handler gets the events in order.
+ *          The DOM of ljson_parse is built by one of these handlers
+ * \param handler the handler of the events, see ljson_base_handler
+ * \param json the json you want to parse
+ * \param len the length of the json
+ * \param max_depth the deepest nesting of containers, the parse fails with LJSON_PARSE_DEPTH_EXCEEDED
+ *          beyond it. The stack of the parser does not grow with the nesting
+ * \return ljson_state, LJSON_PARSE_TERMINATED if the handler stops the parse
+ */
+template <typename Handler>
+int ljson_parse_sax(Handler & handler, const char* json, size_t len, size_t max_depth = LJSON_MAX_DEPTH);
+/*! \brief parse a NUL terminated json with a handler, see ljson_parse_sax */
+template <typename Handler>
+int ljson_parse_sax(Handler & handler, const char* json);
+/*! \brief parse a std::string with a handler, see ljson_parse_sax */
+template <typename Handler>
+int ljson_parse_sax(Handler & handler, const std::string & json);
+/*! \brief parse buf in place with a handler, the strings are passed with copy = false, see ljson_parse_insitu */
+template <typename Handler>
+int ljson_parse_sax_insitu(Handler & handler, char* buf, size_t len, size_t max_depth = LJSON_MAX_DEPTH);
+/*!
+ * \brief the handler which builds the tree of ljson_parse, for the other parsers like StreamParser.
+ *          ljson_dom_handler(ljson_value* root, ljson_arena* arena, ljson_parse_buffers* buffers = nullptr,
+ *          KeyPool* pool = nullptr) parses into root, which must be initialized
+ */
+class ljson_dom_handler;
+
+/*! \brief keep every digit of the shortest representation which reads back to the same double */
+const int LJSON_MAX_DECIMAL_PLACES = 324;
 
 /*!
  * \brief ljson_value v to get the string os the json
  * \param v the pointer of ljson_value you want to stringify
  * \param json the string you want to store the result
+ * \param max_decimal_places the maximum digits after the decimal point of a double,
+ *          the extra digits are truncated. Use a small one for a fixed precision
  * \return ljson_state
+ *
+ * A double is written in its shortest form which reads back to the same bits, an
+ * integral one without a fraction: 124.0 gives 124. NaN and the infinities are no
+ * json numbers, they are written as null
  */
-int ljson_stringify(const ljson_value* v, std::string & json);
+int ljson_stringify(const ljson_value* v, std::string & json, int max_decimal_places = LJSON_MAX_DECIMAL_PLACES);
 /*!
  * \brief ljson_value v to get the string os the json
  * \param v the pointer of ljson_value you want to stringify
@@ -195,6 +1073,16 @@ void setNumber(ljson_value* v, double n);
 void setNumber(ljson_value & v, double n);
 double getNumber(const ljson_value* v);
 double getNumber(const ljson_value & v);
+ljson_number_type getNumberType(const ljson_value* v);
+ljson_number_type getNumberType(const ljson_value & v);
+void setInt64(ljson_value* v, int64_t n);
+void setInt64(ljson_value & v, int64_t n);
+int64_t getInt64(const ljson_value* v);
+int64_t getInt64(const ljson_value & v);
+void setUint64(ljson_value* v, uint64_t n);
+void setUint64(ljson_value & v, uint64_t n);
+uint64_t getUint64(const ljson_value* v);
+uint64_t getUint64(const ljson_value & v);
 
 void setBool(ljson_value* v, ljson_type b);
 void setBool(ljson_value* v, bool b);
@@ -205,42 +1093,179 @@ bool getBool(const ljson_value & v);
 
 void setString(ljson_value* v, const char* s, size_t len);
 void setString(ljson_value* v, const std::string & s);
-std::string & getString(const ljson_value* v);
+/*!
+ * \brief the string as a std::string which may be changed in place. A short string or one
+ *          which points into the input is copied into its own std::string on the first call,
+ *          which changes v: do not call it while another thread reads v
+ */
+std::string & getString(ljson_value* v);
+/*! \brief a copy of the string, v is not changed so threads may share it. getStringData reads it without a copy */
+std::string getString(const ljson_value* v);
+/*! \brief the chars of the string, getStringLength of them, whatever its storage. v is not changed */
+const char* getStringData(const ljson_value* v);
 size_t getStringLength(const ljson_value* v);
 void setString(ljson_value & v, const char* s, size_t len);
 void setString(ljson_value & v, const std::string & s);
-std::string & getString(const ljson_value & v);
+std::string & getString(ljson_value & v);
+std::string getString(const ljson_value & v);
+const char* getStringData(const ljson_value & v);
 size_t getStringLength(const ljson_value & v);
+#ifdef LJSON_HAS_STRING_VIEW
+/*! \brief the string without a copy, see getStringData */
+std::string_view getStringView(const ljson_value* v);
+std::string_view getStringView(const ljson_value & v);
+#endif
 
 void setArray(ljson_value* v, const std::vector<ljson_value> & vec, bool deep_copy = 1);
-std::vector<ljson_value> & getArray(const ljson_value* v);
+/*! \brief take the elements of vec in O(1) each, without copying their children */
+void setArray(ljson_value* v, std::vector<ljson_value> && vec);
+/*! \brief take vec itself in O(1) */
+void setArray(ljson_value* v, ljson_array && vec);
+/*! \brief the elements, an ljson_array and no std::vector<ljson_value>, see ljson_array */
+ljson_array & getArray(const ljson_value* v);
 ljson_value & getArrayElement(const ljson_value* v, const size_t index);
 void setArrayElement(ljson_value* v, const size_t index, const ljson_value & content);
+/*! \brief free the element and take content in O(1), content becomes a null */
+void setArrayElement(ljson_value* v, const size_t index, ljson_value && content);
 size_t getArraySize(const ljson_value* v);
 void setArray(ljson_value & v, const std::vector<ljson_value> & vec, bool deep_copy = 1);
-std::vector<ljson_value> & getArray(const ljson_value & v);
+void setArray(ljson_value & v, std::vector<ljson_value> && vec);
+void setArray(ljson_value & v, ljson_array && vec);
+ljson_array & getArray(const ljson_value & v);
 ljson_value & getArrayElement(const ljson_value & v, const size_t index);
 void setArrayElement(ljson_value & v, const size_t index, const ljson_value & content);
+void setArrayElement(ljson_value & v, const size_t index, ljson_value && content);
 size_t getArraySize(const ljson_value & v);
 
 void setObject(ljson_value* v, const std::map<std::string, ljson_value> & vec, bool deep_copy = 1);
+/*! \brief take the values of vec in O(1) each, without copying their children */
+void setObject(ljson_value* v, std::map<std::string, ljson_value> && vec);
+/*! \brief take vec itself in O(1) */
+void setObject(ljson_value* v, ljson_map && vec);
 bool objectFindKey(const ljson_value* v, const std::string & mkey);
 bool objectFindKey(const ljson_value & v, const std::string & mkey);
-std::map<std::string, ljson_value> & getObject(const ljson_value* v);
+/*! \brief the members, an ljson_map and no std::map any more: in the order of the json, see ljson_map */
+ljson_map & getObject(const ljson_value* v);
 ljson_value & getObjElement(const ljson_value* v, const std::string & key);
 void setObjElement(ljson_value* v, const std::string key, const ljson_value & content);
+/*! \brief free the member and take content in O(1), content becomes a null */
+void setObjElement(ljson_value* v, const std::string key, ljson_value && content);
 size_t getObjectSize(const ljson_value* v);
 ljson_value & objectAccess(ljson_value* v, const std::string & mkey);
 void setObject(ljson_value & v, const std::map<std::string, ljson_value> & vec, bool deep_copy = 1);
-std::map<std::string, ljson_value> & getObject(const ljson_value* v);
+void setObject(ljson_value & v, std::map<std::string, ljson_value> && vec);
+void setObject(ljson_value & v, ljson_map && vec);
+ljson_map & getObject(const ljson_value & v);
 ljson_value & getObjElement(const ljson_value & v, const std::string key);
 void setObjElement(ljson_value & v, const std::string key, const ljson_value & content);
+void setObjElement(ljson_value & v, const std::string key, ljson_value && content);
 size_t getObjectSize(const ljson_value & v);
 ljson_value & objectAccess(ljson_value & v, const std::string & mkey);
 
 void ljson_reset(ljson_value* v_old, const ljson_value & v_new);
 void ljson_reset(ljson_value* v_old, const ljson_value * v_new);
 
+/*! \brief give every object of the tree its hash index, whatever its size, see ljson_map::index */
+void ljson_index_objects(ljson_value* v);
+
+/*!
+ * \brief a json value in 8 bytes, the node of the tree of ljson_parse_compact.
+ *          A double is stored as it is. The other values are boxed in a negative quiet NaN:
+ *          a tag in the bits 48-50 and null, a boolean, an integer of 48 bits or a pointer
+ *          into the arena of the parse in the 48 bits below. In the arena a string, array or
+ *          object starts with its size as an uint64_t, then come the chars, the elements or
+ *          the key and value pairs. The tree is read only and lives as long as the arena
+ */
+class ljson_compact {
+public:
+    enum tag_type {
+        TAG_BIG = 0,        /*!< pointer to an int64 or, with the low bit set, an uint64 */
+        TAG_NULL, TAG_FALSE, TAG_TRUE,
+        TAG_INT,            /*!< integer of 48 bits */
+        TAG_STRING, TAG_ARRAY, TAG_OBJECT
+    };
+
+    ljson_compact() : mbits(box(TAG_NULL, 0)) { }
+
+    static ljson_compact from_double(double d) {
+        ljson_compact v;
+        if (d != d)
+            d = std::numeric_limits<double>::quiet_NaN();
+        memcpy(&v.mbits, &d, sizeof(d));
+        if ((v.mbits & BOX) == BOX)
+            v.mbits = 0x7FF8000000000000ull;    /* a NaN with the sign bit would look boxed */
+        return v;
+    }
+    static ljson_compact from_tag(tag_type tag, uint64_t payload = 0) {
+        assert((payload & ~PAYLOAD) == 0);
+        ljson_compact v;
+        v.mbits = box(tag, payload);
+        return v;
+    }
+    static ljson_compact from_pointer(tag_type tag, const void* p) {
+        return from_tag(tag, (uint64_t)reinterpret_cast<uintptr_t>(p));
+    }
+    static bool fits_int(int64_t i) { return i >= -(int64_t(1) << 47) && i < (int64_t(1) << 47); }
+    static ljson_compact from_int(int64_t i) {
+        assert(fits_int(i));
+        return from_tag(TAG_INT, uint64_t(i) & PAYLOAD);
+    }
+
+    bool is_double() const { return (mbits & BOX) != BOX; }
+    tag_type tag() const { return tag_type((mbits >> 48) & 7); }
+    double as_double() const {
+        double d;
+        memcpy(&d, &mbits, sizeof(d));
+        return d;
+    }
+    int64_t as_int() const { return int64_t(mbits << 16) >> 16; }
+    /*! \brief the uint64_t in the arena a string, container or big integer starts with */
+    const uint64_t* as_pointer() const { return reinterpret_cast<const uint64_t*>(uintptr_t(mbits & PAYLOAD & ~uint64_t(1))); }
+    bool big_unsigned() const { return (mbits & 1) != 0; }
+    /*! \brief the size of a string, array or object */
+    size_t size() const { return (size_t)*as_pointer(); }
+    const char* chars() const { return reinterpret_cast<const char*>(as_pointer() + 1); }
+    /*! \brief the elements of an array, the key and value pairs of an object */
+    const ljson_compact* nodes() const { return reinterpret_cast<const ljson_compact*>(as_pointer() + 1); }
+
+    uint64_t bits() const { return mbits; }
+private:
+    enum : uint64_t {
+        BOX = 0xFFF8000000000000ull,        /*!< sign, exponent and quiet bit of a boxed value */
+        PAYLOAD = 0x0000FFFFFFFFFFFFull
+    };
+    static uint64_t box(tag_type tag, uint64_t payload) { return BOX | (uint64_t(tag) << 48) | payload; }
+
+    uint64_t mbits;
+};
+
+/*!
+ * \brief parse json into a tree of ljson_compact, a third of the memory of the nodes of ljson_parse.
+ *          Every string and container is allocated from arena, reset() it to free the tree.
+ *          The integers beyond 48 bits stay exact in the arena. Where the addresses take more than
+ *          48 bits, as with 5-level paging, a node the arena puts that high fails the parse with LJSON_PARSE_ADDRESS_TOO_HIGH
+ * \return ljson_state, v is a null on an error
+ */
+int ljson_parse_compact(ljson_compact* v, const char* json, size_t len, ljson_arena* arena);
+int ljson_parse_compact(ljson_compact* v, const std::string & json, ljson_arena* arena);
+/*! \brief the json of a compact tree, see ljson_stringify */
+int ljson_stringify(ljson_compact v, std::string & json, int max_decimal_places = LJSON_MAX_DECIMAL_PLACES);
+
+ljson_type getType(ljson_compact v);
+double getNumber(ljson_compact v);
+ljson_number_type getNumberType(ljson_compact v);
+int64_t getInt64(ljson_compact v);
+uint64_t getUint64(ljson_compact v);
+bool getBool(ljson_compact v);
+std::string getString(ljson_compact v);
+size_t getStringLength(ljson_compact v);
+ljson_compact getArrayElement(ljson_compact v, const size_t index);
+size_t getArraySize(ljson_compact v);
+bool objectFindKey(ljson_compact v, const std::string & key);
+/*! \brief the value of the last member named key, a null if there is none */
+ljson_compact getObjElement(ljson_compact v, const std::string & key);
+size_t getObjectSize(ljson_compact v);
+
 /////////////////////////
 /* The Class Stype API */
 /////////////////////////
@@ -263,20 +1288,34 @@ public:
     }
 
     ljson_value * GetValue() const { return mvalue; };
+    /*! \brief a deep copy of content, which may contain this value */
     void SetValue(const Value & content) {
         ljson_value mv;
-        ljson_init(&mv);
         mv.copyfrom(*content.GetValue());
-        mvalue->copyfrom(mv);
-        ljson_free(&mv);
+        *mvalue = std::move(mv);
     }
+    /*!
+     * \brief take the content of other in O(1), other becomes a null. other may be inside this
+     *          value but must not contain it. A value of another Document stays in the arena
+     *          of that document, which must then outlive this one; copy it by SetValue otherwise
+     */
+    void MoveFrom(const Value & other) { *mvalue = std::move(*other.GetValue()); }
+    /*! \brief exchange the contents in O(1), neither may contain the other, see MoveFrom for the arenas */
+    void Swap(const Value & other) { mvalue->swap(*other.GetValue()); }
 
     void SetNumber(const double a_num) { setNumber(mvalue, a_num); }
     double GetNumber() const { return getNumber(mvalue); }
+    void SetInt64(const int64_t a_num) { setInt64(mvalue, a_num); }
+    int64_t GetInt64() const { return getInt64(mvalue); }
+    void SetUint64(const uint64_t a_num) { setUint64(mvalue, a_num); }
+    uint64_t GetUint64() const { return getUint64(mvalue); }
     void SetBool(const bool a_bool) { setBool(mvalue, a_bool); }
     bool GetBool() const { return getBool(mvalue); }
     void SetString(const std::string & a_str) { setString(mvalue, a_str); }
     std::string & GetString() const { return getString(mvalue); }
+    /*! \brief the chars of the string without changing it, see getStringData */
+    const char* GetStringData() const { return getStringData(mvalue); }
+    size_t GetStringLength() const { return getStringLength(mvalue); }
     void SetArrayElement(const size_t index, const Value & content) { setArrayElement(mvalue, index, *(content.GetValue())); }
     Value GetArrayElement(const size_t index) const { return Value(&(getArrayElement(mvalue, index)));}
     void SetObjectElement(const std::string & key, const Value & content) { setObjElement(mvalue, key, *(content.GetValue())); }
@@ -299,112 +1338,1812 @@ class Document : public Value {
 public:
     Document():Value() { mvalue = new ljson_value;ljson_init(mvalue); };
     ~Document() { ljson_free(mvalue);delete mvalue; }
-    int Parse(std::string & json) {
-        return ljson_parse(mvalue, json);
+    /*! \brief take the tree and the memory of other in O(1), other becomes an empty document */
+    Document(Document && other) : Document() { swap_document(other); }
+    Document & operator=(Document && other) {
+        if (this != &other) {
+            Reset();
+            swap_document(other);
+        }
+        return *this;
+    }
+    /*!
+     * \brief free the tree but keep its memory: the chunks of the arena and the working
+     *          memory of the parser are used again by the next parse. A tree which is still
+     *          all in the arena is not walked, see LJSON_FLAG_ARENA_TREE
+     */
+    void Reset() {
+        ljson_free(mvalue);
+        marena.reset();
+        mfile.close();
+    }
+    int Parse(std::string & json) { return Parse(json.data(), json.size()); }
+    int Parse(const char* json, size_t len) {
+        Reset();
+        return index_objects(ljson_parse(mvalue, json, len, &marena, &mbuffers, mpool));
+    }
+#ifdef LJSON_HAS_STRING_VIEW
+    int Parse(std::string_view json) { return Parse(json.data(), json.size()); }
+#endif
+    /*! \brief parse json lazily, see ljson_parse_lazy. json must outlive the document */
+    int ParseLazy(const char* json, size_t len) {
+        Reset();
+        return ljson_parse_lazy(mvalue, json, len, &marena);
+    }
+    int ParseLazy(const std::string & json) { return ParseLazy(json.data(), json.size()); }
+    /*! \brief parse buf in place, see ljson_parse_insitu. buf must outlive the document */
+    int ParseInsitu(char* buf, size_t len) {
+        Reset();
+        return index_objects(ljson_parse_insitu(mvalue, buf, len, &marena, &mbuffers, mpool));
+    }
+    /*!
+     * \brief parse a file in place: it is mapped copy on write and the strings point into
+     *          the mapping, which the document keeps until the next parse
+     * \return ljson_state, LJSON_PARSE_FILE_ERROR if the file cannot be read
+     */
+    int ParseFile(const char* path) {
+        Reset();
+        if (!mfile.open(path, true))
+            return LJSON_PARSE_FILE_ERROR;
+        return index_objects(ljson_parse_insitu(mvalue, mfile.data(), mfile.size(), &marena, &mbuffers, mpool));
+    }
+    int ParseFile(const std::string & path) { return ParseFile(path.c_str()); }
+    /*!
+     * \brief give every parsed object its hash index, not only the large ones, for a document
+     *          which is mostly read by key. See ljson_index_objects
+     */
+    void SetIndexObjects(bool all) { mindex_objects = all; }
+    /*! \brief the deepest nesting of the containers of the next parses, see LJSON_PARSE_DEPTH_EXCEEDED */
+    void SetMaxDepth(size_t depth) { mbuffers.max_depth = depth; }
+    /*! \brief intern the keys of the next parses in pool, which must outlive the document. nullptr for none */
+    void SetKeyPool(KeyPool* pool) { mpool = pool; }
+private:
+    int index_objects(int ret) {
+        if (ret == LJSON_PARSE_OK && mindex_objects)
+            ljson_index_objects(mvalue);
+        return ret;
     }
+    void swap_document(Document & other) {
+        std::swap(mvalue, other.mvalue);
+        marena.swap(other.marena);
+        mfile.swap(other.mfile);
+        std::swap(mbuffers, other.mbuffers);
+        std::swap(mindex_objects, other.mindex_objects);
+        std::swap(mpool, other.mpool);
+    }
+
+    ljson_arena marena;     /*!< owns every node, string and container of the parsed tree */
+    ljson_mapped_file mfile;    /*!< the file of ParseFile */
+    ljson_parse_buffers mbuffers;   /*!< the working memory of the parser, kept between the parses */
+    bool mindex_objects = false;    /*!< see SetIndexObjects */
+    KeyPool* mpool = nullptr;       /*!< see SetKeyPool */
 }; /*class Document*/
 
+/*!
+ * \brief a push parser which takes the json in chunks of any size and reports
+ *          the events to a handler as soon as they are complete, see ljson_parse_sax.
+ *          Only the token cut by the end of a chunk is kept between the chunks.
+ *          Use ljson_dom_handler as the handler to build a ljson_value.
+ */
+template <typename Handler>
+class StreamParser {
+public:
+    explicit StreamParser(Handler & handler)
+        : mhandler(handler), mresult(LJSON_PARSE_INCOMPLETE), mstate(STATE_VALUE), mtoken_kind(TOKEN_NONE), mescape(false),
+          mmax_depth(LJSON_MAX_DEPTH) { }
+    /*!
+     * \brief parse the next chunk
+     * \return LJSON_PARSE_INCOMPLETE if the root value needs more input,
+     *          LJSON_PARSE_OK once it is complete, or the error, which stays until the end
+     */
+    int Feed(const char* data, size_t len);
+    /*!
+     * \brief tell the end of input, a number at the end of the root is only complete here
+     * \return LJSON_PARSE_OK or the error
+     */
+    int Finish();
+    /*! \brief the deepest nesting of the containers, see LJSON_PARSE_DEPTH_EXCEEDED */
+    void SetMaxDepth(size_t depth) { mmax_depth = depth; }
+private:
+    enum {
+        STATE_VALUE,            /* a value */
+        STATE_ARRAY_FIRST,      /* a value or ']' after '[' */
+        STATE_OBJECT_FIRST,     /* a key or '}' after '{' */
+        STATE_KEY,              /* a key after ',' */
+        STATE_COLON,            /* ':' after a key */
+        STATE_AFTER_VALUE,      /* ',' or the end of the container */
+        STATE_DONE              /* only whitespace after the root */
+    };
+    enum { TOKEN_NONE, TOKEN_STRING, TOKEN_KEY, TOKEN_BARE };
 
-/////////////////////////
-/* The Implement       */
-/////////////////////////
+    const char* scan_token(const char* p, const char* end);
+    void end_value();
+    int emit_token(const char* begin, const char* end);
+    int fail(int error) { return mresult = error; }
+
+    Handler & mhandler;
+    int mresult;
+    int mstate;
+    int mtoken_kind;                /*!< the kind of the token in mtoken */
+    bool mescape;                   /*!< the last byte scanned in a string is an unpaired '\\' */
+    size_t mmax_depth;              /*!< see SetMaxDepth */
+    std::string mtoken;             /*!< the part of a token cut by the end of a chunk */
+    std::string mscratch;           /*!< decode buffer of escaped strings */
+    std::vector<char> mstack;       /*!< '[' or '{' of the open containers */
+    std::vector<size_t> mcounts;    /*!< the number of values in the open containers */
+};
+
+/*!
+ * \brief a forward only cursor over a json, which reads it in place without building a tree.
+ *          The json must outlive the reader. It holds a constant amount of memory whatever
+ *          the size of the json, apart from the buffer of the last escaped string.
+ *          Every method returns false on an error, which stays in GetState().
+ *          A value which is not read before the next NextKey() or NextElement() is skipped,
+ *          an entered container must be read until NextKey() or NextElement() returns false
+ */
+class Reader {
+public:
+    Reader(const char* json, size_t len)
+        : mjson(json), mend(json + len), mstate(LJSON_PARSE_OK), mfirst(false), mpending(true) { }
+    explicit Reader(const std::string & json) : Reader(json.data(), json.size()) { }
+
+    /*! \brief the type of the next value in type, false on an error or an invalid token, see GetState */
+    bool Peek(ljson_type* type);
+    /*! \brief the type of the next value, LJSON_NULL on an error too: use Peek(ljson_type*) to tell them apart */
+    ljson_type Peek() {
+        ljson_type type = LJSON_NULL;
+        Peek(&type);
+        return type;
+    }
+    /*! \brief enter the next value, which must be an object */
+    bool EnterObject();
+    /*! \brief move to the value of the next member, false at the end of the object. key is valid until the next read */
+    bool NextKey(const char** key, size_t* len);
+    bool NextKey(std::string & key);
+    /*! \brief move to the value of the next member with the key, false if the object has none left */
+    bool FindKey(const std::string & key);
+    /*! \brief enter the next value, which must be an array */
+    bool EnterArray();
+    /*! \brief move to the next element, false at the end of the array */
+    bool NextElement();
+    /*! \brief skip the next value without decoding it and without allocating */
+    bool SkipValue();
+
+    /*! \brief read the next value, false without moving if it has another type */
+    bool GetNull();
+    bool GetBool(bool* b);
+    bool GetNumber(double* d);
+    bool GetInt64(int64_t* i);
+    /*! \brief str is valid until the next read */
+    bool GetString(const char** str, size_t* len);
+    bool GetString(std::string & str);
+
+    /*! \brief whether only whitespace is left after the root value, or the error */
+    int Finish();
+    /*! \brief LJSON_PARSE_OK or the first error */
+    int GetState() const { return mstate; }
+private:
+    const char* next_value();
+    bool next_member(char close);
+    int read_string(const char** str, size_t* len);
+    bool fail(int error) { mstate = error; return false; }
+
+    const char* mjson;
+    const char* mend;
+    int mstate;
+    bool mfirst;            /*!< just after '[' or '{' */
+    bool mpending;          /*!< the cursor is on a value which is not read yet */
+    std::string mscratch;   /*!< decode buffer of escaped strings */
+}; /*class Reader*/
+
+/*!
+ * \brief a reader of NDJSON (JSON Lines), one json per line, which parses the lines on a fixed
+ *          pool of worker threads. The lines are handed to the workers in batches and the results
+ *          are delivered on the calling thread, in the order of the input, or as soon as a batch is
+ *          parsed if not ordered. At most two batches per worker are parsed and not yet delivered,
+ *          so the memory of the results does not grow with the input. A line with an error is reported with its ljson_state and the
+ *          other lines go on. Blank lines are skipped, a "\r\n" line end is allowed.
+ *          The callbacks must not throw, one reader parses one input at a time
+ */
+class NdjsonReader {
+public:
+    /*! \brief line counts from 1, v is a null on an error and is freed after the call */
+    typedef std::function<void(size_t line, int state, ljson_value* v)> Callback;
+    /*! \brief line counts from 1 */
+    typedef std::function<void(size_t line, int state)> StateCallback;
+
+    /*!
+     * \param threads the number of workers, 0 for one per core
+     * \param ordered deliver the lines in the order of the input
+     */
+    explicit NdjsonReader(unsigned threads = 0, bool ordered = true);
+    ~NdjsonReader();
+    NdjsonReader(const NdjsonReader &) = delete;
+    NdjsonReader & operator=(const NdjsonReader &) = delete;
+
+    /*!
+     * \brief parse every line into a ljson_value
+     * \return the number of lines with an error
+     */
+    size_t Parse(const char* json, size_t len, const Callback & callback);
+    size_t Parse(const std::string & json, const Callback & callback);
+    /*!
+     * \brief parse every line of the file at path, which is mapped into memory if it can be.
+     *          A file which cannot be read is reported as line 0 with LJSON_PARSE_FILE_ERROR
+     * \return the number of lines with an error
+     */
+    size_t ParseFile(const char* path, const Callback & callback);
+    /*!
+     * \brief report the events of every line to the handler of the worker which parses it,
+     *          so a handler is never used by two threads, and the state of the line to callback
+     * \param handlers one handler per worker, see GetThreads()
+     * \return the number of lines with an error
+     */
+    template <typename Handler>
+    size_t ParseSax(const char* json, size_t len, std::vector<Handler> & handlers, const StateCallback & callback = StateCallback());
+    /*! \brief ParseSax on the file at path, see ParseFile */
+    template <typename Handler>
+    size_t ParseSaxFile(const char* path, std::vector<Handler> & handlers, const StateCallback & callback = StateCallback());
+    /*! \brief the number of workers */
+    unsigned GetThreads() const { return (unsigned)mworkers.size(); }
+    /*! \brief intern the keys of the values of Parse in pool, which the workers share. nullptr for none */
+    void SetKeyPool(KeyPool* pool) { mpool = pool; }
+    /*! \brief the deepest nesting of the containers of a line, see LJSON_PARSE_DEPTH_EXCEEDED */
+    void SetMaxDepth(size_t depth) { mmax_depth = depth; }
+private:
+    /* slot is where the results of the batch go until they are delivered */
+    typedef std::function<void(unsigned worker, size_t batch, size_t slot)> Task;
+    struct Line {
+        const char* begin;
+        const char* end;
+        size_t number;
+    };
+
+    void split_lines(const char* json, size_t len);
+    size_t run(const Task & task, const std::function<size_t(size_t batch, size_t slot)> & deliver);
+    /*! \brief the number of slots, the batches which may be in flight */
+    size_t slots() const { return 2 * mworkers.size(); }
+    void work(unsigned worker);
+
+    bool mordered;
+    bool mstop;                         /*!< the workers should exit */
+    KeyPool* mpool;                     /*!< see SetKeyPool */
+    size_t mmax_depth;                  /*!< see SetMaxDepth */
+    const Task* mtask;                  /*!< the task of the current input */
+    size_t mnext;                       /*!< the next batch to parse */
+    size_t mcount;                      /*!< the number of batches */
+    std::vector<char> mdone;            /*!< whether each batch is parsed */
+    std::vector<size_t> mslot_of;       /*!< the slot of each claimed batch */
+    std::vector<size_t> mfree;          /*!< the slots which no batch holds */
+    std::vector<size_t> mfinished;      /*!< the parsed batches in the order they are done */
+    std::vector<Line> mlines;           /*!< the lines which are not blank */
+    std::vector<size_t> mbatches;       /*!< the first line of each batch, then the number of lines */
+    std::vector<ljson_parse_buffers> mbuffers;  /*!< the working memory of the parser, one per worker */
+    std::mutex mmutex;
+    std::condition_variable mwake;      /*!< a batch to parse, or the end */
+    std::condition_variable mready;     /*!< a batch is parsed */
+    std::vector<std::thread> mworkers;
+}; /*class NdjsonReader*/
+
+/*!
+ * \brief ljson_parse_parallel on a fixed set of threads, which are started once and wait
+ *          between the parses. The calling thread parses a part too.
+ *          With an arena, each thread allocates from its own one, whose chunks go to the
+ *          arena of the parse at the end. One parser parses one json at a time
+ */
+class ParallelParser {
+public:
+    /*! \param threads the number of threads which parse, the calling one included, 0 for one per core */
+    explicit ParallelParser(unsigned threads = 0);
+    ~ParallelParser();
+    ParallelParser(const ParallelParser &) = delete;
+    ParallelParser & operator=(const ParallelParser &) = delete;
+
+    /*! \brief see ljson_parse_parallel */
+    int Parse(ljson_value* v, const char* json, size_t len, ljson_arena* arena = nullptr);
+    int Parse(ljson_value* v, const std::string & json, ljson_arena* arena = nullptr) {
+        return Parse(v, json.data(), json.size(), arena);
+    }
+    /*! \brief the number of threads which parse, the calling one included */
+    unsigned GetThreads() const { return (unsigned)mworkers.size() + 1; }
+private:
+    friend int ljson_parse_parallel(ljson_value* v, const char* json, size_t len, unsigned threads, ljson_arena* arena);
+    struct Part {
+        const char* begin;
+        const char* end;
+        ljson_value* out;       /*!< the elements of the part in the result array */
+        size_t count;           /*!< the elements the splitter counted */
+        size_t parsed;          /*!< the elements written to out */
+        int result;
+    };
+
+    void work(unsigned worker);
+    void parse_parts(unsigned worker, std::unique_lock<std::mutex> & lock);
+    /* Parse on at most threads of the threads */
+    int parse(ljson_value* v, const char* json, size_t len, ljson_arena* arena, unsigned threads);
+
+    bool mstop;                         /*!< the workers should exit */
+    ljson_arena* marena;                /*!< the arena of the current parse */
+    size_t mnext;                       /*!< the next part to parse */
+    size_t mdone;                       /*!< the number of parsed parts */
+    std::vector<Part> mparts;
+    std::vector<ljson_arena> marenas;   /*!< one per thread, the calling one is 0 */
+    std::mutex mmutex;
+    std::condition_variable mwake;      /*!< a part to parse, or the end */
+    std::condition_variable mready;     /*!< every part is parsed */
+    std::vector<std::thread> mworkers;
+}; /*class ParallelParser*/
+
+
+/////////////////////////
+/* The Implement       */
+/////////////////////////
 
 typedef struct {
     const char* json;
+    const char* end;        /*!< the end of the input, it is never read */
+    bool insitu;            /*!< json points into a mutable buffer, decode the strings in place */
+    std::string scratch;    /*!< decode buffer of escaped strings, keeps its capacity */
+    size_t max_depth = LJSON_MAX_DEPTH;     /*!< see LJSON_PARSE_DEPTH_EXCEEDED */
+    std::vector<size_t> frames;             /*!< the open containers, see ljson_parse_nested */
 } ljson_context;
 
-static int ljson_parse_value(ljson_context* c, ljson_value* v);
+template <typename Handler>
+static int ljson_parse_value(ljson_context* c, Handler & h);
+
+/* store a string of at most LJSON_SHORT_STRING_MAX chars in v itself */
+static void ljson_set_short(ljson_value* v, const char* s, size_t len) {
+    assert(len <= LJSON_SHORT_STRING_MAX);
+    memcpy(v->data.mshort, s, len);
+    v->data.mshort[len] = '\0';
+    /* a string of the maximum length ends with the NUL which says 0 chars are left */
+    v->data.mshort[LJSON_SHORT_STRING_MAX] = char(LJSON_SHORT_STRING_MAX - len);
+    v->flags = LJSON_FLAG_SHORT;
+    v->type = LJSON_STRING;
+}
+
+/* the chars of a string, whatever its storage */
+static const char* ljson_string_data(const ljson_value* v) {
+    if (v->flags & LJSON_FLAG_SHORT)
+        return v->data.mshort;
+    if (v->flags & LJSON_FLAG_SLICE)
+        return v->data.mslice.ptr;
+    return v->data.mstring->data();
+}
+
+static size_t ljson_string_size(const ljson_value* v) {
+    if (v->flags & LJSON_FLAG_SHORT)
+        return LJSON_SHORT_STRING_MAX - (unsigned char)v->data.mshort[LJSON_SHORT_STRING_MAX];
+    if (v->flags & LJSON_FLAG_SLICE)
+        return v->data.mslice.len;
+    return v->data.mstring->size();
+}
+
+/* whether ljson_free has nothing to release in v, see LJSON_FLAG_ARENA_TREE */
+static bool ljson_owns_nothing(const ljson_value* v) {
+    switch (v->type) {
+        case LJSON_STRING:  return (v->flags & (LJSON_FLAG_SLICE | LJSON_FLAG_SHORT)) != 0;
+        case LJSON_ARRAY:
+        case LJSON_OBJECT:  return (v->flags & (LJSON_FLAG_ARENA_TREE | LJSON_FLAG_LAZY)) != 0;
+        default:            return true;
+    }
+}
+
+/*
+ * the stack of a walk over a tree, which is iterative since SetMaxDepth lets a tree nest
+ * without a limit: the first levels are kept in place, the deeper ones on the heap
+ */
+template <typename Frame>
+class ljson_walk_stack {
+public:
+    ljson_walk_stack() : msize(0) { }
+    bool empty() const { return msize == 0; }
+    Frame & top() { return msize <= LOCAL ? mlocal[msize - 1] : mdeep.back(); }
+    void push(const Frame & frame) {
+        if (msize < LOCAL)
+            mlocal[msize] = frame;
+        else
+            mdeep.push_back(frame);
+        msize++;
+    }
+    void pop() {
+        if (msize > LOCAL)
+            mdeep.pop_back();
+        msize--;
+    }
+private:
+    static const size_t LOCAL = 32;
+    Frame mlocal[LOCAL];
+    std::vector<Frame> mdeep;
+    size_t msize;
+};
+
+/* the elements or members of an array or object */
+static size_t ljson_child_count(const ljson_value* v) {
+    return v->type == LJSON_ARRAY ? v->data.marray->size() : v->data.mobject->size();
+}
+
+static ljson_value* ljson_child(const ljson_value* v, size_t i) {
+    if (v->type == LJSON_ARRAY)
+        return &(*v->data.marray)[i];
+    return &(v->data.mobject->begin() + i)->second;
+}
 
 void ljson_free(ljson_value* v) {
+    struct Frame { ljson_value* v; size_t next; };
+    ljson_walk_stack<Frame> stack;
     assert(v != nullptr);
-    switch(v->type) {
-        case LJSON_STRING:
-            assert(v->data.mstring != nullptr);
-            delete v->data.mstring;
-            break;
-        case LJSON_ARRAY:
-            assert(v->data.marray != nullptr);
-            for (auto iter = (v->data.marray)->begin(); iter != (v->data.marray)->end(); iter++)
-                ljson_free(&(*iter));
-            delete v->data.marray;
-            break;
-        case LJSON_OBJECT:
-            assert(v->data.mobject != nullptr);
-            for (auto iter = (v->data.mobject)->begin(); iter != (v->data.mobject)->end(); iter++)
-                ljson_free(&(*iter).second);
-            delete v->data.mobject;
-            break;
-        default:
-            break;
+    for (;;) {
+        if (v->flags & (LJSON_FLAG_LAZY | LJSON_FLAG_ARENA_TREE))
+            v->type = LJSON_NULL;   /* the nodes are released with their arena */
+        switch (v->type) {
+            case LJSON_STRING:
+                if (!(v->flags & (LJSON_FLAG_SLICE | LJSON_FLAG_SHORT))) {
+                    assert(v->data.mstring != nullptr);
+                    delete v->data.mstring;
+                }
+                break;
+            case LJSON_ARRAY:
+            case LJSON_OBJECT:
+                assert(v->data.marray != nullptr);
+                stack.push(Frame{v, 0});
+                break;
+            default:
+                break;
+        }
+        if (v->type != LJSON_ARRAY && v->type != LJSON_OBJECT) {
+            v->type = LJSON_NULL;
+            v->flags = 0;
+        }
+        /* the next child of the innermost container, the containers without one left are released */
+        v = nullptr;
+        while (!stack.empty()) {
+            Frame & f = stack.top();
+            if (f.next < ljson_child_count(f.v)) {
+                v = ljson_child(f.v, f.next++);
+                break;
+            }
+            if (f.v->type == LJSON_ARRAY) {
+                if (f.v->flags & LJSON_FLAG_ARENA)
+                    f.v->data.marray->~ljson_array();
+                else
+                    delete f.v->data.marray;
+            } else {
+                if (f.v->flags & LJSON_FLAG_ARENA)
+                    f.v->data.mobject->~ljson_map();
+                else
+                    delete f.v->data.mobject;
+            }
+            f.v->type = LJSON_NULL;
+            f.v->flags = 0;
+            stack.pop();
+        }
+        if (v == nullptr)
+            return;
     }
-    v->type = LJSON_NULL;
+}
+
+/* construct a T in the arena if there is one, or on the heap */
+template <typename T, typename... Args>
+static T* ljson_create(ljson_arena* arena, Args&&... args) {
+    if (arena == nullptr)
+        return new T(std::forward<Args>(args)...);
+    return new (arena->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
 }
 
 inline void expect_char(ljson_context* c, char ch) { 
-    assert(*c->json == (ch));
+    assert(c->json < c->end && *c->json == (ch));
     c->json++;
 }
 
+/* the byte at p, or '\0' at the end of the input */
+inline char ljson_peek(const char* p, const char* end) {
+    return p < end ? *p : '\0';
+}
+
 inline bool isdigit1to9(char ch) {
-    return isdigit(ch) && ch != '0';
+    return ch >= '1' && ch <= '9';
+}
+
+inline bool ljson_is_whitespace(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+/* index of the lowest set bit, mask must not be 0 */
+inline unsigned ljson_ctz(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+/*
+ * The kernels below read whole aligned blocks while a block fits before end,
+ * the rest is scanned byte by byte. Nothing past end is ever read.
+ */
+static const char* ljson_skip_whitespace(const char* p, const char* end) {
+    /* minified json: the next byte is almost never a whitespace */
+    if (p == end || !ljson_is_whitespace(*p))
+        return p;
+    p++;
+#if defined(LJSON_AVX2)
+    const size_t block = 32;
+#elif defined(LJSON_SSE2)
+    const size_t block = 16;
+#else
+    const size_t block = 1;
+#endif
+    /* scalar until the block is aligned, aligned loads never cross a page */
+    for (; (reinterpret_cast<uintptr_t>(p) & (block - 1)) != 0; p++)
+        if (p == end || !ljson_is_whitespace(*p))
+            return p;
+#if defined(LJSON_AVX2)
+    const __m256i sp = _mm256_set1_epi8(' '), nl = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r'), tab = _mm256_set1_epi8('\t');
+    for (; end - p >= 32; p += 32) {
+        const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i x = _mm256_or_si256(_mm256_cmpeq_epi8(s, sp), _mm256_cmpeq_epi8(s, nl));
+        x = _mm256_or_si256(x, _mm256_or_si256(_mm256_cmpeq_epi8(s, cr), _mm256_cmpeq_epi8(s, tab)));
+        uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(x);
+        if (mask != 0)
+            return p + ljson_ctz(mask);
+    }
+#elif defined(LJSON_SSE2)
+    const __m128i sp = _mm_set1_epi8(' '), nl = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r'), tab = _mm_set1_epi8('\t');
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i x = _mm_or_si128(_mm_cmpeq_epi8(s, sp), _mm_cmpeq_epi8(s, nl));
+        x = _mm_or_si128(x, _mm_or_si128(_mm_cmpeq_epi8(s, cr), _mm_cmpeq_epi8(s, tab)));
+        uint32_t mask = ~(uint32_t)_mm_movemask_epi8(x) & 0xFFFF;
+        if (mask != 0)
+            return p + ljson_ctz(mask);
+    }
+#endif
+    /* the tail shorter than a block */
+    while (p < end && ljson_is_whitespace(*p))
+        p++;
+    return p;
 }
 
 static void ljson_parse_whitespace(ljson_context* c) {
-    const char *p = c->json;
-    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+    c->json = ljson_skip_whitespace(c->json, c->end);
+}
+
+inline bool ljson_is_string_stop(char ch) {
+    return ch == '\"' || ch == '\\' || (unsigned char)ch < 0x20;
+}
+
+/* find the first '"', '\\' or control character before end, or end */
+static const char* ljson_scan_string(const char* p, const char* end) {
+#if defined(LJSON_AVX2)
+    const size_t block = 32;
+#elif defined(LJSON_SSE2)
+    const size_t block = 16;
+#else
+    const size_t block = 1;
+#endif
+    for (; (reinterpret_cast<uintptr_t>(p) & (block - 1)) != 0; p++)
+        if (p == end || ljson_is_string_stop(*p))
+            return p;
+#if defined(LJSON_AVX2)
+    const __m256i quote = _mm256_set1_epi8('\"'), slash = _mm256_set1_epi8('\\');
+    const __m256i ctrl = _mm256_set1_epi8(0x1F);
+    for (; end - p >= 32; p += 32) {
+        const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i x = _mm256_or_si256(_mm256_cmpeq_epi8(s, quote), _mm256_cmpeq_epi8(s, slash));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(_mm256_max_epu8(s, ctrl), ctrl));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(x);
+        if (mask != 0)
+            return p + ljson_ctz(mask);
+    }
+#elif defined(LJSON_SSE2)
+    const __m128i quote = _mm_set1_epi8('\"'), slash = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1F);
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i x = _mm_or_si128(_mm_cmpeq_epi8(s, quote), _mm_cmpeq_epi8(s, slash));
+        x = _mm_or_si128(x, _mm_cmpeq_epi8(_mm_max_epu8(s, ctrl), ctrl));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(x);
+        if (mask != 0)
+            return p + ljson_ctz(mask);
+    }
+#endif
+    /* the tail shorter than a block */
+    while (p < end && !ljson_is_string_stop(*p))
         p++;
-    c->json = p;
+    return p;
 }
 
-static int ljson_parse_literal(ljson_context* c, ljson_value* v, const char* literal, ljson_type type) {
+static int ljson_parse_literal(ljson_context* c, const char* literal) {
     expect_char(c, literal[0]);
     size_t i = 0;
     for (; literal[i + 1]; i++) {
-        if (c->json[i] != literal[i + 1])
+        if (ljson_peek(c->json + i, c->end) != literal[i + 1])
             return LJSON_PARSE_INVALID_VALUE;
     }
     c->json += i;
-    v->type = type;
     return LJSON_PARSE_OK;
 }
 
+/* 128-bit mantissas of 10^e, rounded down, for e in [-348, 347]: { high 64 bits, low 64 bits } */
+static const uint64_t ljson_pow10_table[][2] = {
+    { 0xFA8FD5A0081C0288ULL, 0x1732C869CD60E453ULL }, /* 1e-348 */
+    { 0x9C99E58405118195ULL, 0x0E7FBD42205C8EB4ULL }, /* 1e-347 */
+    { 0xC3C05EE50655E1FAULL, 0x521FAC92A873B261ULL }, /* 1e-346 */
+    { 0xF4B0769E47EB5A78ULL, 0xE6A797B752909EF9ULL }, /* 1e-345 */
+    { 0x98EE4A22ECF3188BULL, 0x9028BED2939A635CULL }, /* 1e-344 */
+    { 0xBF29DCABA82FDEAEULL, 0x7432EE873880FC33ULL }, /* 1e-343 */
+    { 0xEEF453D6923BD65AULL, 0x113FAA2906A13B3FULL }, /* 1e-342 */
+    { 0x9558B4661B6565F8ULL, 0x4AC7CA59A424C507ULL }, /* 1e-341 */
+    { 0xBAAEE17FA23EBF76ULL, 0x5D79BCF00D2DF649ULL }, /* 1e-340 */
+    { 0xE95A99DF8ACE6F53ULL, 0xF4D82C2C107973DCULL }, /* 1e-339 */
+    { 0x91D8A02BB6C10594ULL, 0x79071B9B8A4BE869ULL }, /* 1e-338 */
+    { 0xB64EC836A47146F9ULL, 0x9748E2826CDEE284ULL }, /* 1e-337 */
+    { 0xE3E27A444D8D98B7ULL, 0xFD1B1B2308169B25ULL }, /* 1e-336 */
+    { 0x8E6D8C6AB0787F72ULL, 0xFE30F0F5E50E20F7ULL }, /* 1e-335 */
+    { 0xB208EF855C969F4FULL, 0xBDBD2D335E51A935ULL }, /* 1e-334 */
+    { 0xDE8B2B66B3BC4723ULL, 0xAD2C788035E61382ULL }, /* 1e-333 */
+    { 0x8B16FB203055AC76ULL, 0x4C3BCB5021AFCC31ULL }, /* 1e-332 */
+    { 0xADDCB9E83C6B1793ULL, 0xDF4ABE242A1BBF3DULL }, /* 1e-331 */
+    { 0xD953E8624B85DD78ULL, 0xD71D6DAD34A2AF0DULL }, /* 1e-330 */
+    { 0x87D4713D6F33AA6BULL, 0x8672648C40E5AD68ULL }, /* 1e-329 */
+    { 0xA9C98D8CCB009506ULL, 0x680EFDAF511F18C2ULL }, /* 1e-328 */
+    { 0xD43BF0EFFDC0BA48ULL, 0x0212BD1B2566DEF2ULL }, /* 1e-327 */
+    { 0x84A57695FE98746DULL, 0x014BB630F7604B57ULL }, /* 1e-326 */
+    { 0xA5CED43B7E3E9188ULL, 0x419EA3BD35385E2DULL }, /* 1e-325 */
+    { 0xCF42894A5DCE35EAULL, 0x52064CAC828675B9ULL }, /* 1e-324 */
+    { 0x818995CE7AA0E1B2ULL, 0x7343EFEBD1940993ULL }, /* 1e-323 */
+    { 0xA1EBFB4219491A1FULL, 0x1014EBE6C5F90BF8ULL }, /* 1e-322 */
+    { 0xCA66FA129F9B60A6ULL, 0xD41A26E077774EF6ULL }, /* 1e-321 */
+    { 0xFD00B897478238D0ULL, 0x8920B098955522B4ULL }, /* 1e-320 */
+    { 0x9E20735E8CB16382ULL, 0x55B46E5F5D5535B0ULL }, /* 1e-319 */
+    { 0xC5A890362FDDBC62ULL, 0xEB2189F734AA831DULL }, /* 1e-318 */
+    { 0xF712B443BBD52B7BULL, 0xA5E9EC7501D523E4ULL }, /* 1e-317 */
+    { 0x9A6BB0AA55653B2DULL, 0x47B233C92125366EULL }, /* 1e-316 */
+    { 0xC1069CD4EABE89F8ULL, 0x999EC0BB696E840AULL }, /* 1e-315 */
+    { 0xF148440A256E2C76ULL, 0xC00670EA43CA250DULL }, /* 1e-314 */
+    { 0x96CD2A865764DBCAULL, 0x380406926A5E5728ULL }, /* 1e-313 */
+    { 0xBC807527ED3E12BCULL, 0xC605083704F5ECF2ULL }, /* 1e-312 */
+    { 0xEBA09271E88D976BULL, 0xF7864A44C633682EULL }, /* 1e-311 */
+    { 0x93445B8731587EA3ULL, 0x7AB3EE6AFBE0211DULL }, /* 1e-310 */
+    { 0xB8157268FDAE9E4CULL, 0x5960EA05BAD82964ULL }, /* 1e-309 */
+    { 0xE61ACF033D1A45DFULL, 0x6FB92487298E33BDULL }, /* 1e-308 */
+    { 0x8FD0C16206306BABULL, 0xA5D3B6D479F8E056ULL }, /* 1e-307 */
+    { 0xB3C4F1BA87BC8696ULL, 0x8F48A4899877186CULL }, /* 1e-306 */
+    { 0xE0B62E2929ABA83CULL, 0x331ACDABFE94DE87ULL }, /* 1e-305 */
+    { 0x8C71DCD9BA0B4925ULL, 0x9FF0C08B7F1D0B14ULL }, /* 1e-304 */
+    { 0xAF8E5410288E1B6FULL, 0x07ECF0AE5EE44DD9ULL }, /* 1e-303 */
+    { 0xDB71E91432B1A24AULL, 0xC9E82CD9F69D6150ULL }, /* 1e-302 */
+    { 0x892731AC9FAF056EULL, 0xBE311C083A225CD2ULL }, /* 1e-301 */
+    { 0xAB70FE17C79AC6CAULL, 0x6DBD630A48AAF406ULL }, /* 1e-300 */
+    { 0xD64D3D9DB981787DULL, 0x092CBBCCDAD5B108ULL }, /* 1e-299 */
+    { 0x85F0468293F0EB4EULL, 0x25BBF56008C58EA5ULL }, /* 1e-298 */
+    { 0xA76C582338ED2621ULL, 0xAF2AF2B80AF6F24EULL }, /* 1e-297 */
+    { 0xD1476E2C07286FAAULL, 0x1AF5AF660DB4AEE1ULL }, /* 1e-296 */
+    { 0x82CCA4DB847945CAULL, 0x50D98D9FC890ED4DULL }, /* 1e-295 */
+    { 0xA37FCE126597973CULL, 0xE50FF107BAB528A0ULL }, /* 1e-294 */
+    { 0xCC5FC196FEFD7D0CULL, 0x1E53ED49A96272C8ULL }, /* 1e-293 */
+    { 0xFF77B1FCBEBCDC4FULL, 0x25E8E89C13BB0F7AULL }, /* 1e-292 */
+    { 0x9FAACF3DF73609B1ULL, 0x77B191618C54E9ACULL }, /* 1e-291 */
+    { 0xC795830D75038C1DULL, 0xD59DF5B9EF6A2417ULL }, /* 1e-290 */
+    { 0xF97AE3D0D2446F25ULL, 0x4B0573286B44AD1DULL }, /* 1e-289 */
+    { 0x9BECCE62836AC577ULL, 0x4EE367F9430AEC32ULL }, /* 1e-288 */
+    { 0xC2E801FB244576D5ULL, 0x229C41F793CDA73FULL }, /* 1e-287 */
+    { 0xF3A20279ED56D48AULL, 0x6B43527578C1110FULL }, /* 1e-286 */
+    { 0x9845418C345644D6ULL, 0x830A13896B78AAA9ULL }, /* 1e-285 */
+    { 0xBE5691EF416BD60CULL, 0x23CC986BC656D553ULL }, /* 1e-284 */
+    { 0xEDEC366B11C6CB8FULL, 0x2CBFBE86B7EC8AA8ULL }, /* 1e-283 */
+    { 0x94B3A202EB1C3F39ULL, 0x7BF7D71432F3D6A9ULL }, /* 1e-282 */
+    { 0xB9E08A83A5E34F07ULL, 0xDAF5CCD93FB0CC53ULL }, /* 1e-281 */
+    { 0xE858AD248F5C22C9ULL, 0xD1B3400F8F9CFF68ULL }, /* 1e-280 */
+    { 0x91376C36D99995BEULL, 0x23100809B9C21FA1ULL }, /* 1e-279 */
+    { 0xB58547448FFFFB2DULL, 0xABD40A0C2832A78AULL }, /* 1e-278 */
+    { 0xE2E69915B3FFF9F9ULL, 0x16C90C8F323F516CULL }, /* 1e-277 */
+    { 0x8DD01FAD907FFC3BULL, 0xAE3DA7D97F6792E3ULL }, /* 1e-276 */
+    { 0xB1442798F49FFB4AULL, 0x99CD11CFDF41779CULL }, /* 1e-275 */
+    { 0xDD95317F31C7FA1DULL, 0x40405643D711D583ULL }, /* 1e-274 */
+    { 0x8A7D3EEF7F1CFC52ULL, 0x482835EA666B2572ULL }, /* 1e-273 */
+    { 0xAD1C8EAB5EE43B66ULL, 0xDA3243650005EECFULL }, /* 1e-272 */
+    { 0xD863B256369D4A40ULL, 0x90BED43E40076A82ULL }, /* 1e-271 */
+    { 0x873E4F75E2224E68ULL, 0x5A7744A6E804A291ULL }, /* 1e-270 */
+    { 0xA90DE3535AAAE202ULL, 0x711515D0A205CB36ULL }, /* 1e-269 */
+    { 0xD3515C2831559A83ULL, 0x0D5A5B44CA873E03ULL }, /* 1e-268 */
+    { 0x8412D9991ED58091ULL, 0xE858790AFE9486C2ULL }, /* 1e-267 */
+    { 0xA5178FFF668AE0B6ULL, 0x626E974DBE39A872ULL }, /* 1e-266 */
+    { 0xCE5D73FF402D98E3ULL, 0xFB0A3D212DC8128FULL }, /* 1e-265 */
+    { 0x80FA687F881C7F8EULL, 0x7CE66634BC9D0B99ULL }, /* 1e-264 */
+    { 0xA139029F6A239F72ULL, 0x1C1FFFC1EBC44E80ULL }, /* 1e-263 */
+    { 0xC987434744AC874EULL, 0xA327FFB266B56220ULL }, /* 1e-262 */
+    { 0xFBE9141915D7A922ULL, 0x4BF1FF9F0062BAA8ULL }, /* 1e-261 */
+    { 0x9D71AC8FADA6C9B5ULL, 0x6F773FC3603DB4A9ULL }, /* 1e-260 */
+    { 0xC4CE17B399107C22ULL, 0xCB550FB4384D21D3ULL }, /* 1e-259 */
+    { 0xF6019DA07F549B2BULL, 0x7E2A53A146606A48ULL }, /* 1e-258 */
+    { 0x99C102844F94E0FBULL, 0x2EDA7444CBFC426DULL }, /* 1e-257 */
+    { 0xC0314325637A1939ULL, 0xFA911155FEFB5308ULL }, /* 1e-256 */
+    { 0xF03D93EEBC589F88ULL, 0x793555AB7EBA27CAULL }, /* 1e-255 */
+    { 0x96267C7535B763B5ULL, 0x4BC1558B2F3458DEULL }, /* 1e-254 */
+    { 0xBBB01B9283253CA2ULL, 0x9EB1AAEDFB016F16ULL }, /* 1e-253 */
+    { 0xEA9C227723EE8BCBULL, 0x465E15A979C1CADCULL }, /* 1e-252 */
+    { 0x92A1958A7675175FULL, 0x0BFACD89EC191EC9ULL }, /* 1e-251 */
+    { 0xB749FAED14125D36ULL, 0xCEF980EC671F667BULL }, /* 1e-250 */
+    { 0xE51C79A85916F484ULL, 0x82B7E12780E7401AULL }, /* 1e-249 */
+    { 0x8F31CC0937AE58D2ULL, 0xD1B2ECB8B0908810ULL }, /* 1e-248 */
+    { 0xB2FE3F0B8599EF07ULL, 0x861FA7E6DCB4AA15ULL }, /* 1e-247 */
+    { 0xDFBDCECE67006AC9ULL, 0x67A791E093E1D49AULL }, /* 1e-246 */
+    { 0x8BD6A141006042BDULL, 0xE0C8BB2C5C6D24E0ULL }, /* 1e-245 */
+    { 0xAECC49914078536DULL, 0x58FAE9F773886E18ULL }, /* 1e-244 */
+    { 0xDA7F5BF590966848ULL, 0xAF39A475506A899EULL }, /* 1e-243 */
+    { 0x888F99797A5E012DULL, 0x6D8406C952429603ULL }, /* 1e-242 */
+    { 0xAAB37FD7D8F58178ULL, 0xC8E5087BA6D33B83ULL }, /* 1e-241 */
+    { 0xD5605FCDCF32E1D6ULL, 0xFB1E4A9A90880A64ULL }, /* 1e-240 */
+    { 0x855C3BE0A17FCD26ULL, 0x5CF2EEA09A55067FULL }, /* 1e-239 */
+    { 0xA6B34AD8C9DFC06FULL, 0xF42FAA48C0EA481EULL }, /* 1e-238 */
+    { 0xD0601D8EFC57B08BULL, 0xF13B94DAF124DA26ULL }, /* 1e-237 */
+    { 0x823C12795DB6CE57ULL, 0x76C53D08D6B70858ULL }, /* 1e-236 */
+    { 0xA2CB1717B52481EDULL, 0x54768C4B0C64CA6EULL }, /* 1e-235 */
+    { 0xCB7DDCDDA26DA268ULL, 0xA9942F5DCF7DFD09ULL }, /* 1e-234 */
+    { 0xFE5D54150B090B02ULL, 0xD3F93B35435D7C4CULL }, /* 1e-233 */
+    { 0x9EFA548D26E5A6E1ULL, 0xC47BC5014A1A6DAFULL }, /* 1e-232 */
+    { 0xC6B8E9B0709F109AULL, 0x359AB6419CA1091BULL }, /* 1e-231 */
+    { 0xF867241C8CC6D4C0ULL, 0xC30163D203C94B62ULL }, /* 1e-230 */
+    { 0x9B407691D7FC44F8ULL, 0x79E0DE63425DCF1DULL }, /* 1e-229 */
+    { 0xC21094364DFB5636ULL, 0x985915FC12F542E4ULL }, /* 1e-228 */
+    { 0xF294B943E17A2BC4ULL, 0x3E6F5B7B17B2939DULL }, /* 1e-227 */
+    { 0x979CF3CA6CEC5B5AULL, 0xA705992CEECF9C42ULL }, /* 1e-226 */
+    { 0xBD8430BD08277231ULL, 0x50C6FF782A838353ULL }, /* 1e-225 */
+    { 0xECE53CEC4A314EBDULL, 0xA4F8BF5635246428ULL }, /* 1e-224 */
+    { 0x940F4613AE5ED136ULL, 0x871B7795E136BE99ULL }, /* 1e-223 */
+    { 0xB913179899F68584ULL, 0x28E2557B59846E3FULL }, /* 1e-222 */
+    { 0xE757DD7EC07426E5ULL, 0x331AEADA2FE589CFULL }, /* 1e-221 */
+    { 0x9096EA6F3848984FULL, 0x3FF0D2C85DEF7621ULL }, /* 1e-220 */
+    { 0xB4BCA50B065ABE63ULL, 0x0FED077A756B53A9ULL }, /* 1e-219 */
+    { 0xE1EBCE4DC7F16DFBULL, 0xD3E8495912C62894ULL }, /* 1e-218 */
+    { 0x8D3360F09CF6E4BDULL, 0x64712DD7ABBBD95CULL }, /* 1e-217 */
+    { 0xB080392CC4349DECULL, 0xBD8D794D96AACFB3ULL }, /* 1e-216 */
+    { 0xDCA04777F541C567ULL, 0xECF0D7A0FC5583A0ULL }, /* 1e-215 */
+    { 0x89E42CAAF9491B60ULL, 0xF41686C49DB57244ULL }, /* 1e-214 */
+    { 0xAC5D37D5B79B6239ULL, 0x311C2875C522CED5ULL }, /* 1e-213 */
+    { 0xD77485CB25823AC7ULL, 0x7D633293366B828BULL }, /* 1e-212 */
+    { 0x86A8D39EF77164BCULL, 0xAE5DFF9C02033197ULL }, /* 1e-211 */
+    { 0xA8530886B54DBDEBULL, 0xD9F57F830283FDFCULL }, /* 1e-210 */
+    { 0xD267CAA862A12D66ULL, 0xD072DF63C324FD7BULL }, /* 1e-209 */
+    { 0x8380DEA93DA4BC60ULL, 0x4247CB9E59F71E6DULL }, /* 1e-208 */
+    { 0xA46116538D0DEB78ULL, 0x52D9BE85F074E608ULL }, /* 1e-207 */
+    { 0xCD795BE870516656ULL, 0x67902E276C921F8BULL }, /* 1e-206 */
+    { 0x806BD9714632DFF6ULL, 0x00BA1CD8A3DB53B6ULL }, /* 1e-205 */
+    { 0xA086CFCD97BF97F3ULL, 0x80E8A40ECCD228A4ULL }, /* 1e-204 */
+    { 0xC8A883C0FDAF7DF0ULL, 0x6122CD128006B2CDULL }, /* 1e-203 */
+    { 0xFAD2A4B13D1B5D6CULL, 0x796B805720085F81ULL }, /* 1e-202 */
+    { 0x9CC3A6EEC6311A63ULL, 0xCBE3303674053BB0ULL }, /* 1e-201 */
+    { 0xC3F490AA77BD60FCULL, 0xBEDBFC4411068A9CULL }, /* 1e-200 */
+    { 0xF4F1B4D515ACB93BULL, 0xEE92FB5515482D44ULL }, /* 1e-199 */
+    { 0x991711052D8BF3C5ULL, 0x751BDD152D4D1C4AULL }, /* 1e-198 */
+    { 0xBF5CD54678EEF0B6ULL, 0xD262D45A78A0635DULL }, /* 1e-197 */
+    { 0xEF340A98172AACE4ULL, 0x86FB897116C87C34ULL }, /* 1e-196 */
+    { 0x9580869F0E7AAC0EULL, 0xD45D35E6AE3D4DA0ULL }, /* 1e-195 */
+    { 0xBAE0A846D2195712ULL, 0x8974836059CCA109ULL }, /* 1e-194 */
+    { 0xE998D258869FACD7ULL, 0x2BD1A438703FC94BULL }, /* 1e-193 */
+    { 0x91FF83775423CC06ULL, 0x7B6306A34627DDCFULL }, /* 1e-192 */
+    { 0xB67F6455292CBF08ULL, 0x1A3BC84C17B1D542ULL }, /* 1e-191 */
+    { 0xE41F3D6A7377EECAULL, 0x20CABA5F1D9E4A93ULL }, /* 1e-190 */
+    { 0x8E938662882AF53EULL, 0x547EB47B7282EE9CULL }, /* 1e-189 */
+    { 0xB23867FB2A35B28DULL, 0xE99E619A4F23AA43ULL }, /* 1e-188 */
+    { 0xDEC681F9F4C31F31ULL, 0x6405FA00E2EC94D4ULL }, /* 1e-187 */
+    { 0x8B3C113C38F9F37EULL, 0xDE83BC408DD3DD04ULL }, /* 1e-186 */
+    { 0xAE0B158B4738705EULL, 0x9624AB50B148D445ULL }, /* 1e-185 */
+    { 0xD98DDAEE19068C76ULL, 0x3BADD624DD9B0957ULL }, /* 1e-184 */
+    { 0x87F8A8D4CFA417C9ULL, 0xE54CA5D70A80E5D6ULL }, /* 1e-183 */
+    { 0xA9F6D30A038D1DBCULL, 0x5E9FCF4CCD211F4CULL }, /* 1e-182 */
+    { 0xD47487CC8470652BULL, 0x7647C3200069671FULL }, /* 1e-181 */
+    { 0x84C8D4DFD2C63F3BULL, 0x29ECD9F40041E073ULL }, /* 1e-180 */
+    { 0xA5FB0A17C777CF09ULL, 0xF468107100525890ULL }, /* 1e-179 */
+    { 0xCF79CC9DB955C2CCULL, 0x7182148D4066EEB4ULL }, /* 1e-178 */
+    { 0x81AC1FE293D599BFULL, 0xC6F14CD848405530ULL }, /* 1e-177 */
+    { 0xA21727DB38CB002FULL, 0xB8ADA00E5A506A7CULL }, /* 1e-176 */
+    { 0xCA9CF1D206FDC03BULL, 0xA6D90811F0E4851CULL }, /* 1e-175 */
+    { 0xFD442E4688BD304AULL, 0x908F4A166D1DA663ULL }, /* 1e-174 */
+    { 0x9E4A9CEC15763E2EULL, 0x9A598E4E043287FEULL }, /* 1e-173 */
+    { 0xC5DD44271AD3CDBAULL, 0x40EFF1E1853F29FDULL }, /* 1e-172 */
+    { 0xF7549530E188C128ULL, 0xD12BEE59E68EF47CULL }, /* 1e-171 */
+    { 0x9A94DD3E8CF578B9ULL, 0x82BB74F8301958CEULL }, /* 1e-170 */
+    { 0xC13A148E3032D6E7ULL, 0xE36A52363C1FAF01ULL }, /* 1e-169 */
+    { 0xF18899B1BC3F8CA1ULL, 0xDC44E6C3CB279AC1ULL }, /* 1e-168 */
+    { 0x96F5600F15A7B7E5ULL, 0x29AB103A5EF8C0B9ULL }, /* 1e-167 */
+    { 0xBCB2B812DB11A5DEULL, 0x7415D448F6B6F0E7ULL }, /* 1e-166 */
+    { 0xEBDF661791D60F56ULL, 0x111B495B3464AD21ULL }, /* 1e-165 */
+    { 0x936B9FCEBB25C995ULL, 0xCAB10DD900BEEC34ULL }, /* 1e-164 */
+    { 0xB84687C269EF3BFBULL, 0x3D5D514F40EEA742ULL }, /* 1e-163 */
+    { 0xE65829B3046B0AFAULL, 0x0CB4A5A3112A5112ULL }, /* 1e-162 */
+    { 0x8FF71A0FE2C2E6DCULL, 0x47F0E785EABA72ABULL }, /* 1e-161 */
+    { 0xB3F4E093DB73A093ULL, 0x59ED216765690F56ULL }, /* 1e-160 */
+    { 0xE0F218B8D25088B8ULL, 0x306869C13EC3532CULL }, /* 1e-159 */
+    { 0x8C974F7383725573ULL, 0x1E414218C73A13FBULL }, /* 1e-158 */
+    { 0xAFBD2350644EEACFULL, 0xE5D1929EF90898FAULL }, /* 1e-157 */
+    { 0xDBAC6C247D62A583ULL, 0xDF45F746B74ABF39ULL }, /* 1e-156 */
+    { 0x894BC396CE5DA772ULL, 0x6B8BBA8C328EB783ULL }, /* 1e-155 */
+    { 0xAB9EB47C81F5114FULL, 0x066EA92F3F326564ULL }, /* 1e-154 */
+    { 0xD686619BA27255A2ULL, 0xC80A537B0EFEFEBDULL }, /* 1e-153 */
+    { 0x8613FD0145877585ULL, 0xBD06742CE95F5F36ULL }, /* 1e-152 */
+    { 0xA798FC4196E952E7ULL, 0x2C48113823B73704ULL }, /* 1e-151 */
+    { 0xD17F3B51FCA3A7A0ULL, 0xF75A15862CA504C5ULL }, /* 1e-150 */
+    { 0x82EF85133DE648C4ULL, 0x9A984D73DBE722FBULL }, /* 1e-149 */
+    { 0xA3AB66580D5FDAF5ULL, 0xC13E60D0D2E0EBBAULL }, /* 1e-148 */
+    { 0xCC963FEE10B7D1B3ULL, 0x318DF905079926A8ULL }, /* 1e-147 */
+    { 0xFFBBCFE994E5C61FULL, 0xFDF17746497F7052ULL }, /* 1e-146 */
+    { 0x9FD561F1FD0F9BD3ULL, 0xFEB6EA8BEDEFA633ULL }, /* 1e-145 */
+    { 0xC7CABA6E7C5382C8ULL, 0xFE64A52EE96B8FC0ULL }, /* 1e-144 */
+    { 0xF9BD690A1B68637BULL, 0x3DFDCE7AA3C673B0ULL }, /* 1e-143 */
+    { 0x9C1661A651213E2DULL, 0x06BEA10CA65C084EULL }, /* 1e-142 */
+    { 0xC31BFA0FE5698DB8ULL, 0x486E494FCFF30A62ULL }, /* 1e-141 */
+    { 0xF3E2F893DEC3F126ULL, 0x5A89DBA3C3EFCCFAULL }, /* 1e-140 */
+    { 0x986DDB5C6B3A76B7ULL, 0xF89629465A75E01CULL }, /* 1e-139 */
+    { 0xBE89523386091465ULL, 0xF6BBB397F1135823ULL }, /* 1e-138 */
+    { 0xEE2BA6C0678B597FULL, 0x746AA07DED582E2CULL }, /* 1e-137 */
+    { 0x94DB483840B717EFULL, 0xA8C2A44EB4571CDCULL }, /* 1e-136 */
+    { 0xBA121A4650E4DDEBULL, 0x92F34D62616CE413ULL }, /* 1e-135 */
+    { 0xE896A0D7E51E1566ULL, 0x77B020BAF9C81D17ULL }, /* 1e-134 */
+    { 0x915E2486EF32CD60ULL, 0x0ACE1474DC1D122EULL }, /* 1e-133 */
+    { 0xB5B5ADA8AAFF80B8ULL, 0x0D819992132456BAULL }, /* 1e-132 */
+    { 0xE3231912D5BF60E6ULL, 0x10E1FFF697ED6C69ULL }, /* 1e-131 */
+    { 0x8DF5EFABC5979C8FULL, 0xCA8D3FFA1EF463C1ULL }, /* 1e-130 */
+    { 0xB1736B96B6FD83B3ULL, 0xBD308FF8A6B17CB2ULL }, /* 1e-129 */
+    { 0xDDD0467C64BCE4A0ULL, 0xAC7CB3F6D05DDBDEULL }, /* 1e-128 */
+    { 0x8AA22C0DBEF60EE4ULL, 0x6BCDF07A423AA96BULL }, /* 1e-127 */
+    { 0xAD4AB7112EB3929DULL, 0x86C16C98D2C953C6ULL }, /* 1e-126 */
+    { 0xD89D64D57A607744ULL, 0xE871C7BF077BA8B7ULL }, /* 1e-125 */
+    { 0x87625F056C7C4A8BULL, 0x11471CD764AD4972ULL }, /* 1e-124 */
+    { 0xA93AF6C6C79B5D2DULL, 0xD598E40D3DD89BCFULL }, /* 1e-123 */
+    { 0xD389B47879823479ULL, 0x4AFF1D108D4EC2C3ULL }, /* 1e-122 */
+    { 0x843610CB4BF160CBULL, 0xCEDF722A585139BAULL }, /* 1e-121 */
+    { 0xA54394FE1EEDB8FEULL, 0xC2974EB4EE658828ULL }, /* 1e-120 */
+    { 0xCE947A3DA6A9273EULL, 0x733D226229FEEA32ULL }, /* 1e-119 */
+    { 0x811CCC668829B887ULL, 0x0806357D5A3F525FULL }, /* 1e-118 */
+    { 0xA163FF802A3426A8ULL, 0xCA07C2DCB0CF26F7ULL }, /* 1e-117 */
+    { 0xC9BCFF6034C13052ULL, 0xFC89B393DD02F0B5ULL }, /* 1e-116 */
+    { 0xFC2C3F3841F17C67ULL, 0xBBAC2078D443ACE2ULL }, /* 1e-115 */
+    { 0x9D9BA7832936EDC0ULL, 0xD54B944B84AA4C0DULL }, /* 1e-114 */
+    { 0xC5029163F384A931ULL, 0x0A9E795E65D4DF11ULL }, /* 1e-113 */
+    { 0xF64335BCF065D37DULL, 0x4D4617B5FF4A16D5ULL }, /* 1e-112 */
+    { 0x99EA0196163FA42EULL, 0x504BCED1BF8E4E45ULL }, /* 1e-111 */
+    { 0xC06481FB9BCF8D39ULL, 0xE45EC2862F71E1D6ULL }, /* 1e-110 */
+    { 0xF07DA27A82C37088ULL, 0x5D767327BB4E5A4CULL }, /* 1e-109 */
+    { 0x964E858C91BA2655ULL, 0x3A6A07F8D510F86FULL }, /* 1e-108 */
+    { 0xBBE226EFB628AFEAULL, 0x890489F70A55368BULL }, /* 1e-107 */
+    { 0xEADAB0ABA3B2DBE5ULL, 0x2B45AC74CCEA842EULL }, /* 1e-106 */
+    { 0x92C8AE6B464FC96FULL, 0x3B0B8BC90012929DULL }, /* 1e-105 */
+    { 0xB77ADA0617E3BBCBULL, 0x09CE6EBB40173744ULL }, /* 1e-104 */
+    { 0xE55990879DDCAABDULL, 0xCC420A6A101D0515ULL }, /* 1e-103 */
+    { 0x8F57FA54C2A9EAB6ULL, 0x9FA946824A12232DULL }, /* 1e-102 */
+    { 0xB32DF8E9F3546564ULL, 0x47939822DC96ABF9ULL }, /* 1e-101 */
+    { 0xDFF9772470297EBDULL, 0x59787E2B93BC56F7ULL }, /* 1e-100 */
+    { 0x8BFBEA76C619EF36ULL, 0x57EB4EDB3C55B65AULL }, /* 1e-99 */
+    { 0xAEFAE51477A06B03ULL, 0xEDE622920B6B23F1ULL }, /* 1e-98 */
+    { 0xDAB99E59958885C4ULL, 0xE95FAB368E45ECEDULL }, /* 1e-97 */
+    { 0x88B402F7FD75539BULL, 0x11DBCB0218EBB414ULL }, /* 1e-96 */
+    { 0xAAE103B5FCD2A881ULL, 0xD652BDC29F26A119ULL }, /* 1e-95 */
+    { 0xD59944A37C0752A2ULL, 0x4BE76D3346F0495FULL }, /* 1e-94 */
+    { 0x857FCAE62D8493A5ULL, 0x6F70A4400C562DDBULL }, /* 1e-93 */
+    { 0xA6DFBD9FB8E5B88EULL, 0xCB4CCD500F6BB952ULL }, /* 1e-92 */
+    { 0xD097AD07A71F26B2ULL, 0x7E2000A41346A7A7ULL }, /* 1e-91 */
+    { 0x825ECC24C873782FULL, 0x8ED400668C0C28C8ULL }, /* 1e-90 */
+    { 0xA2F67F2DFA90563BULL, 0x728900802F0F32FAULL }, /* 1e-89 */
+    { 0xCBB41EF979346BCAULL, 0x4F2B40A03AD2FFB9ULL }, /* 1e-88 */
+    { 0xFEA126B7D78186BCULL, 0xE2F610C84987BFA8ULL }, /* 1e-87 */
+    { 0x9F24B832E6B0F436ULL, 0x0DD9CA7D2DF4D7C9ULL }, /* 1e-86 */
+    { 0xC6EDE63FA05D3143ULL, 0x91503D1C79720DBBULL }, /* 1e-85 */
+    { 0xF8A95FCF88747D94ULL, 0x75A44C6397CE912AULL }, /* 1e-84 */
+    { 0x9B69DBE1B548CE7CULL, 0xC986AFBE3EE11ABAULL }, /* 1e-83 */
+    { 0xC24452DA229B021BULL, 0xFBE85BADCE996168ULL }, /* 1e-82 */
+    { 0xF2D56790AB41C2A2ULL, 0xFAE27299423FB9C3ULL }, /* 1e-81 */
+    { 0x97C560BA6B0919A5ULL, 0xDCCD879FC967D41AULL }, /* 1e-80 */
+    { 0xBDB6B8E905CB600FULL, 0x5400E987BBC1C920ULL }, /* 1e-79 */
+    { 0xED246723473E3813ULL, 0x290123E9AAB23B68ULL }, /* 1e-78 */
+    { 0x9436C0760C86E30BULL, 0xF9A0B6720AAF6521ULL }, /* 1e-77 */
+    { 0xB94470938FA89BCEULL, 0xF808E40E8D5B3E69ULL }, /* 1e-76 */
+    { 0xE7958CB87392C2C2ULL, 0xB60B1D1230B20E04ULL }, /* 1e-75 */
+    { 0x90BD77F3483BB9B9ULL, 0xB1C6F22B5E6F48C2ULL }, /* 1e-74 */
+    { 0xB4ECD5F01A4AA828ULL, 0x1E38AEB6360B1AF3ULL }, /* 1e-73 */
+    { 0xE2280B6C20DD5232ULL, 0x25C6DA63C38DE1B0ULL }, /* 1e-72 */
+    { 0x8D590723948A535FULL, 0x579C487E5A38AD0EULL }, /* 1e-71 */
+    { 0xB0AF48EC79ACE837ULL, 0x2D835A9DF0C6D851ULL }, /* 1e-70 */
+    { 0xDCDB1B2798182244ULL, 0xF8E431456CF88E65ULL }, /* 1e-69 */
+    { 0x8A08F0F8BF0F156BULL, 0x1B8E9ECB641B58FFULL }, /* 1e-68 */
+    { 0xAC8B2D36EED2DAC5ULL, 0xE272467E3D222F3FULL }, /* 1e-67 */
+    { 0xD7ADF884AA879177ULL, 0x5B0ED81DCC6ABB0FULL }, /* 1e-66 */
+    { 0x86CCBB52EA94BAEAULL, 0x98E947129FC2B4E9ULL }, /* 1e-65 */
+    { 0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL }, /* 1e-64 */
+    { 0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL }, /* 1e-63 */
+    { 0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL }, /* 1e-62 */
+    { 0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL }, /* 1e-61 */
+    { 0xCDB02555653131B6ULL, 0x3792F412CB06794DULL }, /* 1e-60 */
+    { 0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL }, /* 1e-59 */
+    { 0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL }, /* 1e-58 */
+    { 0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL }, /* 1e-57 */
+    { 0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL }, /* 1e-56 */
+    { 0x9CED737BB6C4183DULL, 0x55464DD69685606BULL }, /* 1e-55 */
+    { 0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL }, /* 1e-54 */
+    { 0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL }, /* 1e-53 */
+    { 0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL }, /* 1e-52 */
+    { 0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL }, /* 1e-51 */
+    { 0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL }, /* 1e-50 */
+    { 0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL }, /* 1e-49 */
+    { 0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL }, /* 1e-48 */
+    { 0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL }, /* 1e-47 */
+    { 0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL }, /* 1e-46 */
+    { 0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL }, /* 1e-45 */
+    { 0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL }, /* 1e-44 */
+    { 0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL }, /* 1e-43 */
+    { 0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL }, /* 1e-42 */
+    { 0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL }, /* 1e-41 */
+    { 0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL }, /* 1e-40 */
+    { 0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL }, /* 1e-39 */
+    { 0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL }, /* 1e-38 */
+    { 0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL }, /* 1e-37 */
+    { 0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL }, /* 1e-36 */
+    { 0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL }, /* 1e-35 */
+    { 0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL }, /* 1e-34 */
+    { 0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL }, /* 1e-33 */
+    { 0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL }, /* 1e-32 */
+    { 0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL }, /* 1e-31 */
+    { 0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL }, /* 1e-30 */
+    { 0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL }, /* 1e-29 */
+    { 0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL }, /* 1e-28 */
+    { 0x9E74D1B791E07E48ULL, 0x775EA264CF55347DULL }, /* 1e-27 */
+    { 0xC612062576589DDAULL, 0x95364AFE032A819DULL }, /* 1e-26 */
+    { 0xF79687AED3EEC551ULL, 0x3A83DDBD83F52204ULL }, /* 1e-25 */
+    { 0x9ABE14CD44753B52ULL, 0xC4926A9672793542ULL }, /* 1e-24 */
+    { 0xC16D9A0095928A27ULL, 0x75B7053C0F178293ULL }, /* 1e-23 */
+    { 0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6338ULL }, /* 1e-22 */
+    { 0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E03ULL }, /* 1e-21 */
+    { 0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF584ULL }, /* 1e-20 */
+    { 0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E5ULL }, /* 1e-19 */
+    { 0x9392EE8E921D5D07ULL, 0x3AFF322E62439FCFULL }, /* 1e-18 */
+    { 0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C2ULL }, /* 1e-17 */
+    { 0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B3ULL }, /* 1e-16 */
+    { 0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A10ULL }, /* 1e-15 */
+    { 0xB424DC35095CD80FULL, 0x538484C19EF38C94ULL }, /* 1e-14 */
+    { 0xE12E13424BB40E13ULL, 0x2865A5F206B06FB9ULL }, /* 1e-13 */
+    { 0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D3ULL }, /* 1e-12 */
+    { 0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D748ULL }, /* 1e-11 */
+    { 0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1BULL }, /* 1e-10 */
+    { 0x89705F4136B4A597ULL, 0x31680A88F8953030ULL }, /* 1e-9 */
+    { 0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3DULL }, /* 1e-8 */
+    { 0xD6BF94D5E57A42BCULL, 0x3D32907604691B4CULL }, /* 1e-7 */
+    { 0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B10FULL }, /* 1e-6 */
+    { 0xA7C5AC471B478423ULL, 0x0FCF80DC33721D53ULL }, /* 1e-5 */
+    { 0xD1B71758E219652BULL, 0xD3C36113404EA4A8ULL }, /* 1e-4 */
+    { 0x83126E978D4FDF3BULL, 0x645A1CAC083126E9ULL }, /* 1e-3 */
+    { 0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A3ULL }, /* 1e-2 */
+    { 0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCCULL }, /* 1e-1 */
+    { 0x8000000000000000ULL, 0x0000000000000000ULL }, /* 1e0 */
+    { 0xA000000000000000ULL, 0x0000000000000000ULL }, /* 1e1 */
+    { 0xC800000000000000ULL, 0x0000000000000000ULL }, /* 1e2 */
+    { 0xFA00000000000000ULL, 0x0000000000000000ULL }, /* 1e3 */
+    { 0x9C40000000000000ULL, 0x0000000000000000ULL }, /* 1e4 */
+    { 0xC350000000000000ULL, 0x0000000000000000ULL }, /* 1e5 */
+    { 0xF424000000000000ULL, 0x0000000000000000ULL }, /* 1e6 */
+    { 0x9896800000000000ULL, 0x0000000000000000ULL }, /* 1e7 */
+    { 0xBEBC200000000000ULL, 0x0000000000000000ULL }, /* 1e8 */
+    { 0xEE6B280000000000ULL, 0x0000000000000000ULL }, /* 1e9 */
+    { 0x9502F90000000000ULL, 0x0000000000000000ULL }, /* 1e10 */
+    { 0xBA43B74000000000ULL, 0x0000000000000000ULL }, /* 1e11 */
+    { 0xE8D4A51000000000ULL, 0x0000000000000000ULL }, /* 1e12 */
+    { 0x9184E72A00000000ULL, 0x0000000000000000ULL }, /* 1e13 */
+    { 0xB5E620F480000000ULL, 0x0000000000000000ULL }, /* 1e14 */
+    { 0xE35FA931A0000000ULL, 0x0000000000000000ULL }, /* 1e15 */
+    { 0x8E1BC9BF04000000ULL, 0x0000000000000000ULL }, /* 1e16 */
+    { 0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL }, /* 1e17 */
+    { 0xDE0B6B3A76400000ULL, 0x0000000000000000ULL }, /* 1e18 */
+    { 0x8AC7230489E80000ULL, 0x0000000000000000ULL }, /* 1e19 */
+    { 0xAD78EBC5AC620000ULL, 0x0000000000000000ULL }, /* 1e20 */
+    { 0xD8D726B7177A8000ULL, 0x0000000000000000ULL }, /* 1e21 */
+    { 0x878678326EAC9000ULL, 0x0000000000000000ULL }, /* 1e22 */
+    { 0xA968163F0A57B400ULL, 0x0000000000000000ULL }, /* 1e23 */
+    { 0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL }, /* 1e24 */
+    { 0x84595161401484A0ULL, 0x0000000000000000ULL }, /* 1e25 */
+    { 0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL }, /* 1e26 */
+    { 0xCECB8F27F4200F3AULL, 0x0000000000000000ULL }, /* 1e27 */
+    { 0x813F3978F8940984ULL, 0x4000000000000000ULL }, /* 1e28 */
+    { 0xA18F07D736B90BE5ULL, 0x5000000000000000ULL }, /* 1e29 */
+    { 0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL }, /* 1e30 */
+    { 0xFC6F7C4045812296ULL, 0x4D00000000000000ULL }, /* 1e31 */
+    { 0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL }, /* 1e32 */
+    { 0xC5371912364CE305ULL, 0x6C28000000000000ULL }, /* 1e33 */
+    { 0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL }, /* 1e34 */
+    { 0x9A130B963A6C115CULL, 0x3C7F400000000000ULL }, /* 1e35 */
+    { 0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL }, /* 1e36 */
+    { 0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL }, /* 1e37 */
+    { 0x96769950B50D88F4ULL, 0x1314448000000000ULL }, /* 1e38 */
+    { 0xBC143FA4E250EB31ULL, 0x17D955A000000000ULL }, /* 1e39 */
+    { 0xEB194F8E1AE525FDULL, 0x5DCFAB0800000000ULL }, /* 1e40 */
+    { 0x92EFD1B8D0CF37BEULL, 0x5AA1CAE500000000ULL }, /* 1e41 */
+    { 0xB7ABC627050305ADULL, 0xF14A3D9E40000000ULL }, /* 1e42 */
+    { 0xE596B7B0C643C719ULL, 0x6D9CCD05D0000000ULL }, /* 1e43 */
+    { 0x8F7E32CE7BEA5C6FULL, 0xE4820023A2000000ULL }, /* 1e44 */
+    { 0xB35DBF821AE4F38BULL, 0xDDA2802C8A800000ULL }, /* 1e45 */
+    { 0xE0352F62A19E306EULL, 0xD50B2037AD200000ULL }, /* 1e46 */
+    { 0x8C213D9DA502DE45ULL, 0x4526F422CC340000ULL }, /* 1e47 */
+    { 0xAF298D050E4395D6ULL, 0x9670B12B7F410000ULL }, /* 1e48 */
+    { 0xDAF3F04651D47B4CULL, 0x3C0CDD765F114000ULL }, /* 1e49 */
+    { 0x88D8762BF324CD0FULL, 0xA5880A69FB6AC800ULL }, /* 1e50 */
+    { 0xAB0E93B6EFEE0053ULL, 0x8EEA0D047A457A00ULL }, /* 1e51 */
+    { 0xD5D238A4ABE98068ULL, 0x72A4904598D6D880ULL }, /* 1e52 */
+    { 0x85A36366EB71F041ULL, 0x47A6DA2B7F864750ULL }, /* 1e53 */
+    { 0xA70C3C40A64E6C51ULL, 0x999090B65F67D924ULL }, /* 1e54 */
+    { 0xD0CF4B50CFE20765ULL, 0xFFF4B4E3F741CF6DULL }, /* 1e55 */
+    { 0x82818F1281ED449FULL, 0xBFF8F10E7A8921A4ULL }, /* 1e56 */
+    { 0xA321F2D7226895C7ULL, 0xAFF72D52192B6A0DULL }, /* 1e57 */
+    { 0xCBEA6F8CEB02BB39ULL, 0x9BF4F8A69F764490ULL }, /* 1e58 */
+    { 0xFEE50B7025C36A08ULL, 0x02F236D04753D5B4ULL }, /* 1e59 */
+    { 0x9F4F2726179A2245ULL, 0x01D762422C946590ULL }, /* 1e60 */
+    { 0xC722F0EF9D80AAD6ULL, 0x424D3AD2B7B97EF5ULL }, /* 1e61 */
+    { 0xF8EBAD2B84E0D58BULL, 0xD2E0898765A7DEB2ULL }, /* 1e62 */
+    { 0x9B934C3B330C8577ULL, 0x63CC55F49F88EB2FULL }, /* 1e63 */
+    { 0xC2781F49FFCFA6D5ULL, 0x3CBF6B71C76B25FBULL }, /* 1e64 */
+    { 0xF316271C7FC3908AULL, 0x8BEF464E3945EF7AULL }, /* 1e65 */
+    { 0x97EDD871CFDA3A56ULL, 0x97758BF0E3CBB5ACULL }, /* 1e66 */
+    { 0xBDE94E8E43D0C8ECULL, 0x3D52EEED1CBEA317ULL }, /* 1e67 */
+    { 0xED63A231D4C4FB27ULL, 0x4CA7AAA863EE4BDDULL }, /* 1e68 */
+    { 0x945E455F24FB1CF8ULL, 0x8FE8CAA93E74EF6AULL }, /* 1e69 */
+    { 0xB975D6B6EE39E436ULL, 0xB3E2FD538E122B44ULL }, /* 1e70 */
+    { 0xE7D34C64A9C85D44ULL, 0x60DBBCA87196B616ULL }, /* 1e71 */
+    { 0x90E40FBEEA1D3A4AULL, 0xBC8955E946FE31CDULL }, /* 1e72 */
+    { 0xB51D13AEA4A488DDULL, 0x6BABAB6398BDBE41ULL }, /* 1e73 */
+    { 0xE264589A4DCDAB14ULL, 0xC696963C7EED2DD1ULL }, /* 1e74 */
+    { 0x8D7EB76070A08AECULL, 0xFC1E1DE5CF543CA2ULL }, /* 1e75 */
+    { 0xB0DE65388CC8ADA8ULL, 0x3B25A55F43294BCBULL }, /* 1e76 */
+    { 0xDD15FE86AFFAD912ULL, 0x49EF0EB713F39EBEULL }, /* 1e77 */
+    { 0x8A2DBF142DFCC7ABULL, 0x6E3569326C784337ULL }, /* 1e78 */
+    { 0xACB92ED9397BF996ULL, 0x49C2C37F07965404ULL }, /* 1e79 */
+    { 0xD7E77A8F87DAF7FBULL, 0xDC33745EC97BE906ULL }, /* 1e80 */
+    { 0x86F0AC99B4E8DAFDULL, 0x69A028BB3DED71A3ULL }, /* 1e81 */
+    { 0xA8ACD7C0222311BCULL, 0xC40832EA0D68CE0CULL }, /* 1e82 */
+    { 0xD2D80DB02AABD62BULL, 0xF50A3FA490C30190ULL }, /* 1e83 */
+    { 0x83C7088E1AAB65DBULL, 0x792667C6DA79E0FAULL }, /* 1e84 */
+    { 0xA4B8CAB1A1563F52ULL, 0x577001B891185938ULL }, /* 1e85 */
+    { 0xCDE6FD5E09ABCF26ULL, 0xED4C0226B55E6F86ULL }, /* 1e86 */
+    { 0x80B05E5AC60B6178ULL, 0x544F8158315B05B4ULL }, /* 1e87 */
+    { 0xA0DC75F1778E39D6ULL, 0x696361AE3DB1C721ULL }, /* 1e88 */
+    { 0xC913936DD571C84CULL, 0x03BC3A19CD1E38E9ULL }, /* 1e89 */
+    { 0xFB5878494ACE3A5FULL, 0x04AB48A04065C723ULL }, /* 1e90 */
+    { 0x9D174B2DCEC0E47BULL, 0x62EB0D64283F9C76ULL }, /* 1e91 */
+    { 0xC45D1DF942711D9AULL, 0x3BA5D0BD324F8394ULL }, /* 1e92 */
+    { 0xF5746577930D6500ULL, 0xCA8F44EC7EE36479ULL }, /* 1e93 */
+    { 0x9968BF6ABBE85F20ULL, 0x7E998B13CF4E1ECBULL }, /* 1e94 */
+    { 0xBFC2EF456AE276E8ULL, 0x9E3FEDD8C321A67EULL }, /* 1e95 */
+    { 0xEFB3AB16C59B14A2ULL, 0xC5CFE94EF3EA101EULL }, /* 1e96 */
+    { 0x95D04AEE3B80ECE5ULL, 0xBBA1F1D158724A12ULL }, /* 1e97 */
+    { 0xBB445DA9CA61281FULL, 0x2A8A6E45AE8EDC97ULL }, /* 1e98 */
+    { 0xEA1575143CF97226ULL, 0xF52D09D71A3293BDULL }, /* 1e99 */
+    { 0x924D692CA61BE758ULL, 0x593C2626705F9C56ULL }, /* 1e100 */
+    { 0xB6E0C377CFA2E12EULL, 0x6F8B2FB00C77836CULL }, /* 1e101 */
+    { 0xE498F455C38B997AULL, 0x0B6DFB9C0F956447ULL }, /* 1e102 */
+    { 0x8EDF98B59A373FECULL, 0x4724BD4189BD5EACULL }, /* 1e103 */
+    { 0xB2977EE300C50FE7ULL, 0x58EDEC91EC2CB657ULL }, /* 1e104 */
+    { 0xDF3D5E9BC0F653E1ULL, 0x2F2967B66737E3EDULL }, /* 1e105 */
+    { 0x8B865B215899F46CULL, 0xBD79E0D20082EE74ULL }, /* 1e106 */
+    { 0xAE67F1E9AEC07187ULL, 0xECD8590680A3AA11ULL }, /* 1e107 */
+    { 0xDA01EE641A708DE9ULL, 0xE80E6F4820CC9495ULL }, /* 1e108 */
+    { 0x884134FE908658B2ULL, 0x3109058D147FDCDDULL }, /* 1e109 */
+    { 0xAA51823E34A7EEDEULL, 0xBD4B46F0599FD415ULL }, /* 1e110 */
+    { 0xD4E5E2CDC1D1EA96ULL, 0x6C9E18AC7007C91AULL }, /* 1e111 */
+    { 0x850FADC09923329EULL, 0x03E2CF6BC604DDB0ULL }, /* 1e112 */
+    { 0xA6539930BF6BFF45ULL, 0x84DB8346B786151CULL }, /* 1e113 */
+    { 0xCFE87F7CEF46FF16ULL, 0xE612641865679A63ULL }, /* 1e114 */
+    { 0x81F14FAE158C5F6EULL, 0x4FCB7E8F3F60C07EULL }, /* 1e115 */
+    { 0xA26DA3999AEF7749ULL, 0xE3BE5E330F38F09DULL }, /* 1e116 */
+    { 0xCB090C8001AB551CULL, 0x5CADF5BFD3072CC5ULL }, /* 1e117 */
+    { 0xFDCB4FA002162A63ULL, 0x73D9732FC7C8F7F6ULL }, /* 1e118 */
+    { 0x9E9F11C4014DDA7EULL, 0x2867E7FDDCDD9AFAULL }, /* 1e119 */
+    { 0xC646D63501A1511DULL, 0xB281E1FD541501B8ULL }, /* 1e120 */
+    { 0xF7D88BC24209A565ULL, 0x1F225A7CA91A4226ULL }, /* 1e121 */
+    { 0x9AE757596946075FULL, 0x3375788DE9B06958ULL }, /* 1e122 */
+    { 0xC1A12D2FC3978937ULL, 0x0052D6B1641C83AEULL }, /* 1e123 */
+    { 0xF209787BB47D6B84ULL, 0xC0678C5DBD23A49AULL }, /* 1e124 */
+    { 0x9745EB4D50CE6332ULL, 0xF840B7BA963646E0ULL }, /* 1e125 */
+    { 0xBD176620A501FBFFULL, 0xB650E5A93BC3D898ULL }, /* 1e126 */
+    { 0xEC5D3FA8CE427AFFULL, 0xA3E51F138AB4CEBEULL }, /* 1e127 */
+    { 0x93BA47C980E98CDFULL, 0xC66F336C36B10137ULL }, /* 1e128 */
+    { 0xB8A8D9BBE123F017ULL, 0xB80B0047445D4184ULL }, /* 1e129 */
+    { 0xE6D3102AD96CEC1DULL, 0xA60DC059157491E5ULL }, /* 1e130 */
+    { 0x9043EA1AC7E41392ULL, 0x87C89837AD68DB2FULL }, /* 1e131 */
+    { 0xB454E4A179DD1877ULL, 0x29BABE4598C311FBULL }, /* 1e132 */
+    { 0xE16A1DC9D8545E94ULL, 0xF4296DD6FEF3D67AULL }, /* 1e133 */
+    { 0x8CE2529E2734BB1DULL, 0x1899E4A65F58660CULL }, /* 1e134 */
+    { 0xB01AE745B101E9E4ULL, 0x5EC05DCFF72E7F8FULL }, /* 1e135 */
+    { 0xDC21A1171D42645DULL, 0x76707543F4FA1F73ULL }, /* 1e136 */
+    { 0x899504AE72497EBAULL, 0x6A06494A791C53A8ULL }, /* 1e137 */
+    { 0xABFA45DA0EDBDE69ULL, 0x0487DB9D17636892ULL }, /* 1e138 */
+    { 0xD6F8D7509292D603ULL, 0x45A9D2845D3C42B6ULL }, /* 1e139 */
+    { 0x865B86925B9BC5C2ULL, 0x0B8A2392BA45A9B2ULL }, /* 1e140 */
+    { 0xA7F26836F282B732ULL, 0x8E6CAC7768D7141EULL }, /* 1e141 */
+    { 0xD1EF0244AF2364FFULL, 0x3207D795430CD926ULL }, /* 1e142 */
+    { 0x8335616AED761F1FULL, 0x7F44E6BD49E807B8ULL }, /* 1e143 */
+    { 0xA402B9C5A8D3A6E7ULL, 0x5F16206C9C6209A6ULL }, /* 1e144 */
+    { 0xCD036837130890A1ULL, 0x36DBA887C37A8C0FULL }, /* 1e145 */
+    { 0x802221226BE55A64ULL, 0xC2494954DA2C9789ULL }, /* 1e146 */
+    { 0xA02AA96B06DEB0FDULL, 0xF2DB9BAA10B7BD6CULL }, /* 1e147 */
+    { 0xC83553C5C8965D3DULL, 0x6F92829494E5ACC7ULL }, /* 1e148 */
+    { 0xFA42A8B73ABBF48CULL, 0xCB772339BA1F17F9ULL }, /* 1e149 */
+    { 0x9C69A97284B578D7ULL, 0xFF2A760414536EFBULL }, /* 1e150 */
+    { 0xC38413CF25E2D70DULL, 0xFEF5138519684ABAULL }, /* 1e151 */
+    { 0xF46518C2EF5B8CD1ULL, 0x7EB258665FC25D69ULL }, /* 1e152 */
+    { 0x98BF2F79D5993802ULL, 0xEF2F773FFBD97A61ULL }, /* 1e153 */
+    { 0xBEEEFB584AFF8603ULL, 0xAAFB550FFACFD8FAULL }, /* 1e154 */
+    { 0xEEAABA2E5DBF6784ULL, 0x95BA2A53F983CF38ULL }, /* 1e155 */
+    { 0x952AB45CFA97A0B2ULL, 0xDD945A747BF26183ULL }, /* 1e156 */
+    { 0xBA756174393D88DFULL, 0x94F971119AEEF9E4ULL }, /* 1e157 */
+    { 0xE912B9D1478CEB17ULL, 0x7A37CD5601AAB85DULL }, /* 1e158 */
+    { 0x91ABB422CCB812EEULL, 0xAC62E055C10AB33AULL }, /* 1e159 */
+    { 0xB616A12B7FE617AAULL, 0x577B986B314D6009ULL }, /* 1e160 */
+    { 0xE39C49765FDF9D94ULL, 0xED5A7E85FDA0B80BULL }, /* 1e161 */
+    { 0x8E41ADE9FBEBC27DULL, 0x14588F13BE847307ULL }, /* 1e162 */
+    { 0xB1D219647AE6B31CULL, 0x596EB2D8AE258FC8ULL }, /* 1e163 */
+    { 0xDE469FBD99A05FE3ULL, 0x6FCA5F8ED9AEF3BBULL }, /* 1e164 */
+    { 0x8AEC23D680043BEEULL, 0x25DE7BB9480D5854ULL }, /* 1e165 */
+    { 0xADA72CCC20054AE9ULL, 0xAF561AA79A10AE6AULL }, /* 1e166 */
+    { 0xD910F7FF28069DA4ULL, 0x1B2BA1518094DA04ULL }, /* 1e167 */
+    { 0x87AA9AFF79042286ULL, 0x90FB44D2F05D0842ULL }, /* 1e168 */
+    { 0xA99541BF57452B28ULL, 0x353A1607AC744A53ULL }, /* 1e169 */
+    { 0xD3FA922F2D1675F2ULL, 0x42889B8997915CE8ULL }, /* 1e170 */
+    { 0x847C9B5D7C2E09B7ULL, 0x69956135FEBADA11ULL }, /* 1e171 */
+    { 0xA59BC234DB398C25ULL, 0x43FAB9837E699095ULL }, /* 1e172 */
+    { 0xCF02B2C21207EF2EULL, 0x94F967E45E03F4BBULL }, /* 1e173 */
+    { 0x8161AFB94B44F57DULL, 0x1D1BE0EEBAC278F5ULL }, /* 1e174 */
+    { 0xA1BA1BA79E1632DCULL, 0x6462D92A69731732ULL }, /* 1e175 */
+    { 0xCA28A291859BBF93ULL, 0x7D7B8F7503CFDCFEULL }, /* 1e176 */
+    { 0xFCB2CB35E702AF78ULL, 0x5CDA735244C3D43EULL }, /* 1e177 */
+    { 0x9DEFBF01B061ADABULL, 0x3A0888136AFA64A7ULL }, /* 1e178 */
+    { 0xC56BAEC21C7A1916ULL, 0x088AAA1845B8FDD0ULL }, /* 1e179 */
+    { 0xF6C69A72A3989F5BULL, 0x8AAD549E57273D45ULL }, /* 1e180 */
+    { 0x9A3C2087A63F6399ULL, 0x36AC54E2F678864BULL }, /* 1e181 */
+    { 0xC0CB28A98FCF3C7FULL, 0x84576A1BB416A7DDULL }, /* 1e182 */
+    { 0xF0FDF2D3F3C30B9FULL, 0x656D44A2A11C51D5ULL }, /* 1e183 */
+    { 0x969EB7C47859E743ULL, 0x9F644AE5A4B1B325ULL }, /* 1e184 */
+    { 0xBC4665B596706114ULL, 0x873D5D9F0DDE1FEEULL }, /* 1e185 */
+    { 0xEB57FF22FC0C7959ULL, 0xA90CB506D155A7EAULL }, /* 1e186 */
+    { 0x9316FF75DD87CBD8ULL, 0x09A7F12442D588F2ULL }, /* 1e187 */
+    { 0xB7DCBF5354E9BECEULL, 0x0C11ED6D538AEB2FULL }, /* 1e188 */
+    { 0xE5D3EF282A242E81ULL, 0x8F1668C8A86DA5FAULL }, /* 1e189 */
+    { 0x8FA475791A569D10ULL, 0xF96E017D694487BCULL }, /* 1e190 */
+    { 0xB38D92D760EC4455ULL, 0x37C981DCC395A9ACULL }, /* 1e191 */
+    { 0xE070F78D3927556AULL, 0x85BBE253F47B1417ULL }, /* 1e192 */
+    { 0x8C469AB843B89562ULL, 0x93956D7478CCEC8EULL }, /* 1e193 */
+    { 0xAF58416654A6BABBULL, 0x387AC8D1970027B2ULL }, /* 1e194 */
+    { 0xDB2E51BFE9D0696AULL, 0x06997B05FCC0319EULL }, /* 1e195 */
+    { 0x88FCF317F22241E2ULL, 0x441FECE3BDF81F03ULL }, /* 1e196 */
+    { 0xAB3C2FDDEEAAD25AULL, 0xD527E81CAD7626C3ULL }, /* 1e197 */
+    { 0xD60B3BD56A5586F1ULL, 0x8A71E223D8D3B074ULL }, /* 1e198 */
+    { 0x85C7056562757456ULL, 0xF6872D5667844E49ULL }, /* 1e199 */
+    { 0xA738C6BEBB12D16CULL, 0xB428F8AC016561DBULL }, /* 1e200 */
+    { 0xD106F86E69D785C7ULL, 0xE13336D701BEBA52ULL }, /* 1e201 */
+    { 0x82A45B450226B39CULL, 0xECC0024661173473ULL }, /* 1e202 */
+    { 0xA34D721642B06084ULL, 0x27F002D7F95D0190ULL }, /* 1e203 */
+    { 0xCC20CE9BD35C78A5ULL, 0x31EC038DF7B441F4ULL }, /* 1e204 */
+    { 0xFF290242C83396CEULL, 0x7E67047175A15271ULL }, /* 1e205 */
+    { 0x9F79A169BD203E41ULL, 0x0F0062C6E984D386ULL }, /* 1e206 */
+    { 0xC75809C42C684DD1ULL, 0x52C07B78A3E60868ULL }, /* 1e207 */
+    { 0xF92E0C3537826145ULL, 0xA7709A56CCDF8A82ULL }, /* 1e208 */
+    { 0x9BBCC7A142B17CCBULL, 0x88A66076400BB691ULL }, /* 1e209 */
+    { 0xC2ABF989935DDBFEULL, 0x6ACFF893D00EA435ULL }, /* 1e210 */
+    { 0xF356F7EBF83552FEULL, 0x0583F6B8C4124D43ULL }, /* 1e211 */
+    { 0x98165AF37B2153DEULL, 0xC3727A337A8B704AULL }, /* 1e212 */
+    { 0xBE1BF1B059E9A8D6ULL, 0x744F18C0592E4C5CULL }, /* 1e213 */
+    { 0xEDA2EE1C7064130CULL, 0x1162DEF06F79DF73ULL }, /* 1e214 */
+    { 0x9485D4D1C63E8BE7ULL, 0x8ADDCB5645AC2BA8ULL }, /* 1e215 */
+    { 0xB9A74A0637CE2EE1ULL, 0x6D953E2BD7173692ULL }, /* 1e216 */
+    { 0xE8111C87C5C1BA99ULL, 0xC8FA8DB6CCDD0437ULL }, /* 1e217 */
+    { 0x910AB1D4DB9914A0ULL, 0x1D9C9892400A22A2ULL }, /* 1e218 */
+    { 0xB54D5E4A127F59C8ULL, 0x2503BEB6D00CAB4BULL }, /* 1e219 */
+    { 0xE2A0B5DC971F303AULL, 0x2E44AE64840FD61DULL }, /* 1e220 */
+    { 0x8DA471A9DE737E24ULL, 0x5CEAECFED289E5D2ULL }, /* 1e221 */
+    { 0xB10D8E1456105DADULL, 0x7425A83E872C5F47ULL }, /* 1e222 */
+    { 0xDD50F1996B947518ULL, 0xD12F124E28F77719ULL }, /* 1e223 */
+    { 0x8A5296FFE33CC92FULL, 0x82BD6B70D99AAA6FULL }, /* 1e224 */
+    { 0xACE73CBFDC0BFB7BULL, 0x636CC64D1001550BULL }, /* 1e225 */
+    { 0xD8210BEFD30EFA5AULL, 0x3C47F7E05401AA4EULL }, /* 1e226 */
+    { 0x8714A775E3E95C78ULL, 0x65ACFAEC34810A71ULL }, /* 1e227 */
+    { 0xA8D9D1535CE3B396ULL, 0x7F1839A741A14D0DULL }, /* 1e228 */
+    { 0xD31045A8341CA07CULL, 0x1EDE48111209A050ULL }, /* 1e229 */
+    { 0x83EA2B892091E44DULL, 0x934AED0AAB460432ULL }, /* 1e230 */
+    { 0xA4E4B66B68B65D60ULL, 0xF81DA84D5617853FULL }, /* 1e231 */
+    { 0xCE1DE40642E3F4B9ULL, 0x36251260AB9D668EULL }, /* 1e232 */
+    { 0x80D2AE83E9CE78F3ULL, 0xC1D72B7C6B426019ULL }, /* 1e233 */
+    { 0xA1075A24E4421730ULL, 0xB24CF65B8612F81FULL }, /* 1e234 */
+    { 0xC94930AE1D529CFCULL, 0xDEE033F26797B627ULL }, /* 1e235 */
+    { 0xFB9B7CD9A4A7443CULL, 0x169840EF017DA3B1ULL }, /* 1e236 */
+    { 0x9D412E0806E88AA5ULL, 0x8E1F289560EE864EULL }, /* 1e237 */
+    { 0xC491798A08A2AD4EULL, 0xF1A6F2BAB92A27E2ULL }, /* 1e238 */
+    { 0xF5B5D7EC8ACB58A2ULL, 0xAE10AF696774B1DBULL }, /* 1e239 */
+    { 0x9991A6F3D6BF1765ULL, 0xACCA6DA1E0A8EF29ULL }, /* 1e240 */
+    { 0xBFF610B0CC6EDD3FULL, 0x17FD090A58D32AF3ULL }, /* 1e241 */
+    { 0xEFF394DCFF8A948EULL, 0xDDFC4B4CEF07F5B0ULL }, /* 1e242 */
+    { 0x95F83D0A1FB69CD9ULL, 0x4ABDAF101564F98EULL }, /* 1e243 */
+    { 0xBB764C4CA7A4440FULL, 0x9D6D1AD41ABE37F1ULL }, /* 1e244 */
+    { 0xEA53DF5FD18D5513ULL, 0x84C86189216DC5EDULL }, /* 1e245 */
+    { 0x92746B9BE2F8552CULL, 0x32FD3CF5B4E49BB4ULL }, /* 1e246 */
+    { 0xB7118682DBB66A77ULL, 0x3FBC8C33221DC2A1ULL }, /* 1e247 */
+    { 0xE4D5E82392A40515ULL, 0x0FABAF3FEAA5334AULL }, /* 1e248 */
+    { 0x8F05B1163BA6832DULL, 0x29CB4D87F2A7400EULL }, /* 1e249 */
+    { 0xB2C71D5BCA9023F8ULL, 0x743E20E9EF511012ULL }, /* 1e250 */
+    { 0xDF78E4B2BD342CF6ULL, 0x914DA9246B255416ULL }, /* 1e251 */
+    { 0x8BAB8EEFB6409C1AULL, 0x1AD089B6C2F7548EULL }, /* 1e252 */
+    { 0xAE9672ABA3D0C320ULL, 0xA184AC2473B529B1ULL }, /* 1e253 */
+    { 0xDA3C0F568CC4F3E8ULL, 0xC9E5D72D90A2741EULL }, /* 1e254 */
+    { 0x8865899617FB1871ULL, 0x7E2FA67C7A658892ULL }, /* 1e255 */
+    { 0xAA7EEBFB9DF9DE8DULL, 0xDDBB901B98FEEAB7ULL }, /* 1e256 */
+    { 0xD51EA6FA85785631ULL, 0x552A74227F3EA565ULL }, /* 1e257 */
+    { 0x8533285C936B35DEULL, 0xD53A88958F87275FULL }, /* 1e258 */
+    { 0xA67FF273B8460356ULL, 0x8A892ABAF368F137ULL }, /* 1e259 */
+    { 0xD01FEF10A657842CULL, 0x2D2B7569B0432D85ULL }, /* 1e260 */
+    { 0x8213F56A67F6B29BULL, 0x9C3B29620E29FC73ULL }, /* 1e261 */
+    { 0xA298F2C501F45F42ULL, 0x8349F3BA91B47B8FULL }, /* 1e262 */
+    { 0xCB3F2F7642717713ULL, 0x241C70A936219A73ULL }, /* 1e263 */
+    { 0xFE0EFB53D30DD4D7ULL, 0xED238CD383AA0110ULL }, /* 1e264 */
+    { 0x9EC95D1463E8A506ULL, 0xF4363804324A40AAULL }, /* 1e265 */
+    { 0xC67BB4597CE2CE48ULL, 0xB143C6053EDCD0D5ULL }, /* 1e266 */
+    { 0xF81AA16FDC1B81DAULL, 0xDD94B7868E94050AULL }, /* 1e267 */
+    { 0x9B10A4E5E9913128ULL, 0xCA7CF2B4191C8326ULL }, /* 1e268 */
+    { 0xC1D4CE1F63F57D72ULL, 0xFD1C2F611F63A3F0ULL }, /* 1e269 */
+    { 0xF24A01A73CF2DCCFULL, 0xBC633B39673C8CECULL }, /* 1e270 */
+    { 0x976E41088617CA01ULL, 0xD5BE0503E085D813ULL }, /* 1e271 */
+    { 0xBD49D14AA79DBC82ULL, 0x4B2D8644D8A74E18ULL }, /* 1e272 */
+    { 0xEC9C459D51852BA2ULL, 0xDDF8E7D60ED1219EULL }, /* 1e273 */
+    { 0x93E1AB8252F33B45ULL, 0xCABB90E5C942B503ULL }, /* 1e274 */
+    { 0xB8DA1662E7B00A17ULL, 0x3D6A751F3B936243ULL }, /* 1e275 */
+    { 0xE7109BFBA19C0C9DULL, 0x0CC512670A783AD4ULL }, /* 1e276 */
+    { 0x906A617D450187E2ULL, 0x27FB2B80668B24C5ULL }, /* 1e277 */
+    { 0xB484F9DC9641E9DAULL, 0xB1F9F660802DEDF6ULL }, /* 1e278 */
+    { 0xE1A63853BBD26451ULL, 0x5E7873F8A0396973ULL }, /* 1e279 */
+    { 0x8D07E33455637EB2ULL, 0xDB0B487B6423E1E8ULL }, /* 1e280 */
+    { 0xB049DC016ABC5E5FULL, 0x91CE1A9A3D2CDA62ULL }, /* 1e281 */
+    { 0xDC5C5301C56B75F7ULL, 0x7641A140CC7810FBULL }, /* 1e282 */
+    { 0x89B9B3E11B6329BAULL, 0xA9E904C87FCB0A9DULL }, /* 1e283 */
+    { 0xAC2820D9623BF429ULL, 0x546345FA9FBDCD44ULL }, /* 1e284 */
+    { 0xD732290FBACAF133ULL, 0xA97C177947AD4095ULL }, /* 1e285 */
+    { 0x867F59A9D4BED6C0ULL, 0x49ED8EABCCCC485DULL }, /* 1e286 */
+    { 0xA81F301449EE8C70ULL, 0x5C68F256BFFF5A74ULL }, /* 1e287 */
+    { 0xD226FC195C6A2F8CULL, 0x73832EEC6FFF3111ULL }, /* 1e288 */
+    { 0x83585D8FD9C25DB7ULL, 0xC831FD53C5FF7EABULL }, /* 1e289 */
+    { 0xA42E74F3D032F525ULL, 0xBA3E7CA8B77F5E55ULL }, /* 1e290 */
+    { 0xCD3A1230C43FB26FULL, 0x28CE1BD2E55F35EBULL }, /* 1e291 */
+    { 0x80444B5E7AA7CF85ULL, 0x7980D163CF5B81B3ULL }, /* 1e292 */
+    { 0xA0555E361951C366ULL, 0xD7E105BCC332621FULL }, /* 1e293 */
+    { 0xC86AB5C39FA63440ULL, 0x8DD9472BF3FEFAA7ULL }, /* 1e294 */
+    { 0xFA856334878FC150ULL, 0xB14F98F6F0FEB951ULL }, /* 1e295 */
+    { 0x9C935E00D4B9D8D2ULL, 0x6ED1BF9A569F33D3ULL }, /* 1e296 */
+    { 0xC3B8358109E84F07ULL, 0x0A862F80EC4700C8ULL }, /* 1e297 */
+    { 0xF4A642E14C6262C8ULL, 0xCD27BB612758C0FAULL }, /* 1e298 */
+    { 0x98E7E9CCCFBD7DBDULL, 0x8038D51CB897789CULL }, /* 1e299 */
+    { 0xBF21E44003ACDD2CULL, 0xE0470A63E6BD56C3ULL }, /* 1e300 */
+    { 0xEEEA5D5004981478ULL, 0x1858CCFCE06CAC74ULL }, /* 1e301 */
+    { 0x95527A5202DF0CCBULL, 0x0F37801E0C43EBC8ULL }, /* 1e302 */
+    { 0xBAA718E68396CFFDULL, 0xD30560258F54E6BAULL }, /* 1e303 */
+    { 0xE950DF20247C83FDULL, 0x47C6B82EF32A2069ULL }, /* 1e304 */
+    { 0x91D28B7416CDD27EULL, 0x4CDC331D57FA5441ULL }, /* 1e305 */
+    { 0xB6472E511C81471DULL, 0xE0133FE4ADF8E952ULL }, /* 1e306 */
+    { 0xE3D8F9E563A198E5ULL, 0x58180FDDD97723A6ULL }, /* 1e307 */
+    { 0x8E679C2F5E44FF8FULL, 0x570F09EAA7EA7648ULL }, /* 1e308 */
+    { 0xB201833B35D63F73ULL, 0x2CD2CC6551E513DAULL }, /* 1e309 */
+    { 0xDE81E40A034BCF4FULL, 0xF8077F7EA65E58D1ULL }, /* 1e310 */
+    { 0x8B112E86420F6191ULL, 0xFB04AFAF27FAF782ULL }, /* 1e311 */
+    { 0xADD57A27D29339F6ULL, 0x79C5DB9AF1F9B563ULL }, /* 1e312 */
+    { 0xD94AD8B1C7380874ULL, 0x18375281AE7822BCULL }, /* 1e313 */
+    { 0x87CEC76F1C830548ULL, 0x8F2293910D0B15B5ULL }, /* 1e314 */
+    { 0xA9C2794AE3A3C69AULL, 0xB2EB3875504DDB22ULL }, /* 1e315 */
+    { 0xD433179D9C8CB841ULL, 0x5FA60692A46151EBULL }, /* 1e316 */
+    { 0x849FEEC281D7F328ULL, 0xDBC7C41BA6BCD333ULL }, /* 1e317 */
+    { 0xA5C7EA73224DEFF3ULL, 0x12B9B522906C0800ULL }, /* 1e318 */
+    { 0xCF39E50FEAE16BEFULL, 0xD768226B34870A00ULL }, /* 1e319 */
+    { 0x81842F29F2CCE375ULL, 0xE6A1158300D46640ULL }, /* 1e320 */
+    { 0xA1E53AF46F801C53ULL, 0x60495AE3C1097FD0ULL }, /* 1e321 */
+    { 0xCA5E89B18B602368ULL, 0x385BB19CB14BDFC4ULL }, /* 1e322 */
+    { 0xFCF62C1DEE382C42ULL, 0x46729E03DD9ED7B5ULL }, /* 1e323 */
+    { 0x9E19DB92B4E31BA9ULL, 0x6C07A2C26A8346D1ULL }, /* 1e324 */
+    { 0xC5A05277621BE293ULL, 0xC7098B7305241885ULL }, /* 1e325 */
+    { 0xF70867153AA2DB38ULL, 0xB8CBEE4FC66D1EA7ULL }, /* 1e326 */
+    { 0x9A65406D44A5C903ULL, 0x737F74F1DC043328ULL }, /* 1e327 */
+    { 0xC0FE908895CF3B44ULL, 0x505F522E53053FF2ULL }, /* 1e328 */
+    { 0xF13E34AABB430A15ULL, 0x647726B9E7C68FEFULL }, /* 1e329 */
+    { 0x96C6E0EAB509E64DULL, 0x5ECA783430DC19F5ULL }, /* 1e330 */
+    { 0xBC789925624C5FE0ULL, 0xB67D16413D132072ULL }, /* 1e331 */
+    { 0xEB96BF6EBADF77D8ULL, 0xE41C5BD18C57E88FULL }, /* 1e332 */
+    { 0x933E37A534CBAAE7ULL, 0x8E91B962F7B6F159ULL }, /* 1e333 */
+    { 0xB80DC58E81FE95A1ULL, 0x723627BBB5A4ADB0ULL }, /* 1e334 */
+    { 0xE61136F2227E3B09ULL, 0xCEC3B1AAA30DD91CULL }, /* 1e335 */
+    { 0x8FCAC257558EE4E6ULL, 0x213A4F0AA5E8A7B1ULL }, /* 1e336 */
+    { 0xB3BD72ED2AF29E1FULL, 0xA988E2CD4F62D19DULL }, /* 1e337 */
+    { 0xE0ACCFA875AF45A7ULL, 0x93EB1B80A33B8605ULL }, /* 1e338 */
+    { 0x8C6C01C9498D8B88ULL, 0xBC72F130660533C3ULL }, /* 1e339 */
+    { 0xAF87023B9BF0EE6AULL, 0xEB8FAD7C7F8680B4ULL }, /* 1e340 */
+    { 0xDB68C2CA82ED2A05ULL, 0xA67398DB9F6820E1ULL }, /* 1e341 */
+    { 0x892179BE91D43A43ULL, 0x88083F8943A1148CULL }, /* 1e342 */
+    { 0xAB69D82E364948D4ULL, 0x6A0A4F6B948959B0ULL }, /* 1e343 */
+    { 0xD6444E39C3DB9B09ULL, 0x848CE34679ABB01CULL }, /* 1e344 */
+    { 0x85EAB0E41A6940E5ULL, 0xF2D80E0C0C0B4E11ULL }, /* 1e345 */
+    { 0xA7655D1D2103911FULL, 0x6F8E118F0F0E2195ULL }, /* 1e346 */
+    { 0xD13EB46469447567ULL, 0x4B7195F2D2D1A9FBULL }, /* 1e347 */
+};
+
+/* powers of ten which are exact doubles */
+static const double ljson_exact_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool ljson_is_digit(char ch) {
+    return (unsigned char)(ch - '0') < 10;
+}
+
+inline unsigned ljson_clz64(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - (unsigned)index;
+#else
+    return (unsigned)__builtin_clzll(x);
+#endif
+}
+
+/* the 128-bit product of a and b */
+inline void ljson_mul128(uint64_t a, uint64_t b, uint64_t* hi, uint64_t* lo) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128)a * b;
+    *hi = (uint64_t)(r >> 64);
+    *lo = (uint64_t)r;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *lo = _umul128(a, b, hi);
+#else
+    uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32, b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    *lo = (mid << 32) | (ll & 0xFFFFFFFF);
+#endif
+}
+
+/* load the next 8 bytes of the input, if there are 8 left before end */
+inline bool ljson_load8(const char* p, const char* end, uint64_t* val) {
+#ifdef LJSON_LITTLE_ENDIAN
+    if (end - p < 8)
+        return false;
+    memcpy(val, p, 8);
+    return true;
+#else
+    (void)p; (void)end; (void)val;
+    return false;
+#endif
+}
+
+/* SWAR: whether the 8 bytes are all digits */
+inline bool ljson_is_8digits(uint64_t val) {
+    return !(((val + 0x4646464646464646ULL) | (val - 0x3030303030303030ULL)) & 0x8080808080808080ULL);
+}
+
+/* SWAR: the value of 8 digits loaded in little endian */
+inline uint32_t ljson_parse_8digits(uint64_t val) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL;    /* 100 + (1000000 << 32) */
+    const uint64_t mul2 = 0x0000271000000001ULL;    /* 1 + (10000 << 32) */
+    val -= 0x3030303030303030ULL;
+    val = (val * 10) + (val >> 8);
+    val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)val;
+}
+
+inline double ljson_double_from_bits(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+/*
+ * Eisel-Lemire: the double nearest to man * 10^exp10,
+ * return false if the 128-bit approximation can not decide the rounding
+ */
+static bool ljson_eisel_lemire(uint64_t man, int64_t exp10, bool neg, double* d) {
+    if (man == 0) {
+        *d = neg ? -0.0 : 0.0;
+        return true;
+    }
+    if (exp10 < -348 || exp10 > 347)
+        return false;
+    unsigned clz = ljson_clz64(man);
+    man <<= clz;
+    /* (217706 * exp10) >> 16 is floor(exp10 * log2(10)) */
+    uint64_t ret_exp2 = uint64_t(((217706 * exp10) >> 16) + 64 + 1023) - clz;
+
+    const uint64_t* pow = ljson_pow10_table[exp10 + 348];
+    uint64_t x_hi, x_lo;
+    ljson_mul128(man, pow[0], &x_hi, &x_lo);
+    if ((x_hi & 0x1FF) == 0x1FF && x_lo + man < man) {
+        /* the low bits are all ones, use the low half of the power to get a wider approximation */
+        uint64_t y_hi, y_lo;
+        ljson_mul128(man, pow[1], &y_hi, &y_lo);
+        uint64_t merged_hi = x_hi, merged_lo = x_lo + y_hi;
+        if (merged_lo < x_lo)
+            merged_hi++;
+        if ((merged_hi & 0x1FF) == 0x1FF && merged_lo + 1 == 0 && y_lo + man < man)
+            return false;
+        x_hi = merged_hi;
+        x_lo = merged_lo;
+    }
+
+    uint64_t msb = x_hi >> 63;
+    uint64_t ret_man = x_hi >> (msb + 9);
+    ret_exp2 -= 1 ^ msb;
+    /* exactly half way between two doubles */
+    if (x_lo == 0 && (x_hi & 0x1FF) == 0 && (ret_man & 3) == 1)
+        return false;
+
+    ret_man += ret_man & 1;
+    ret_man >>= 1;
+    if (ret_man >> 53 > 0) {
+        ret_man >>= 1;
+        ret_exp2 += 1;
+    }
+    /* subnormal, infinity or NaN */
+    if (ret_exp2 - 1 >= 0x7FF - 1)
+        return false;
+    uint64_t bits = ret_exp2 << 52 | (ret_man & 0x000FFFFFFFFFFFFFULL);
+    if (neg)
+        bits |= 0x8000000000000000ULL;
+    *d = ljson_double_from_bits(bits);
+    return true;
+}
+
+/* an arbitrary precision decimal 0.d[0]d[1]...d[num_digits - 1] * 10^decimal_point, the slow path */
+typedef struct {
+    int num_digits;
+    int decimal_point;
+    bool truncated;         /*!< some non zero digits are dropped */
+    uint8_t digits[800 + 24];
+} ljson_decimal;
+
+static const int ljson_decimal_max_digits = 800;
+static const unsigned ljson_decimal_max_shift = 60;
+
+static void ljson_decimal_trim(ljson_decimal* d) {
+    while (d->num_digits > 0 && d->digits[d->num_digits - 1] == 0)
+        d->num_digits--;
+    if (d->num_digits == 0)
+        d->decimal_point = 0;
+}
+
+/* [p, end) is the number without its sign, the grammar is already checked */
+static void ljson_decimal_parse(ljson_decimal* d, const char* p, const char* end) {
+    d->num_digits = 0;
+    d->decimal_point = 0;
+    d->truncated = false;
+    for (; p < end && ljson_is_digit(*p); p++) {
+        if (d->num_digits == 0 && *p == '0')
+            continue;
+        if (d->num_digits < ljson_decimal_max_digits)
+            d->digits[d->num_digits++] = *p - '0';
+        else if (*p != '0')
+            d->truncated = true;
+        d->decimal_point++;
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && ljson_is_digit(*p); p++) {
+            if (d->num_digits == 0 && *p == '0') {
+                d->decimal_point--;
+                continue;
+            }
+            if (d->num_digits < ljson_decimal_max_digits)
+                d->digits[d->num_digits++] = *p - '0';
+            else if (*p != '0')
+                d->truncated = true;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool neg = *p == '-';
+        if (*p == '+' || *p == '-')
+            p++;
+        int e = 0;
+        for (; p < end && ljson_is_digit(*p); p++)
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+        d->decimal_point += neg ? -e : e;
+    }
+    ljson_decimal_trim(d);
+}
+
+static void ljson_decimal_right_shift(ljson_decimal* d, unsigned k) {
+    int r = 0, w = 0;
+    uint64_t n = 0;
+    /* pick up enough leading digits to cover the first shift */
+    for (; (n >> k) == 0; r++) {
+        if (r >= d->num_digits) {
+            if (n == 0) {
+                d->num_digits = 0;
+                return;
+            }
+            for (; (n >> k) == 0; r++)
+                n *= 10;
+            break;
+        }
+        n = n * 10 + d->digits[r];
+    }
+    d->decimal_point -= r - 1;
+
+    const uint64_t mask = (uint64_t(1) << k) - 1;
+    for (; r < d->num_digits; r++) {
+        d->digits[w++] = (uint8_t)(n >> k);
+        n = (n & mask) * 10 + d->digits[r];
+    }
+    while (n > 0) {
+        uint8_t dig = (uint8_t)(n >> k);
+        n = (n & mask) * 10;
+        if (w < ljson_decimal_max_digits)
+            d->digits[w++] = dig;
+        else if (dig > 0)
+            d->truncated = true;
+    }
+    d->num_digits = w;
+    ljson_decimal_trim(d);
+}
+
+static void ljson_decimal_left_shift(ljson_decimal* d, unsigned k) {
+    /* multiplying by 2^k adds at most floor(k * log10(2)) + 1 digits */
+    int extra = (int)((k * 1233) >> 12) + 1;
+    int w = d->num_digits - 1 + extra;
+    uint64_t n = 0;
+    for (int r = d->num_digits - 1; r >= 0; r--, w--) {
+        n += uint64_t(d->digits[r]) << k;
+        uint64_t quo = n / 10;
+        d->digits[w] = (uint8_t)(n - quo * 10);
+        n = quo;
+    }
+    for (; n > 0; w--) {
+        uint64_t quo = n / 10;
+        d->digits[w] = (uint8_t)(n - quo * 10);
+        n = quo;
+    }
+    int first = w + 1;
+    int num_digits = d->num_digits + extra - first;
+    memmove(d->digits, d->digits + first, num_digits);
+    d->decimal_point += extra - first;
+    if (num_digits > ljson_decimal_max_digits) {
+        for (int i = ljson_decimal_max_digits; i < num_digits; i++)
+            if (d->digits[i] != 0)
+                d->truncated = true;
+        num_digits = ljson_decimal_max_digits;
+    }
+    d->num_digits = num_digits;
+    ljson_decimal_trim(d);
+}
+
+static void ljson_decimal_shift(ljson_decimal* d, int k) {
+    if (d->num_digits == 0)
+        return;
+    for (; k > (int)ljson_decimal_max_shift; k -= ljson_decimal_max_shift)
+        ljson_decimal_left_shift(d, ljson_decimal_max_shift);
+    for (; k < -(int)ljson_decimal_max_shift; k += ljson_decimal_max_shift)
+        ljson_decimal_right_shift(d, ljson_decimal_max_shift);
+    if (k > 0)
+        ljson_decimal_left_shift(d, k);
+    else if (k < 0)
+        ljson_decimal_right_shift(d, -k);
+}
+
+/* the integer part of d, rounded half to even */
+static uint64_t ljson_decimal_rounded_integer(const ljson_decimal* d) {
+    if (d->decimal_point > 20)
+        return UINT64_MAX;
+    uint64_t n = 0;
+    int i = 0;
+    for (; i < d->decimal_point && i < d->num_digits; i++)
+        n = n * 10 + d->digits[i];
+    for (; i < d->decimal_point; i++)
+        n *= 10;
+    int r = d->decimal_point;
+    if (r >= 0 && r < d->num_digits) {
+        bool round_up = d->digits[r] >= 5;
+        if (d->digits[r] == 5 && r + 1 == d->num_digits)
+            round_up = d->truncated || (r > 0 && (d->digits[r - 1] & 1));
+        if (round_up)
+            n++;
+    }
+    return n;
+}
+
+/* the correctly rounded double of d, in the slow but exact way */
+static double ljson_decimal_to_double(ljson_decimal* d, bool neg) {
+    const int bias = -1023;
+    static const int powtab[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+    const int powtab_size = sizeof(powtab) / sizeof(powtab[0]);
+    uint64_t man = 0;
+    int exp = 0;
+    uint64_t bits;
+
+    if (d->num_digits == 0 || d->decimal_point < -330) {
+        exp = bias;
+    } else if (d->decimal_point > 310) {
+        goto overflow;
+    } else {
+        /* scale by powers of two until in range [0.5, 1) */
+        while (d->decimal_point > 0) {
+            int n = d->decimal_point >= powtab_size ? 27 : powtab[d->decimal_point];
+            ljson_decimal_shift(d, -n);
+            exp += n;
+        }
+        while (d->decimal_point < 0 || (d->decimal_point == 0 && d->digits[0] < 5)) {
+            int n = -d->decimal_point >= powtab_size ? 27 : powtab[-d->decimal_point];
+            ljson_decimal_shift(d, n);
+            exp -= n;
+        }
+        /* the range of a double is [1, 2) */
+        exp--;
+        if (exp < bias + 1) {
+            ljson_decimal_shift(d, -(bias + 1 - exp));
+            exp = bias + 1;
+        }
+        if (exp - bias >= 0x7FF)
+            goto overflow;
+
+        ljson_decimal_shift(d, 53);
+        man = ljson_decimal_rounded_integer(d);
+        if (man == uint64_t(2) << 52) {
+            man >>= 1;
+            exp++;
+            if (exp - bias >= 0x7FF)
+                goto overflow;
+        }
+        /* subnormal */
+        if ((man & (uint64_t(1) << 52)) == 0)
+            exp = bias;
+    }
+    bits = (man & ((uint64_t(1) << 52) - 1)) | (uint64_t((exp - bias) & 0x7FF) << 52);
+    if (neg)
+        bits |= 0x8000000000000000ULL;
+    return ljson_double_from_bits(bits);
+
+overflow:
+    return neg ? -HUGE_VAL : HUGE_VAL;
+}
+
 static int ljson_parse_number(ljson_context* c, ljson_value* v) {
     const char* p = c->json;
+    const char* end = c->end;
+    bool neg = false;
+    uint64_t man = 0;           /* the first 19 significant digits */
+    int num_digits = 0;         /* significant digits in man */
+    int64_t exp10 = 0;
+    bool truncated = false;     /* some non zero digits are not in man */
+    uint64_t chunk;
+
+    if (*p == '-') {
+        neg = true;
+        p++;
+    }
 
-    if (*p == '-') p++;
-    
-    if (*p == '0') p++;
+    const char* int_begin = p;
+    if (ljson_peek(p, end) == '0') p++;
     else {
-        if (!isdigit1to9(*p)) return LJSON_PARSE_INVALID_VALUE;
-        for (p++; isdigit(*p); p++);
+        if (!isdigit1to9(ljson_peek(p, end))) return LJSON_PARSE_INVALID_VALUE;
+        for (;;) {
+            if (num_digits <= 19 - 8 && ljson_load8(p, end, &chunk) && ljson_is_8digits(chunk)) {
+                man = man * 100000000 + ljson_parse_8digits(chunk);
+                num_digits += 8;
+                p += 8;
+                continue;
+            }
+            if (!ljson_is_digit(ljson_peek(p, end)))
+                break;
+            if (num_digits < 19) {
+                man = man * 10 + (*p - '0');
+                num_digits++;
+            } else {
+                exp10++;
+                truncated |= *p != '0';
+            }
+            p++;
+        }
     }
 
-    if (*p == '.') {
+    size_t int_digits = p - int_begin;
+    bool is_integer = true;
+
+    if (ljson_peek(p, end) == '.') {
+        is_integer = false;
         p++;
-        if(!isdigit(*p)) return LJSON_PARSE_INVALID_VALUE;
-        for (p++; isdigit(*p); p++);
+        if (!ljson_is_digit(ljson_peek(p, end))) return LJSON_PARSE_INVALID_VALUE;
+        for (;;) {
+            if (man != 0 && num_digits <= 19 - 8 && ljson_load8(p, end, &chunk) && ljson_is_8digits(chunk)) {
+                man = man * 100000000 + ljson_parse_8digits(chunk);
+                num_digits += 8;
+                exp10 -= 8;
+                p += 8;
+                continue;
+            }
+            if (!ljson_is_digit(ljson_peek(p, end)))
+                break;
+            if (man == 0 && *p == '0') {
+                exp10--;
+            } else if (num_digits < 19) {
+                man = man * 10 + (*p - '0');
+                num_digits++;
+                exp10--;
+            } else {
+                truncated |= *p != '0';
+            }
+            p++;
+        }
     }
 
-    if (*p == 'e' || *p == 'E') {
+    char ch = ljson_peek(p, end);
+    if (ch == 'e' || ch == 'E') {
+        is_integer = false;
         p++;
-        if (*p == '+' || *p == '-') p++;
-        if (!isdigit(*p)) return LJSON_PARSE_INVALID_VALUE;
-        for (p++; isdigit(*p); p++);
+        ch = ljson_peek(p, end);
+        bool exp_neg = ch == '-';
+        if (ch == '+' || ch == '-') p++;
+        if (!ljson_is_digit(ljson_peek(p, end))) return LJSON_PARSE_INVALID_VALUE;
+        int64_t e = 0;
+        for (; p < end && ljson_is_digit(*p); p++)
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+        exp10 += exp_neg ? -e : e;
+    }
+
+    /* integers which fit are kept exact, -0 stays a double to keep its sign */
+    if (is_integer && (man != 0 || !neg)) {
+        if (int_digits == 20 && !neg) {
+            unsigned last = p[-1] - '0';
+            if (man <= (UINT64_MAX - last) / 10) {
+                man = man * 10 + last;
+                int_digits = 19;
+            }
+        }
+        if (int_digits <= 19 && (!neg || man <= uint64_t(INT64_MAX) + 1)) {
+            if (neg) {
+                v->data.mint64 = (int64_t)(0 - man);
+                v->flags = LJSON_FLAG_INT64;
+            } else {
+                v->data.muint64 = man;
+                v->flags = man <= uint64_t(INT64_MAX) ? LJSON_FLAG_INT64 : LJSON_FLAG_UINT64;
+            }
+            c->json = p;
+            v->type = LJSON_NUMBER;
+            return LJSON_PARSE_OK;
+        }
     }
 
-    errno = 0;
-    v->data.mdouble = strtod(c->json, nullptr);
-    if (errno == ERANGE && (v->data.mdouble == HUGE_VAL || v->data.mdouble == -HUGE_VAL)) return LJSON_PARSE_NUMBER_TOO_BIG;
+    double d;
+    if (!truncated && man <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+        /* Clinger: both man and 10^exp10 are exact doubles, one rounding */
+        d = (double)man;
+        d = exp10 < 0 ? d / ljson_exact_pow10[-exp10] : d * ljson_exact_pow10[exp10];
+        if (neg)
+            d = -d;
+    } else {
+        double d2;
+        if (!ljson_eisel_lemire(man, exp10, neg, &d)
+            || (truncated && (!ljson_eisel_lemire(man + 1, exp10, neg, &d2) || d != d2))) {
+            ljson_decimal dec;
+            ljson_decimal_parse(&dec, neg ? c->json + 1 : c->json, p);
+            d = ljson_decimal_to_double(&dec, neg);
+        }
+    }
+    if (d == HUGE_VAL || d == -HUGE_VAL)
+        return LJSON_PARSE_NUMBER_TOO_BIG;
+    v->data.mdouble = d;
     c->json = p;
     v->type = LJSON_NUMBER;
     return LJSON_PARSE_OK;
 }
 
-static const char* ljson_parse_hex4(const char* p, unsigned* u) {
+static const char* ljson_parse_hex4(const char* p, const char* end, unsigned* u) {
     int i;
     *u = 0;
     for (i = 0; i < 4; i++) {
-        char ch = *p++;
+        char ch = ljson_peek(p++, end);
         *u <<= 4;
         if      (ch >= '0' && ch <= '9')  *u |= ch - '0';
         else if (ch >= 'A' && ch <= 'F')  *u |= ch - ('A' - 10);
@@ -414,292 +3153,2755 @@ static const char* ljson_parse_hex4(const char* p, unsigned* u) {
     return p;
 }
 
-static void ljson_encode_utf8(std::string & s, unsigned u) {
-    if (u <= 0x7F) 
-        s += u & 0xFF;
+/* write u in utf-8 to s, return the number of bytes (at most 4) */
+static size_t ljson_encode_utf8(char* s, unsigned u) {
+    if (u <= 0x7F) {
+        s[0] = u & 0xFF;
+        return 1;
+    }
     else if (u <= 0x7FF) {
-        s += 0xC0 | ((u >> 6) & 0xFF);
-        s += 0x80 | ( u       & 0x3F);
+        s[0] = 0xC0 | ((u >> 6) & 0xFF);
+        s[1] = 0x80 | ( u       & 0x3F);
+        return 2;
     }
     else if (u <= 0xFFFF) {
-        s += 0xE0 | ((u >> 12) & 0xFF);
-        s += 0x80 | ((u >>  6) & 0x3F);
-        s += 0x80 | ( u        & 0x3F);
+        s[0] = 0xE0 | ((u >> 12) & 0xFF);
+        s[1] = 0x80 | ((u >>  6) & 0x3F);
+        s[2] = 0x80 | ( u        & 0x3F);
+        return 3;
     }
     else {
         assert(u <= 0x10FFFF);
-        s += 0xF0 | ((u >> 18) & 0xFF);
-        s += 0x80 | ((u >> 12) & 0x3F);
-        s += 0x80 | ((u >>  6) & 0x3F);
-        s += 0x80 | ( u        & 0x3F);
+        s[0] = 0xF0 | ((u >> 18) & 0xFF);
+        s[1] = 0x80 | ((u >> 12) & 0x3F);
+        s[2] = 0x80 | ((u >>  6) & 0x3F);
+        s[3] = 0x80 | ( u        & 0x3F);
+        return 4;
     }
 }
 
-static int ljson_parse_string_raw(ljson_context* c, std::string & cache_string) {
+/*
+ * decode the escape sequence after a backslash at *head to out, set *len to its length (at most 4).
+ * All the input is read before out is written, so out may overlap the escape itself
+ */
+static int ljson_parse_escape(const char** head, const char* end, char* out, size_t* len) {
     unsigned u, u2;
-    expect_char(c, '\"');
-    cache_string = "";
-    const char* head = c->json;
+    const char* p = *head;
+    *len = 1;
+    switch(ljson_peek(p++, end)) {
+        case '\"': *out = '\"'; break;
+        case '\\': *out = '\\'; break;
+        case '/':  *out = '/';  break;
+        case 'b':  *out = '\b'; break;
+        case 'f':  *out = '\f'; break;
+        case 'n':  *out = '\n'; break;
+        case 'r':  *out = '\r'; break;
+        case 't':  *out = '\t'; break;
+        case 'u':
+            if (!(p = ljson_parse_hex4(p, end, &u)))
+                return LJSON_PARSE_INVALID_UNICODE_HEX;
+            if (u >= 0xD800 && u <= 0xDBFF) { /* surrogate pair */
+                if (ljson_peek(p++, end) != '\\')
+                    return LJSON_PARSE_INVALID_UNICODE_SURROGATE;
+                if (ljson_peek(p++, end) != 'u')
+                    return LJSON_PARSE_INVALID_UNICODE_SURROGATE;
+                if (!(p = ljson_parse_hex4(p, end, &u2)))
+                    return LJSON_PARSE_INVALID_UNICODE_HEX;
+                if (u2 < 0xDC00 || u2 > 0xDFFF)
+                    return LJSON_PARSE_INVALID_UNICODE_SURROGATE;
+                u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
+            }
+            *len = ljson_encode_utf8(out, u);
+            break;
+        default:
+            return LJSON_PARSE_INVALID_STRING_ESCAPE;
+    }
+    *head = p;
+    return LJSON_PARSE_OK;
+}
+
+/*
+ * decode a string from head, after its opening quote or a part of it which is done, up to its closing
+ * quote. The chars go to w: head itself or a place before it in the same buffer, or another buffer
+ * with room for the rest of the raw string and a NUL. *wend is the end of the chars, the NUL follows
+ * them, and the cursor moves after the quote
+ */
+static int ljson_decode_string(ljson_context* c, const char* head, char* w, char** wend) {
+    int ret;
     while (true) {
+        const char* run = ljson_scan_string(head, c->end);
+        if (w != head)
+            memmove(w, head, run - head);
+        w += run - head;
+        head = run;
+        if (head == c->end)
+            return LJSON_PARSE_MISS_QUOTATION_MARK;
         char ch = *head++;
         switch (ch) {
             case '\"':
+                /* in place, the closing quote is overwritten at most */
+                *w = '\0';
+                *wend = w;
                 c->json = head;
                 return LJSON_PARSE_OK;
-            case '\0':
-                return LJSON_PARSE_MISS_QUOTATION_MARK;
-            case '\\':
-                switch(*head++) {
-                    case '\"': cache_string += '\"'; break;
-                    case '\\': cache_string += '\\'; break;
-                    case '/':  cache_string += '/';  break;
-                    case 'b':  cache_string += '\b'; break;
-                    case 'f':  cache_string += '\f'; break;
-                    case 'n':  cache_string += '\n'; break;
-                    case 'r':  cache_string += '\r'; break;
-                    case 't':  cache_string += '\t'; break;
-                    case 'u':
-                        if (!(head = ljson_parse_hex4(head, &u)))
-                            return LJSON_PARSE_INVALID_UNICODE_HEX;
-                        if (u >= 0xD800 && u <= 0xDBFF) { /* surrogate pair */
-                            if (*head++ != '\\')
-                                return LJSON_PARSE_INVALID_UNICODE_SURROGATE;
-                            if (*head++ != 'u')
-                                return LJSON_PARSE_INVALID_UNICODE_SURROGATE;
-                            if (!(head = ljson_parse_hex4(head, &u2)))
-                                return LJSON_PARSE_INVALID_UNICODE_HEX;
-                            if (u2 < 0xDC00 || u2 > 0xDFFF)
-                                return LJSON_PARSE_INVALID_UNICODE_SURROGATE;
-                            u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
-                        }
-                        ljson_encode_utf8(cache_string, u);
-                        break;
-                    default:
-                        return LJSON_PARSE_INVALID_STRING_ESCAPE;
-                }
+            case '\\': {
+                size_t n;
+                if ((ret = ljson_parse_escape(&head, c->end, w, &n)) != LJSON_PARSE_OK)
+                    return ret;
+                w += n;
                 break;
+            }
             default:
-                if ((unsigned char)ch < 0x20) {
-                    return LJSON_PARSE_INVALID_STRING_CHAR;
-                }
-                cache_string += ch;
+                assert((unsigned char)ch < 0x20);
+                return LJSON_PARSE_INVALID_STRING_CHAR;
         }
     }
 }
 
-static int ljson_parse_string(ljson_context* c, ljson_value* v) {
-    int ret;
-    std::string cache_string;
-    if ((ret = ljson_parse_string_raw(c, cache_string)) == LJSON_PARSE_OK)
-        setString(v, cache_string);
-    return ret;
+/* the closing quote of the string whose chars go on at p, or end if it has none. Nothing is checked */
+static const char* ljson_find_string_end(const char* p, const char* end) {
+    for (;;) {
+        p = ljson_scan_string(p, end);
+        if (p == end || *p == '\"')
+            return p;
+        p += *p == '\\' && end - p >= 2 ? 2 : 1;
+    }
+}
+
+/* decode the string in place, it becomes the NUL terminated (*str)[0, *len) inside the input */
+static int ljson_parse_string_insitu(ljson_context* c, const char** str, size_t* len) {
+    int ret;
+    char* end;
+    assert(c->insitu);
+    expect_char(c, '\"');
+    char* begin = const_cast<char*>(c->json);
+    if ((ret = ljson_decode_string(c, begin, begin, &end)) != LJSON_PARSE_OK)
+        return ret;
+    *str = begin;
+    *len = end - begin;
+    return LJSON_PARSE_OK;
+}
+
+/*
+ * the next string: escape free strings point into the input and the insitu ones are decoded in
+ * place. The others are decoded once, into reserve(size) where size is the length of the raw string,
+ * which the decoded one never exceeds. reserve returns room for size chars and a NUL which outlives
+ * the parse, then *copy is false, or nullptr to decode into c->scratch
+ */
+template <typename Reserve>
+static int ljson_parse_string_token(ljson_context* c, const char** str, size_t* len, bool* copy, Reserve reserve) {
+    int ret;
+    if (c->insitu) {
+        *copy = false;
+        return ljson_parse_string_insitu(c, str, len);
+    }
+    *copy = true;
+    const char* head = c->json + 1;
+    const char* run = ljson_scan_string(head, c->end);
+    if (run != c->end && *run == '\"') {
+        *str = head;
+        *len = run - head;
+        c->json = run + 1;
+        return LJSON_PARSE_OK;
+    }
+    /* the part before the first escape is scanned once and copied as it is */
+    size_t size = ljson_find_string_end(run, c->end) - head;
+    char* dest = reserve(size);
+    if (dest != nullptr)
+        *copy = false;
+    else {
+        if (c->scratch.size() < size + 1)
+            c->scratch.resize(size + 1);
+        dest = &c->scratch[0];
+    }
+    memcpy(dest, head, run - head);
+    char* end;
+    if ((ret = ljson_decode_string(c, run, dest + (run - head), &end)) != LJSON_PARSE_OK)
+        return ret;
+    *str = dest;
+    *len = end - dest;
+    return LJSON_PARSE_OK;
+}
+
+static int ljson_parse_string_token(ljson_context* c, const char** str, size_t* len, bool* copy) {
+    return ljson_parse_string_token(c, str, len, copy, [](size_t) -> char* { return nullptr; });
+}
+
+inline int ljson_event(bool ok) {
+    return ok ? LJSON_PARSE_OK : LJSON_PARSE_TERMINATED;
+}
+
+template <typename Handler>
+static int ljson_parse_number(ljson_context* c, Handler & h) {
+    ljson_value n;
+    int ret;
+    ljson_init(&n);
+    if ((ret = ljson_parse_number(c, &n)) != LJSON_PARSE_OK)
+        return ret;
+    if (n.flags & LJSON_FLAG_INT64)
+        return ljson_event(h.Int64(n.data.mint64));
+    if (n.flags & LJSON_FLAG_UINT64)
+        return ljson_event(h.Uint64(n.data.muint64));
+    return ljson_event(h.Number(n.data.mdouble));
+}
+
+template <typename Handler>
+static int ljson_parse_string(ljson_context* c, Handler & h) {
+    const char* str;
+    size_t len;
+    bool copy;
+    int ret;
+    if ((ret = ljson_parse_string_token(c, &str, &len, &copy, [&h](size_t size) { return h.Reserve(size, false); }))
+            != LJSON_PARSE_OK)
+        return ret;
+    return ljson_event(h.String(str, len, copy));
+}
+
+/* a key and its colon, the cursor is left on the value */
+template <typename Handler>
+static int ljson_parse_key(ljson_context* c, Handler & h) {
+    const char* key;
+    size_t len;
+    bool copy;
+    int ret;
+    if (ljson_peek(c->json, c->end) != '"')
+        return LJSON_PARSE_MISS_KEY;
+    if ((ret = ljson_parse_string_token(c, &key, &len, &copy, [&h](size_t size) { return h.Reserve(size, true); }))
+            != LJSON_PARSE_OK)
+        return ret;
+    if (!h.Key(key, len, copy))
+        return LJSON_PARSE_TERMINATED;
+    ljson_parse_whitespace(c);
+    if (ljson_peek(c->json, c->end) != ':')
+        return LJSON_PARSE_MISS_COLON;
+    c->json++;
+    ljson_parse_whitespace(c);
+    return LJSON_PARSE_OK;
+}
+
+template <typename Handler>
+static int ljson_parse_scalar(ljson_context* c, Handler & h) {
+    int ret;
+    switch (ljson_peek(c->json, c->end)) {
+        case 'n':
+            if ((ret = ljson_parse_literal(c, "null")) != LJSON_PARSE_OK)
+                return ret;
+            return ljson_event(h.Null());
+        case 't':
+            if ((ret = ljson_parse_literal(c, "true")) != LJSON_PARSE_OK)
+                return ret;
+            return ljson_event(h.Bool(true));
+        case 'f':
+            if ((ret = ljson_parse_literal(c, "false")) != LJSON_PARSE_OK)
+                return ret;
+            return ljson_event(h.Bool(false));
+        case '\"': return ljson_parse_string(c, h);
+        case '\0': return LJSON_PARSE_EXPECT_VALUE;
+        default:   return ljson_parse_number(c, h);
+    }
+}
+
+/*
+ * the grammar of ljson_parse_value without recursion: the containers above base in c->frames
+ * are the open ones, each frame is the member count << 1 | 1 for an object
+ */
+template <typename Handler>
+static int ljson_parse_nested(ljson_context* c, Handler & h, size_t base) {
+    int ret;
+    for (;;) {
+        char ch = ljson_peek(c->json, c->end);
+        if (ch == '[' || ch == '{') {
+            bool object = ch == '{';
+            if (c->frames.size() - base >= c->max_depth)
+                return LJSON_PARSE_DEPTH_EXCEEDED;
+            c->json++;
+            if (!(object ? h.StartObject() : h.StartArray()))
+                return LJSON_PARSE_TERMINATED;
+            ljson_parse_whitespace(c);
+            if (ljson_peek(c->json, c->end) != (object ? '}' : ']')) {
+                if (c->frames.capacity() == 0)
+                    c->frames.reserve(16);
+                c->frames.push_back(object ? 1 : 0);
+                if (object && (ret = ljson_parse_key(c, h)) != LJSON_PARSE_OK)
+                    return ret;
+                continue;
+            }
+            c->json++;
+            if (!(object ? h.EndObject(0) : h.EndArray(0)))
+                return LJSON_PARSE_TERMINATED;
+        } else if ((ret = ljson_parse_scalar(c, h)) != LJSON_PARSE_OK)
+            return ret;
+
+        /* a value is done, close the containers which end after it */
+        for (;;) {
+            if (c->frames.size() == base)
+                return LJSON_PARSE_OK;
+            size_t & frame = c->frames.back();
+            bool object = (frame & 1) != 0;
+            frame += 2;
+            ljson_parse_whitespace(c);
+            ch = ljson_peek(c->json, c->end);
+            if (ch == ',') {
+                c->json++;
+                ljson_parse_whitespace(c);
+                if (object && (ret = ljson_parse_key(c, h)) != LJSON_PARSE_OK)
+                    return ret;
+                break;
+            }
+            if (ch != (object ? '}' : ']'))
+                return object ? LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            c->json++;
+            size_t count = frame >> 1;
+            c->frames.pop_back();
+            if (!(object ? h.EndObject(count) : h.EndArray(count)))
+                return LJSON_PARSE_TERMINATED;
+        }
+    }
+}
+
+/* the stack of the caller stays the same whatever the nesting, which c->max_depth limits */
+template <typename Handler>
+static int ljson_parse_value(ljson_context* c, Handler & h) {
+    size_t base = c->frames.size();
+    int ret = ljson_parse_nested(c, h, base);
+    if (ret != LJSON_PARSE_OK)
+        c->frames.resize(base);
+    return ret;
+}
+
+template <typename Handler>
+static int ljson_parse_root(ljson_context* c, Handler & h) {
+    int ret;
+    ljson_parse_whitespace(c);
+    if ((ret = ljson_parse_value(c, h)) == LJSON_PARSE_OK) {
+        ljson_parse_whitespace(c);
+        if (c->json != c->end)
+            ret = LJSON_PARSE_ROOT_NOT_SINGULAR;
+    }
+    return ret;
+}
+
+/* parse one json of the lines of a ndjson, reusing the scratch of c */
+template <typename Handler>
+static int ljson_parse_line(ljson_context* c, const char* begin, const char* end, Handler & h) {
+    c->json = begin;
+    c->end = end;
+    c->insitu = false;
+    return ljson_parse_root(c, h);
+}
+
+template <typename Handler>
+int ljson_parse_sax(Handler & handler, const char* json, size_t len, size_t max_depth) {
+    ljson_context c;
+    assert(json != nullptr || len == 0);
+    c.json = json;
+    c.end = json + len;
+    c.insitu = false;
+    c.max_depth = max_depth;
+    return ljson_parse_root(&c, handler);
+}
+
+template <typename Handler>
+int ljson_parse_sax(Handler & handler, const char* json) {
+    assert(json != nullptr);
+    return ljson_parse_sax(handler, json, strlen(json));
+}
+
+template <typename Handler>
+int ljson_parse_sax(Handler & handler, const std::string & json) {
+    return ljson_parse_sax(handler, json.data(), json.size());
+}
+
+template <typename Handler>
+int ljson_parse_sax_insitu(Handler & handler, char* buf, size_t len, size_t max_depth) {
+    ljson_context c;
+    assert(buf != nullptr || len == 0);
+    c.json = buf;
+    c.end = buf + len;
+    c.insitu = true;
+    c.max_depth = max_depth;
+    return ljson_parse_root(&c, handler);
+}
+
+/*
+ * the handler of ljson_parse which builds the DOM. The values of the open containers
+ * wait on one shared stack, a container takes its elements from the top when it ends
+ */
+class ljson_dom_handler : public ljson_base_handler<ljson_dom_handler> {
+public:
+    ljson_dom_handler(ljson_value* root, ljson_arena* arena, ljson_parse_buffers* buffers = nullptr, KeyPool* pool = nullptr)
+        : mroot(root), marena(arena), mpool(pool), mdepth(0),
+          mstack(buffers != nullptr ? buffers->values : mbuffers.values),
+          mkeys(buffers != nullptr ? buffers->keys : mbuffers.keys),
+          mreserved(nullptr), mreserved_string(nullptr), mreserved_key(nullptr) { }
+    ~ljson_dom_handler() { clear(); }
+
+    /*! \brief the next value goes to root, what an error left of the one before is freed */
+    void Reset(ljson_value* root) {
+        clear();
+        mroot = root;
+    }
+
+    bool Null() {
+        push()->type = LJSON_NULL;
+        return true;
+    }
+    bool Bool(bool b) {
+        push()->type = b ? LJSON_TRUE : LJSON_FALSE;
+        return true;
+    }
+    bool Number(double d) {
+        ljson_value* v = push();
+        v->data.mdouble = d;
+        v->type = LJSON_NUMBER;
+        return true;
+    }
+    bool Int64(int64_t i) {
+        ljson_value* v = push();
+        v->data.mint64 = i;
+        v->type = LJSON_NUMBER;
+        v->flags = LJSON_FLAG_INT64;
+        return true;
+    }
+    bool Uint64(uint64_t u) {
+        ljson_value* v = push();
+        v->data.muint64 = u;
+        v->type = LJSON_NUMBER;
+        v->flags = LJSON_FLAG_UINT64;
+        return true;
+    }
+    /* a long string or key with escapes is decoded into the place it keeps, in the arena or on the heap */
+    char* Reserve(size_t size, bool key) {
+        release();
+        if (key ? mpool != nullptr || size <= ljson_key::SHORT_MAX : size <= LJSON_SHORT_STRING_MAX)
+            return nullptr;
+        if (marena != nullptr && (key || size <= UINT32_MAX))
+            mreserved = static_cast<char*>(marena->allocate(size + 1, 1));
+        else if (key)
+            mreserved = mreserved_key = new char[size + 1];
+        else {
+            mreserved_string = new std::string(size, '\0');
+            mreserved = &(*mreserved_string)[0];
+        }
+        return mreserved;
+    }
+    bool String(const char* str, size_t len, bool copy) {
+        ljson_value* v = push();
+        if (!copy && str == mreserved && len > LJSON_SHORT_STRING_MAX) {
+            mreserved = nullptr;
+            if (mreserved_string != nullptr) {
+                mreserved_string->resize(len);
+                v->data.mstring = mreserved_string;
+                mreserved_string = nullptr;
+            } else {
+                v->data.mslice.ptr = str;
+                v->data.mslice.len = uint32_t(len);
+                v->flags = LJSON_FLAG_ARENA;
+            }
+            v->type = LJSON_STRING;
+            return true;
+        }
+        if ((copy || str == mreserved) && len <= LJSON_SHORT_STRING_MAX) {
+            ljson_set_short(v, str, len);
+            return true;
+        }
+        bool slice = len <= UINT32_MAX;     /* the length of mslice has 32 bits */
+        if (!copy && slice) {
+            /* insitu: the string stays in the buffer */
+            v->data.mslice.ptr = str;
+            v->data.mslice.len = uint32_t(len);
+            v->flags = LJSON_FLAG_INSITU;
+        } else if (marena != nullptr && slice) {
+            char* s = static_cast<char*>(marena->allocate(len + 1, 1));
+            memcpy(s, str, len);
+            s[len] = '\0';
+            v->data.mslice.ptr = s;
+            v->data.mslice.len = uint32_t(len);
+            v->flags = LJSON_FLAG_ARENA;
+        } else
+            v->data.mstring = new std::string(str, len);
+        v->type = LJSON_STRING;
+        return true;
+    }
+    bool Key(const char* str, size_t len, bool copy) {
+        const KeyPool::Entry* e = mpool != nullptr ? mpool->Intern(str, len) : nullptr;
+        if (e != nullptr)
+            mkeys.emplace_back(e);
+        else if (!copy && str == mreserved) {
+            mkeys.push_back(mreserved_key != nullptr ? ljson_key::adopt(mreserved_key, len) : ljson_key::slice(str, len));
+            mreserved = mreserved_key = nullptr;
+        } else if (!copy)
+            mkeys.push_back(ljson_key::slice(str, len));    /* insitu: the key stays in the buffer */
+        else if (marena != nullptr && len > ljson_key::SHORT_MAX) {
+            char* s = static_cast<char*>(marena->allocate(len + 1, 1));
+            memcpy(s, str, len);
+            s[len] = '\0';
+            mkeys.push_back(ljson_key::slice(s, len));
+        } else
+            mkeys.emplace_back(str, len);
+        return true;
+    }
+    bool StartObject() {
+        mdepth++;
+        return true;
+    }
+    bool EndObject(size_t count) {
+        ljson_map* m = ljson_create<ljson_map>(marena, ljson_allocator<ljson_map::value_type>(marena));
+        m->reserve(count);
+        ljson_value* values = mstack.data() + mstack.size() - count;
+        ljson_key* keys = mkeys.data() + mkeys.size() - count;
+        bool tree = marena != nullptr;
+        for (size_t i = 0; i < count; i++) {
+            tree = tree && !keys[i].owned() && ljson_owns_nothing(&values[i]);
+            auto result = m->emplace(std::move(keys[i]), values[i]);
+            if (!result.second) {
+                /* the last one of the duplicated keys wins */
+                ljson_free(&result.first->second);
+                result.first->second = values[i];
+            }
+        }
+        mstack.resize(mstack.size() - count);
+        mkeys.resize(mkeys.size() - count);
+        mdepth--;
+        ljson_value* v = push();
+        v->data.mobject = m;
+        v->type = LJSON_OBJECT;
+        v->flags = marena != nullptr ? LJSON_FLAG_ARENA : 0;
+        if (tree)
+            v->flags |= LJSON_FLAG_ARENA_TREE;
+        return true;
+    }
+    bool StartArray() {
+        mdepth++;
+        return true;
+    }
+    bool EndArray(size_t count) {
+        ljson_value* values = mstack.data() + mstack.size() - count;
+        ljson_array* a = ljson_create<ljson_array>(marena, values, values + count, ljson_allocator<ljson_value>(marena));
+        bool tree = marena != nullptr;
+        for (size_t i = 0; tree && i < count; i++)
+            tree = ljson_owns_nothing(&values[i]);
+        mstack.resize(mstack.size() - count);
+        mdepth--;
+        ljson_value* v = push();
+        v->data.marray = a;
+        v->type = LJSON_ARRAY;
+        v->flags = marena != nullptr ? LJSON_FLAG_ARENA : 0;
+        if (tree)
+            v->flags |= LJSON_FLAG_ARENA_TREE;
+        return true;
+    }
+
+private:
+    /* the values of the containers left open by an error */
+    void clear() {
+        release();
+        for (auto iter = mstack.begin(); iter != mstack.end(); iter++)
+            ljson_free(&(*iter));
+        mstack.clear();
+        mkeys.clear();
+        mdepth = 0;
+    }
+    /* frees the storage of Reserve() which no string took, after an error */
+    void release() {
+        delete mreserved_string;
+        delete[] mreserved_key;
+        mreserved = mreserved_key = nullptr;
+        mreserved_string = nullptr;
+    }
+    /* the slot of the next value, the root itself once every container is closed */
+    ljson_value* push() {
+        if (mdepth == 0)
+            return mroot;
+        mstack.emplace_back();
+        return &mstack.back();
+    }
+
+    ljson_value* mroot;
+    ljson_arena* marena;
+    KeyPool* mpool;                     /*!< interns the keys if it is not nullptr */
+    size_t mdepth;
+    ljson_parse_buffers mbuffers;       /*!< the working memory when the caller gives none */
+    std::vector<ljson_value> & mstack;
+    std::vector<ljson_key> & mkeys;
+    char* mreserved;                    /*!< the storage of the last Reserve() until a string takes it */
+    std::string* mreserved_string;      /*!< the heap string of it */
+    char* mreserved_key;                /*!< the heap chars of it for a key */
+};
+
+/* index of the lowest set bit, mask must not be 0 */
+inline unsigned ljson_ctz64(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctzll(mask);
+#endif
+}
+
+/* bit i is the xor of the bits 0..i */
+inline uint64_t ljson_prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/* the masks of the quotes, backslashes and ",:[]{}" in the 64 bytes at p */
+static void ljson_classify64(const char* p, uint64_t* quote, uint64_t* backslash, uint64_t* op) {
+    *quote = *backslash = *op = 0;
+#if defined(LJSON_AVX2)
+    for (int k = 0; k < 2; k++) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * k));
+        __m256i o = _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_set1_epi8(',')), _mm256_cmpeq_epi8(s, _mm256_set1_epi8(':')));
+        o = _mm256_or_si256(o, _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(s, _mm256_set1_epi8(']'))));
+        o = _mm256_or_si256(o, _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(s, _mm256_set1_epi8('}'))));
+        *quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, _mm256_set1_epi8('\"'))) << (32 * k);
+        *backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, _mm256_set1_epi8('\\'))) << (32 * k);
+        *op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(o) << (32 * k);
+    }
+#elif defined(LJSON_SSE2)
+    for (int k = 0; k < 4; k++) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+        __m128i o = _mm_or_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8(',')), _mm_cmpeq_epi8(s, _mm_set1_epi8(':')));
+        o = _mm_or_si128(o, _mm_or_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8('[')), _mm_cmpeq_epi8(s, _mm_set1_epi8(']'))));
+        o = _mm_or_si128(o, _mm_or_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8('{')), _mm_cmpeq_epi8(s, _mm_set1_epi8('}'))));
+        *quote |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(s, _mm_set1_epi8('\"'))) << (16 * k);
+        *backslash |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(s, _mm_set1_epi8('\\'))) << (16 * k);
+        *op |= (uint64_t)(uint32_t)_mm_movemask_epi8(o) << (16 * k);
+    }
+#else
+    for (int i = 0; i < 64; i++) {
+        uint64_t bit = uint64_t(1) << i;
+        switch (p[i]) {
+            case '\"': *quote |= bit; break;
+            case '\\': *backslash |= bit; break;
+            case ',': case ':': case '[': case ']': case '{': case '}': *op |= bit; break;
+            default: break;
+        }
+    }
+#endif
+}
+
+/* the string state carried from one 64 byte block to the next */
+typedef struct {
+    uint64_t prev_escaped;      /*!< the first byte of the block is escaped */
+    uint64_t prev_in_string;    /*!< all ones if the block starts in a string */
+} ljson_block_state;
+
+/* the mask of the ",:[]{}" outside the strings in the 64 bytes of json at i, the last block is padded */
+static uint64_t ljson_structural64(const char* json, size_t len, size_t i, ljson_block_state* state) {
+    const char* p = json + i;
+    char tail[64];
+    if (len - i < 64) {
+        /* pad the last block with whitespace instead of reading past the end */
+        memset(tail, ' ', sizeof(tail));
+        memcpy(tail, p, len - i);
+        p = tail;
+    }
+    uint64_t quote, backslash, op;
+    ljson_classify64(p, &quote, &backslash, &op);
+
+    /* a backslash escapes the next byte unless it is escaped itself, backslashes are rare */
+    uint64_t escaped = state->prev_escaped;
+    uint64_t escapes = backslash & ~escaped;
+    state->prev_escaped = 0;
+    while (escapes != 0) {
+        unsigned k = ljson_ctz64(escapes);
+        if (k == 63) {
+            state->prev_escaped = 1;
+            break;
+        }
+        escaped |= uint64_t(2) << k;
+        escapes &= ~(uint64_t(3) << k);
+    }
+    quote &= ~escaped;
+
+    /* the opening quote and the string are in it, the closing quote is not */
+    uint64_t in_string = ljson_prefix_xor(quote) ^ state->prev_in_string;
+    state->prev_in_string = (uint64_t)((int64_t)in_string >> 63);
+    return op & ~in_string;
+}
+
+/*
+ * find the end of the root array which starts at json[begin], the top level commas
+ * which cut it into about pieces parts and the number of elements of each part.
+ * False if the brackets do not close
+ */
+static bool ljson_split_array(const char* json, size_t len, size_t begin, size_t pieces,
+                              std::vector<size_t> & cuts, std::vector<size_t> & counts, size_t* root_end) {
+    size_t step = (len - begin) / pieces + 1;
+    size_t next = begin + step;
+    size_t depth = 0, commas = 0;
+    ljson_block_state state = { 0, 0 };
+    for (size_t i = begin & ~size_t(63); i < len; i += 64) {
+        uint64_t structural = ljson_structural64(json, len, i, &state);
+        if (i < begin)
+            structural &= ~uint64_t(0) << (begin - i);
+        for (; structural != 0; structural &= structural - 1) {
+            size_t pos = i + ljson_ctz64(structural);
+            switch (json[pos]) {
+                case '[': case '{':
+                    depth++;
+                    break;
+                case ']': case '}':
+                    if (--depth == 0) {
+                        *root_end = pos;
+                        counts.push_back(commas + 1);
+                        return true;
+                    }
+                    break;
+                case ',':
+                    if (depth != 1)
+                        break;
+                    if (pos >= next) {
+                        cuts.push_back(pos);
+                        counts.push_back(commas + 1);
+                        commas = 0;
+                        next = pos + step;
+                    } else
+                        commas++;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    return false;
+}
+
+/*
+ * parse the elements in [begin, end) of an array, which are separated by commas,
+ * into out, which has room for count of them. *parsed is the number written
+ */
+static int ljson_parse_elements(const char* begin, const char* end, bool allow_empty, ljson_value* out, size_t count,
+                                size_t* parsed, ljson_arena* arena) {
+    ljson_context c;
+    ljson_value e;
+    int ret;
+    c.json = begin;
+    c.end = end;
+    c.insitu = false;
+    c.max_depth = LJSON_MAX_DEPTH - 1;  /* the root array is the first level */
+    ljson_dom_handler h(&e, arena);
+    *parsed = 0;
+    ljson_parse_whitespace(&c);
+    if (c.json == c.end && allow_empty)
+        return LJSON_PARSE_OK;
+    for (;;) {
+        if (*parsed == count)
+            return LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+        ljson_init(&e);
+        if ((ret = ljson_parse_value(&c, h)) != LJSON_PARSE_OK)
+            return ret;
+        out[(*parsed)++] = e;
+        ljson_parse_whitespace(&c);
+        if (c.json == c.end)
+            return LJSON_PARSE_OK;
+        if (*c.json != ',')
+            return LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+        c.json++;
+        ljson_parse_whitespace(&c);
+    }
+}
+
+ParallelParser::ParallelParser(unsigned threads) : mstop(false), marena(nullptr), mnext(0), mdone(0) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    marenas.resize(threads);
+    for (unsigned i = 1; i < threads; i++)
+        mworkers.emplace_back(&ParallelParser::work, this, i);
+}
+
+ParallelParser::~ParallelParser() {
+    {
+        std::lock_guard<std::mutex> lock(mmutex);
+        mstop = true;
+    }
+    mwake.notify_all();
+    for (auto iter = mworkers.begin(); iter != mworkers.end(); iter++)
+        iter->join();
+}
+
+void ParallelParser::work(unsigned worker) {
+    std::unique_lock<std::mutex> lock(mmutex);
+    for (;;) {
+        mwake.wait(lock, [this]() { return mstop || mnext < mparts.size(); });
+        if (mstop)
+            return;
+        parse_parts(worker, lock);
+    }
+}
+
+void ParallelParser::parse_parts(unsigned worker, std::unique_lock<std::mutex> & lock) {
+    while (mnext < mparts.size()) {
+        Part & part = mparts[mnext++];
+        ljson_arena* arena = marena != nullptr ? &marenas[worker] : nullptr;
+        lock.unlock();
+        part.result = ljson_parse_elements(part.begin, part.end, mparts.size() == 1, part.out, part.count, &part.parsed, arena);
+        lock.lock();
+        if (++mdone == mparts.size())
+            mready.notify_one();
+    }
+}
+
+int ParallelParser::Parse(ljson_value* v, const char* json, size_t len, ljson_arena* arena) {
+    return parse(v, json, len, arena, GetThreads());
+}
+
+int ParallelParser::parse(ljson_value* v, const char* json, size_t len, ljson_arena* arena, unsigned threads) {
+    assert(v != nullptr && (json != nullptr || len == 0));
+    /* a part below 64 KiB is not worth a thread */
+    size_t pieces = std::min<size_t>(std::min(threads, GetThreads()), len / (64 * 1024));
+    size_t begin = ljson_skip_whitespace(json, json + len) - json;
+    std::vector<size_t> cuts, counts;
+    size_t root_end;
+    if (pieces <= 1 || begin == len || json[begin] != '['
+        || !ljson_split_array(json, len, begin, pieces, cuts, counts, &root_end) || json[root_end] != ']'
+        || ljson_skip_whitespace(json + root_end + 1, json + len) != json + len)
+        return ljson_parse(v, json, len, arena);
+
+    /* the splitter counted the elements, so they are parsed straight into the result */
+    size_t total = 0;
+    for (size_t i = 0; i < counts.size(); i++)
+        total += counts[i];
+    ljson_value result;
+    result.data.marray = ljson_create<ljson_array>(arena, total, ljson_value(), ljson_allocator<ljson_value>(arena));
+    result.type = LJSON_ARRAY;
+    result.flags = arena != nullptr ? LJSON_FLAG_ARENA : 0;
+
+    bool ok = true;
+    {
+        std::unique_lock<std::mutex> lock(mmutex);
+        mparts.resize(counts.size());
+        ljson_value* out = result.data.marray->data();
+        for (size_t i = 0; i < mparts.size(); i++) {
+            mparts[i].begin = json + (i == 0 ? begin : cuts[i - 1]) + 1;
+            mparts[i].end = json + (i + 1 < mparts.size() ? cuts[i] : root_end);
+            mparts[i].out = out;
+            mparts[i].count = counts[i];
+            out += counts[i];
+        }
+        marena = arena;
+        mnext = mdone = 0;
+        mwake.notify_all();
+        parse_parts(0, lock);
+        mready.wait(lock, [this]() { return mdone == mparts.size(); });
+        for (size_t i = 0; i < mparts.size(); i++)
+            ok = ok && mparts[i].result == LJSON_PARSE_OK && (mparts[i].parsed == mparts[i].count || mparts.size() == 1);
+        if (ok && mparts.size() == 1)
+            result.data.marray->resize(mparts[0].parsed);   /* an empty array */
+        mparts.clear();
+        marena = nullptr;
+    }
+    if (!ok) {
+        /* parse again on one thread for the same error as ljson_parse */
+        ljson_free(&result);
+        for (size_t i = 0; i < marenas.size(); i++)
+            marenas[i].reset();
+        return ljson_parse(v, json, len, arena);
+    }
+    /* the values of the workers now live as long as arena */
+    if (arena != nullptr) {
+        for (size_t i = 0; i < marenas.size(); i++)
+            arena->splice(marenas[i]);
+        bool tree = true;
+        for (size_t i = 0; tree && i < result.data.marray->size(); i++)
+            tree = ljson_owns_nothing(&(*result.data.marray)[i]);
+        if (tree)
+            result.flags |= LJSON_FLAG_ARENA_TREE;
+    }
+    ljson_init(v);
+    v->swap(result);
+    return LJSON_PARSE_OK;
+}
+
+int ljson_parse_parallel(ljson_value* v, const char* json, size_t len, unsigned threads, ljson_arena* arena) {
+    assert(v != nullptr && (json != nullptr || len == 0));
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    if (std::min<size_t>(threads, len / (64 * 1024)) <= 1)
+        return ljson_parse(v, json, len, arena);
+    static ParallelParser shared;
+    static std::mutex busy;
+    std::unique_lock<std::mutex> lock(busy, std::try_to_lock);
+    if (!lock.owns_lock())
+        return ljson_parse(v, json, len, arena);
+    return shared.parse(v, json, len, arena, threads);
+}
+
+int ljson_parse(ljson_value* v, const char* json, ljson_arena* arena) {
+    assert(json != nullptr);
+    return ljson_parse(v, json, strlen(json), arena);
+}
+
+int ljson_parse(ljson_value* v, const char* json, size_t len, ljson_arena* arena) {
+    assert(v != nullptr);
+    ljson_init(v);
+    ljson_dom_handler h(v, arena);
+    return ljson_parse_sax(h, json, len);
+}
+
+int ljson_parse(ljson_value* v, const char* json, size_t len, ljson_arena* arena, ljson_parse_buffers* buffers, KeyPool* pool) {
+    ljson_context c;
+    int ret;
+    assert(v != nullptr && buffers != nullptr && (json != nullptr || len == 0));
+    ljson_init(v);
+    ljson_dom_handler h(v, arena, buffers, pool);
+    c.json = json;
+    c.end = json + len;
+    c.insitu = false;
+    c.max_depth = buffers->max_depth;
+    c.scratch.swap(buffers->scratch);
+    c.frames.swap(buffers->frames);
+    ret = ljson_parse_root(&c, h);
+    c.scratch.swap(buffers->scratch);
+    c.frames.swap(buffers->frames);
+    return ret;
+}
+
+int ljson_parse(ljson_value* v, const std::string & json, ljson_arena* arena) {
+    return ljson_parse(v, json.data(), json.size(), arena);
+}
+
+#ifdef LJSON_HAS_STRING_VIEW
+int ljson_parse(ljson_value* v, std::string_view json, ljson_arena* arena) {
+    return ljson_parse(v, json.data(), json.size(), arena);
+}
+#endif
+
+int ljson_parse_insitu(ljson_value* v, char* buf, size_t len, ljson_arena* arena, ljson_parse_buffers* buffers, KeyPool* pool) {
+    assert(v != nullptr);
+    ljson_init(v);
+    ljson_dom_handler h(v, arena, buffers, pool);
+    if (buffers == nullptr)
+        return ljson_parse_sax_insitu(h, buf, len);
+    ljson_context c;
+    int ret;
+    assert(buf != nullptr || len == 0);
+    c.json = buf;
+    c.end = buf + len;
+    c.insitu = true;
+    c.max_depth = buffers->max_depth;
+    c.frames.swap(buffers->frames);
+    ret = ljson_parse_root(&c, h);
+    c.frames.swap(buffers->frames);
+    return ret;
+}
+
+int ljson_parse_file(ljson_value* v, const char* path, ljson_arena* arena) {
+    assert(v != nullptr && path != nullptr);
+    ljson_mapped_file file;
+    ljson_init(v);
+    if (!file.open(path))
+        return LJSON_PARSE_FILE_ERROR;
+    return ljson_parse(v, file.data(), file.size(), arena);
+}
+
+/* the bytes which may go on a number or a literal */
+inline bool ljson_is_bare_char(char ch) {
+    return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')
+        || ch == '.' || ch == '+' || ch == '-';
+}
+
+/* the end of the pending token in [p, end), or nullptr if it goes on after end */
+template <typename Handler>
+const char* StreamParser<Handler>::scan_token(const char* p, const char* end) {
+    if (mtoken_kind == TOKEN_BARE) {
+        while (p < end && ljson_is_bare_char(*p))
+            p++;
+        return p < end ? p : nullptr;
+    }
+    while (p < end) {
+        if (mescape) {
+            mescape = false;
+            p++;
+            continue;
+        }
+        p = ljson_scan_string(p, end);
+        if (p == end)
+            break;
+        char ch = *p++;
+        if (ch == '\\')
+            mescape = true;
+        else if (ch == '\"')
+            return p;
+    }
+    return nullptr;
+}
+
+template <typename Handler>
+void StreamParser<Handler>::end_value() {
+    if (mstack.empty()) {
+        mstate = STATE_DONE;
+        mresult = LJSON_PARSE_OK;
+    } else {
+        mcounts.back()++;
+        mstate = STATE_AFTER_VALUE;
+    }
+}
+
+/* [begin, end) is a whole token, with the grammar of the token left to the parser */
+template <typename Handler>
+int StreamParser<Handler>::emit_token(const char* begin, const char* end) {
+    ljson_context c;
+    int ret;
+    c.json = begin;
+    c.end = end;
+    c.insitu = false;
+    c.scratch.swap(mscratch);
+    if (mtoken_kind == TOKEN_KEY) {
+        const char* key;
+        size_t len;
+        bool copy;
+        if ((ret = ljson_parse_string_token(&c, &key, &len, &copy,
+                [this](size_t size) { return mhandler.Reserve(size, true); })) == LJSON_PARSE_OK)
+            ret = ljson_event(mhandler.Key(key, len, copy));
+        mstate = STATE_COLON;
+    } else {
+        if ((ret = ljson_parse_value(&c, mhandler)) == LJSON_PARSE_OK)
+            end_value();
+    }
+    c.scratch.swap(mscratch);
+    mtoken_kind = TOKEN_NONE;
+    mtoken.clear();
+    if (ret != LJSON_PARSE_OK)
+        return fail(ret);
+    /* "1x" or "truex": the rest of a bare token can not follow a value */
+    if (c.json != end)
+        return fail(mstate == STATE_DONE ? LJSON_PARSE_ROOT_NOT_SINGULAR
+            : mstack.back() == '[' ? LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+    return LJSON_PARSE_OK;
+}
+
+template <typename Handler>
+int StreamParser<Handler>::Feed(const char* data, size_t len) {
+    const char* p = data;
+    const char* end = data + len;
+    if (mresult != LJSON_PARSE_INCOMPLETE && mresult != LJSON_PARSE_OK)
+        return mresult;
+    if (mtoken_kind != TOKEN_NONE) {
+        const char* e = scan_token(p, end);
+        if (e == nullptr) {
+            mtoken.append(p, end);
+            return mresult;
+        }
+        mtoken.append(p, e);
+        if (emit_token(mtoken.data(), mtoken.data() + mtoken.size()) != LJSON_PARSE_OK)
+            return mresult;
+        p = e;
+    }
+    for (;;) {
+        p = ljson_skip_whitespace(p, end);
+        if (p == end)
+            return mresult;
+        char ch = *p;
+        switch (mstate) {
+            case STATE_DONE:
+                return fail(LJSON_PARSE_ROOT_NOT_SINGULAR);
+            case STATE_COLON:
+                if (ch != ':')
+                    return fail(LJSON_PARSE_MISS_COLON);
+                p++;
+                mstate = STATE_VALUE;
+                continue;
+            case STATE_AFTER_VALUE:
+                if (ch == ',') {
+                    p++;
+                    mstate = mstack.back() == '[' ? STATE_VALUE : STATE_KEY;
+                    continue;
+                }
+                if (ch != (mstack.back() == '[' ? ']' : '}'))
+                    return fail(mstack.back() == '[' ? LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET
+                        : LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+                break;
+            case STATE_ARRAY_FIRST:
+                if (ch == ']')
+                    break;
+                mstate = STATE_VALUE;
+                continue;
+            case STATE_OBJECT_FIRST:
+                if (ch == '}')
+                    break;
+                mstate = STATE_KEY;
+                continue;
+            case STATE_KEY:
+                if (ch != '\"')
+                    return fail(LJSON_PARSE_MISS_KEY);
+                mtoken_kind = TOKEN_KEY;
+                break;
+            default:
+                assert(mstate == STATE_VALUE);
+                if (ch == '[' || ch == '{') {
+                    if (mstack.size() >= mmax_depth)
+                        return fail(LJSON_PARSE_DEPTH_EXCEEDED);
+                    if (!(ch == '[' ? mhandler.StartArray() : mhandler.StartObject()))
+                        return fail(LJSON_PARSE_TERMINATED);
+                    mstack.push_back(ch);
+                    mcounts.push_back(0);
+                    mstate = ch == '[' ? STATE_ARRAY_FIRST : STATE_OBJECT_FIRST;
+                    p++;
+                    continue;
+                }
+                mtoken_kind = ch == '\"' ? TOKEN_STRING : TOKEN_BARE;
+                break;
+        }
+        if (mtoken_kind == TOKEN_NONE) {
+            /* the end of a container */
+            bool ok = mstack.back() == '[' ? mhandler.EndArray(mcounts.back()) : mhandler.EndObject(mcounts.back());
+            if (!ok)
+                return fail(LJSON_PARSE_TERMINATED);
+            mstack.pop_back();
+            mcounts.pop_back();
+            end_value();
+            p++;
+            continue;
+        }
+        /* a token, the first byte is always a part of it */
+        mescape = false;
+        const char* e = scan_token(p + 1, end);
+        if (e == nullptr) {
+            mtoken.assign(p, end);
+            return mresult;
+        }
+        if (emit_token(p, e) != LJSON_PARSE_OK)
+            return mresult;
+        p = e;
+    }
+}
+
+template <typename Handler>
+int StreamParser<Handler>::Finish() {
+    if (mresult != LJSON_PARSE_INCOMPLETE && mresult != LJSON_PARSE_OK)
+        return mresult;
+    /* a bare token ends here, a string misses its closing quotation mark */
+    if (mtoken_kind != TOKEN_NONE && emit_token(mtoken.data(), mtoken.data() + mtoken.size()) != LJSON_PARSE_OK)
+        return mresult;
+    switch (mstate) {
+        case STATE_DONE:
+            return mresult;
+        case STATE_OBJECT_FIRST:
+        case STATE_KEY:
+            return fail(LJSON_PARSE_MISS_KEY);
+        case STATE_COLON:
+            return fail(LJSON_PARSE_MISS_COLON);
+        case STATE_AFTER_VALUE:
+            return fail(mstack.back() == '[' ? LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET
+                : LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+        default:
+            return fail(LJSON_PARSE_EXPECT_VALUE);
+    }
+}
+
+/* skip a key and its colon, the cursor is left on the value */
+static int ljson_skip_string(ljson_context* c);
+static int ljson_skip_key(ljson_context* c) {
+    int ret;
+    if (ljson_peek(c->json, c->end) != '\"')
+        return LJSON_PARSE_MISS_KEY;
+    if ((ret = ljson_skip_string(c)) != LJSON_PARSE_OK)
+        return ret;
+    ljson_parse_whitespace(c);
+    if (ljson_peek(c->json, c->end) != ':')
+        return LJSON_PARSE_MISS_COLON;
+    c->json++;
+    ljson_parse_whitespace(c);
+    return LJSON_PARSE_OK;
+}
+
+/* check a number as ljson_parse_number does and skip it */
+static int ljson_skip_number(ljson_context* c) {
+    const char* p = c->json;
+    if (ljson_peek(p, c->end) == '-') p++;
+    const char* int_begin = p;
+    if (ljson_peek(p, c->end) == '0') p++;
+    else {
+        if (!isdigit1to9(ljson_peek(p, c->end))) return LJSON_PARSE_INVALID_VALUE;
+        while (ljson_is_digit(ljson_peek(p, c->end))) p++;
+    }
+    /* below 10^308 a number can not overflow, the others are parsed to know */
+    bool large = p - int_begin > 308;
+    if (ljson_peek(p, c->end) == '.') {
+        p++;
+        if (!ljson_is_digit(ljson_peek(p, c->end))) return LJSON_PARSE_INVALID_VALUE;
+        while (ljson_is_digit(ljson_peek(p, c->end))) p++;
+    }
+    if (ljson_peek(p, c->end) == 'e' || ljson_peek(p, c->end) == 'E') {
+        large = true;
+        p++;
+        if (ljson_peek(p, c->end) == '+' || ljson_peek(p, c->end) == '-') p++;
+        if (!ljson_is_digit(ljson_peek(p, c->end))) return LJSON_PARSE_INVALID_VALUE;
+        while (ljson_is_digit(ljson_peek(p, c->end))) p++;
+    }
+    if (large) {
+        ljson_value n;
+        return ljson_parse_number(c, &n);
+    }
+    c->json = p;
+    return LJSON_PARSE_OK;
+}
+
+/* skip a string, the escapes are checked as ljson_parse_escape does and are not kept */
+static int ljson_skip_string(ljson_context* c) {
+    int ret;
+    char out[4];
+    size_t n;
+    expect_char(c, '\"');
+    const char* p = c->json;
+    for (;;) {
+        p = ljson_scan_string(p, c->end);
+        if (p == c->end)
+            return LJSON_PARSE_MISS_QUOTATION_MARK;
+        char ch = *p++;
+        if (ch == '\"') {
+            c->json = p;
+            return LJSON_PARSE_OK;
+        }
+        if (ch != '\\')
+            return LJSON_PARSE_INVALID_STRING_CHAR;
+        if ((ret = ljson_parse_escape(&p, c->end, out, &n)) != LJSON_PARSE_OK)
+            return ret;
+    }
+}
+
+/* the containers of a skipped value are not recorded */
+struct ljson_skip_nothing {
+    void open(const char*) { }
+    void next() { }
+    void close(const char*) { }
+};
+
+/*
+ * check the grammar of the next value and skip it, nothing is decoded. Whether each open container
+ * is an object is a bit of kinds, the levels past LJSON_MAX_DEPTH go on c->frames, so a skip within
+ * the default depth does not allocate. The recorder sees each container open at its bracket, each
+ * of its members or elements begin and the container close after its bracket
+ */
+template <typename Recorder>
+static int ljson_skip_value(ljson_context* c, Recorder & recorder) {
+    int ret;
+    uint64_t kinds[LJSON_MAX_DEPTH / 64];
+    size_t depth = 0, base = c->frames.size();
+    for (;;) {
+        char ch = ljson_peek(c->json, c->end);
+        switch (ch) {
+            case 'n':  ret = ljson_parse_literal(c, "null");  break;
+            case 't':  ret = ljson_parse_literal(c, "true");  break;
+            case 'f':  ret = ljson_parse_literal(c, "false"); break;
+            case '\"': ret = ljson_skip_string(c); break;
+            case '\0': ret = LJSON_PARSE_EXPECT_VALUE; break;
+            case '[':
+            case '{':
+                ret = LJSON_PARSE_OK;
+                if (depth >= c->max_depth) {
+                    ret = LJSON_PARSE_DEPTH_EXCEEDED;
+                    break;
+                }
+                recorder.open(c->json++);
+                ljson_parse_whitespace(c);
+                if (ljson_peek(c->json, c->end) == (ch == '[' ? ']' : '}')) {
+                    recorder.close(++c->json);
+                    break;
+                }
+                recorder.next();
+                if (depth < LJSON_MAX_DEPTH) {
+                    uint64_t bit = (uint64_t)1 << (depth % 64);
+                    kinds[depth / 64] = ch == '{' ? kinds[depth / 64] | bit : kinds[depth / 64] & ~bit;
+                } else
+                    c->frames.push_back(ch == '{');
+                depth++;
+                if (ch == '{')
+                    ret = ljson_skip_key(c);
+                if (ret == LJSON_PARSE_OK)
+                    continue;
+                break;
+            default:   ret = ljson_skip_number(c); break;
+        }
+        /* a value is done, close the containers which end after it */
+        while (ret == LJSON_PARSE_OK && depth != 0) {
+            size_t top = depth - 1;
+            bool object = top < LJSON_MAX_DEPTH ? (kinds[top / 64] >> (top % 64)) & 1 : c->frames.back() != 0;
+            ljson_parse_whitespace(c);
+            ch = ljson_peek(c->json, c->end);
+            if (ch == ',') {
+                c->json++;
+                recorder.next();
+                ljson_parse_whitespace(c);
+                if (object)
+                    ret = ljson_skip_key(c);
+                break;
+            }
+            if (ch != (object ? '}' : ']'))
+                ret = object ? LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            else {
+                recorder.close(++c->json);
+                if (top >= LJSON_MAX_DEPTH)
+                    c->frames.pop_back();
+                depth--;
+            }
+        }
+        if (ret != LJSON_PARSE_OK) {
+            c->frames.resize(base);
+            return ret;
+        }
+        if (depth == 0)
+            return LJSON_PARSE_OK;
+    }
+}
+
+static int ljson_skip_value(ljson_context* c) {
+    ljson_skip_nothing nothing;
+    return ljson_skip_value(c, nothing);
+}
+
+/* decode the string at the cursor and move after it, an escaped one goes to mscratch */
+int Reader::read_string(const char** str, size_t* len) {
+    int ret;
+    bool copy;
+    ljson_context c;
+    c.json = mjson;
+    c.end = mend;
+    c.insitu = false;
+    c.scratch.swap(mscratch);
+    ret = ljson_parse_string_token(&c, str, len, &copy);
+    bool escaped = ret == LJSON_PARSE_OK && *str == c.scratch.data();
+    c.scratch.swap(mscratch);
+    if (ret != LJSON_PARSE_OK)
+        return ret;
+    /* the swap may move a short string */
+    if (escaped)
+        *str = mscratch.data();
+    mjson = c.json;
+    return ret;
+}
+
+/* the next value, after skipping the one before it if it is not read, or nullptr */
+const char* Reader::next_value() {
+    if (mstate != LJSON_PARSE_OK)
+        return nullptr;
+    assert(mpending);
+    mjson = ljson_skip_whitespace(mjson, mend);
+    if (mjson == mend) {
+        fail(LJSON_PARSE_EXPECT_VALUE);
+        return nullptr;
+    }
+    return mjson;
+}
+
+/* move to the next member or element of the container closed by close */
+bool Reader::next_member(char close) {
+    int ret;
+    if (mstate != LJSON_PARSE_OK)
+        return false;
+    ljson_context c;
+    c.json = mjson;
+    c.end = mend;
+    c.insitu = false;
+    if (mpending && (ret = ljson_skip_value(&c)) != LJSON_PARSE_OK)
+        return fail(ret);
+    ljson_parse_whitespace(&c);
+    char ch = ljson_peek(c.json, c.end);
+    if (ch == close) {
+        mjson = c.json + 1;
+        mfirst = mpending = false;
+        return false;
+    }
+    if (!mfirst) {
+        if (ch != ',')
+            return fail(close == ']' ? LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET);
+        c.json++;
+        ljson_parse_whitespace(&c);
+    }
+    mjson = c.json;
+    mfirst = false;
+    mpending = true;
+    return true;
+}
+
+bool Reader::Peek(ljson_type* type) {
+    assert(type != nullptr);
+    const char* p = next_value();
+    if (p == nullptr)
+        return false;
+    switch (*p) {
+        case 'n': *type = LJSON_NULL; return true;
+        case 't': *type = LJSON_TRUE; return true;
+        case 'f': *type = LJSON_FALSE; return true;
+        case '\"': *type = LJSON_STRING; return true;
+        case '[': *type = LJSON_ARRAY; return true;
+        case '{': *type = LJSON_OBJECT; return true;
+        default:
+            if (*p != '-' && !ljson_is_digit(*p))
+                return fail(LJSON_PARSE_INVALID_VALUE);
+            *type = LJSON_NUMBER;
+            return true;
+    }
+}
+
+bool Reader::EnterObject() {
+    const char* p = next_value();
+    if (p == nullptr || *p != '{')
+        return false;
+    mjson = p + 1;
+    mfirst = true;
+    mpending = false;
+    return true;
+}
+
+bool Reader::NextKey(const char** key, size_t* len) {
+    int ret;
+    if (!next_member('}'))
+        return false;
+    if (ljson_peek(mjson, mend) != '\"')
+        return fail(LJSON_PARSE_MISS_KEY);
+    if ((ret = read_string(key, len)) != LJSON_PARSE_OK)
+        return fail(ret);
+    mjson = ljson_skip_whitespace(mjson, mend);
+    if (ljson_peek(mjson, mend) != ':')
+        return fail(LJSON_PARSE_MISS_COLON);
+    mjson++;
+    return true;
+}
+
+bool Reader::NextKey(std::string & key) {
+    const char* str;
+    size_t len;
+    if (!NextKey(&str, &len))
+        return false;
+    key.assign(str, len);
+    return true;
+}
+
+bool Reader::FindKey(const std::string & key) {
+    const char* str;
+    size_t len;
+    while (NextKey(&str, &len))
+        if (len == key.size() && memcmp(str, key.data(), len) == 0)
+            return true;
+    return false;
+}
+
+bool Reader::EnterArray() {
+    const char* p = next_value();
+    if (p == nullptr || *p != '[')
+        return false;
+    mjson = p + 1;
+    mfirst = true;
+    mpending = false;
+    return true;
+}
+
+bool Reader::NextElement() {
+    return next_member(']');
+}
+
+bool Reader::SkipValue() {
+    int ret;
+    if (next_value() == nullptr)
+        return false;
+    ljson_context c;
+    c.json = mjson;
+    c.end = mend;
+    c.insitu = false;
+    if ((ret = ljson_skip_value(&c)) != LJSON_PARSE_OK)
+        return fail(ret);
+    mjson = c.json;
+    mpending = false;
+    return true;
+}
+
+bool Reader::GetNull() {
+    ljson_type type;
+    if (!Peek(&type) || type != LJSON_NULL)
+        return false;
+    return SkipValue();
+}
+
+bool Reader::GetBool(bool* b) {
+    ljson_type type = Peek();
+    if (type != LJSON_TRUE && type != LJSON_FALSE)
+        return false;
+    *b = type == LJSON_TRUE;
+    return SkipValue();
+}
+
+bool Reader::GetNumber(double* d) {
+    int ret;
+    if (Peek() != LJSON_NUMBER)
+        return false;
+    ljson_context c;
+    ljson_value n;
+    c.json = mjson;
+    c.end = mend;
+    c.insitu = false;
+    ljson_init(&n);
+    if ((ret = ljson_parse_number(&c, &n)) != LJSON_PARSE_OK)
+        return fail(ret);
+    if (n.flags & LJSON_FLAG_INT64)
+        *d = (double)n.data.mint64;
+    else if (n.flags & LJSON_FLAG_UINT64)
+        *d = (double)n.data.muint64;
+    else
+        *d = n.data.mdouble;
+    mjson = c.json;
+    mpending = false;
+    return true;
+}
+
+bool Reader::GetInt64(int64_t* i) {
+    int ret;
+    if (Peek() != LJSON_NUMBER)
+        return false;
+    ljson_context c;
+    ljson_value n;
+    c.json = mjson;
+    c.end = mend;
+    c.insitu = false;
+    ljson_init(&n);
+    if ((ret = ljson_parse_number(&c, &n)) != LJSON_PARSE_OK)
+        return fail(ret);
+    if (!(n.flags & LJSON_FLAG_INT64))
+        return false;
+    *i = n.data.mint64;
+    mjson = c.json;
+    mpending = false;
+    return true;
+}
+
+bool Reader::GetString(const char** str, size_t* len) {
+    int ret;
+    if (Peek() != LJSON_STRING)
+        return false;
+    if ((ret = read_string(str, len)) != LJSON_PARSE_OK)
+        return fail(ret);
+    mpending = false;
+    return true;
+}
+
+bool Reader::GetString(std::string & str) {
+    const char* s;
+    size_t len;
+    if (!GetString(&s, &len))
+        return false;
+    str.assign(s, len);
+    return true;
+}
+
+int Reader::Finish() {
+    if (mstate != LJSON_PARSE_OK)
+        return mstate;
+    if (mpending && !SkipValue())
+        return mstate;
+    mjson = ljson_skip_whitespace(mjson, mend);
+    if (mjson != mend)
+        mstate = LJSON_PARSE_ROOT_NOT_SINGULAR;
+    return mstate;
+}
+
+NdjsonReader::NdjsonReader(unsigned threads, bool ordered)
+    : mordered(ordered), mstop(false), mpool(nullptr), mmax_depth(LJSON_MAX_DEPTH), mtask(nullptr), mnext(0), mcount(0) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    mbuffers.resize(threads);
+    for (unsigned i = 0; i < threads; i++)
+        mworkers.emplace_back(&NdjsonReader::work, this, i);
+}
+
+NdjsonReader::~NdjsonReader() {
+    {
+        std::lock_guard<std::mutex> lock(mmutex);
+        mstop = true;
+    }
+    mwake.notify_all();
+    for (auto iter = mworkers.begin(); iter != mworkers.end(); iter++)
+        iter->join();
+}
+
+void NdjsonReader::work(unsigned worker) {
+    std::unique_lock<std::mutex> lock(mmutex);
+    for (;;) {
+        mwake.wait(lock, [this]() { return mstop || (mnext < mcount && !mfree.empty()); });
+        if (mstop)
+            return;
+        size_t batch = mnext++;
+        size_t slot = mfree.back();
+        mfree.pop_back();
+        mslot_of[batch] = slot;
+        const Task* task = mtask;
+        lock.unlock();
+        (*task)(worker, batch, slot);
+        lock.lock();
+        mdone[batch] = 1;
+        mfinished.push_back(batch);
+        mready.notify_one();
+    }
+}
+
+/* batches of about 32 KiB, so that a worker takes the lock rarely and the values wait little */
+void NdjsonReader::split_lines(const char* json, size_t len) {
+    const size_t batch_bytes = 32 * 1024, batch_lines = 1024;
+    const char* end = json + len;
+    size_t number = 0, bytes = 0;
+    assert(json != nullptr || len == 0);
+    mlines.clear();
+    mbatches.assign(1, 0);
+    for (const char* p = json; p < end; ) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (eol == nullptr)
+            eol = end;
+        number++;
+        if (ljson_skip_whitespace(p, eol) != eol) {
+            mlines.push_back(Line{ p, eol, number });
+            bytes += eol - p;
+            if (bytes >= batch_bytes || mlines.size() - mbatches.back() >= batch_lines) {
+                mbatches.push_back(mlines.size());
+                bytes = 0;
+            }
+        }
+        p = eol + 1;
+    }
+    if (mlines.size() != mbatches.back())
+        mbatches.push_back(mlines.size());
+}
+
+size_t NdjsonReader::run(const Task & task, const std::function<size_t(size_t batch, size_t slot)> & deliver) {
+    size_t count = mbatches.size() - 1, errors = 0;
+    std::unique_lock<std::mutex> lock(mmutex);
+    mtask = &task;
+    mnext = 0;
+    mcount = count;
+    mdone.assign(count, 0);
+    mslot_of.assign(count, 0);
+    mfinished.clear();
+    mfree.clear();
+    for (size_t i = slots(); i > 0; i--)
+        mfree.push_back(i - 1);
+    mwake.notify_all();
+    for (size_t i = 0; i < count; i++) {
+        size_t batch = i;
+        if (mordered) {
+            mready.wait(lock, [this, i]() { return mdone[i] != 0; });
+        } else {
+            mready.wait(lock, [this, i]() { return mfinished.size() > i; });
+            batch = mfinished[i];
+        }
+        size_t slot = mslot_of[batch];
+        lock.unlock();
+        errors += deliver(batch, slot);
+        lock.lock();
+        /* the slot is empty again, a worker may take the next batch */
+        mfree.push_back(slot);
+        mwake.notify_one();
+    }
+    mtask = nullptr;
+    mcount = 0;
+    return errors;
+}
+
+size_t NdjsonReader::Parse(const char* json, size_t len, const Callback & callback) {
+    split_lines(json, len);
+    std::vector<std::vector<std::pair<int, ljson_value> > > results(slots());
+    Task task = [&](unsigned worker, size_t batch, size_t slot) {
+        /* the lines of a batch share one context and handler on the buffers of the worker */
+        ljson_parse_buffers & buffers = mbuffers[worker];
+        ljson_context c;
+        std::vector<std::pair<int, ljson_value> > & out = results[slot];
+        c.max_depth = mmax_depth;
+        c.scratch.swap(buffers.scratch);
+        c.frames.swap(buffers.frames);
+        {
+            ljson_dom_handler h(nullptr, nullptr, &buffers, mpool);
+            out.resize(mbatches[batch + 1] - mbatches[batch]);
+            for (size_t i = 0; i < out.size(); i++) {
+                const Line & line = mlines[mbatches[batch] + i];
+                ljson_init(&out[i].second);
+                h.Reset(&out[i].second);
+                out[i].first = ljson_parse_line(&c, line.begin, line.end, h);
+            }
+        }
+        c.scratch.swap(buffers.scratch);
+        c.frames.swap(buffers.frames);
+    };
+    return run(task, [&](size_t batch, size_t slot) {
+        size_t errors = 0;
+        std::vector<std::pair<int, ljson_value> > & out = results[slot];
+        for (size_t i = 0; i < out.size(); i++) {
+            if (out[i].first != LJSON_PARSE_OK)
+                errors++;
+            callback(mlines[mbatches[batch] + i].number, out[i].first, &out[i].second);
+            ljson_free(&out[i].second);
+        }
+        std::vector<std::pair<int, ljson_value> >().swap(out);
+        return errors;
+    });
+}
+
+size_t NdjsonReader::Parse(const std::string & json, const Callback & callback) {
+    return Parse(json.data(), json.size(), callback);
+}
+
+size_t NdjsonReader::ParseFile(const char* path, const Callback & callback) {
+    assert(path != nullptr);
+    ljson_mapped_file file;
+    if (!file.open(path)) {
+        ljson_value v;
+        callback(0, LJSON_PARSE_FILE_ERROR, &v);
+        return 1;
+    }
+    return Parse(file.data(), file.size(), callback);
+}
+
+template <typename Handler>
+size_t NdjsonReader::ParseSax(const char* json, size_t len, std::vector<Handler> & handlers, const StateCallback & callback) {
+    assert(handlers.size() >= mworkers.size());
+    split_lines(json, len);
+    std::vector<std::vector<int> > states(slots());
+    Task task = [&](unsigned worker, size_t batch, size_t slot) {
+        ljson_parse_buffers & buffers = mbuffers[worker];
+        ljson_context c;
+        c.max_depth = mmax_depth;
+        c.scratch.swap(buffers.scratch);
+        c.frames.swap(buffers.frames);
+        for (size_t i = mbatches[batch]; i < mbatches[batch + 1]; i++)
+            states[slot].push_back(ljson_parse_line(&c, mlines[i].begin, mlines[i].end, handlers[worker]));
+        c.scratch.swap(buffers.scratch);
+        c.frames.swap(buffers.frames);
+    };
+    return run(task, [&](size_t batch, size_t slot) {
+        size_t errors = 0;
+        for (size_t i = 0; i < states[slot].size(); i++) {
+            if (states[slot][i] != LJSON_PARSE_OK)
+                errors++;
+            if (callback)
+                callback(mlines[mbatches[batch] + i].number, states[slot][i]);
+        }
+        states[slot].clear();
+        return errors;
+    });
+}
+
+template <typename Handler>
+size_t NdjsonReader::ParseSaxFile(const char* path, std::vector<Handler> & handlers, const StateCallback & callback) {
+    assert(path != nullptr);
+    ljson_mapped_file file;
+    if (!file.open(path)) {
+        if (callback)
+            callback(0, LJSON_PARSE_FILE_ERROR);
+        return 1;
+    }
+    return ParseSax(file.data(), file.size(), handlers, callback);
+}
+
+/*
+ * the record of the check of ljson_parse_lazy in its arena: the containers of the json in pre-order,
+ * so the containers in one of them follow it and the next one at its level is containers entries on
+ */
+struct ljson_lazy_table {
+    struct Entry {
+        const char* begin;      /* the bracket */
+        const char* end;        /* after the closing bracket */
+        size_t count;           /* the members or elements */
+        size_t containers;      /* the entries of the container and the ones in it */
+    };
+    ljson_arena* arena;         /* the expansions allocate there */
+    const Entry* entries;
+};
+
+/* ljson_skip_value records the containers of the check of ljson_parse_lazy */
+struct ljson_lazy_recorder {
+    void open(const char* begin) {
+        mopen.push_back(mentries.size());
+        mentries.push_back(ljson_lazy_table::Entry{begin, nullptr, 0, 0});
+    }
+    void next() { mentries[mopen.back()].count++; }
+    void close(const char* end) {
+        ljson_lazy_table::Entry & e = mentries[mopen.back()];
+        e.end = end;
+        e.containers = mentries.size() - mopen.back();
+        mopen.pop_back();
+    }
+
+    std::vector<ljson_lazy_table::Entry> mentries;
+    std::vector<size_t> mopen;      /* the entries of the open containers */
+};
+
+/*
+ * a container becomes a lazy entry of the table, the next one of which is *next, and the cursor
+ * jumps after it. A scalar is decoded by h into the arena of the table
+ */
+static int ljson_parse_lazy_value(ljson_context* c, const ljson_lazy_table* table, size_t* next,
+                                  ljson_value* v, ljson_dom_handler & h) {
+    char ch = ljson_peek(c->json, c->end);
+    h.Reset(v);
+    if (ch != '[' && ch != '{')
+        return ljson_parse_scalar(c, h);
+    size_t index = *next;
+    const ljson_lazy_table::Entry & e = table->entries[index];
+    assert(e.begin == c->json);
+    *next += e.containers;
+    if (index > UINT32_MAX)
+        return ljson_parse_value(c, h);     /* too far for mlazy, decode it now */
+    c->json = e.end;
+    v->data.mlazy.table = table;
+    v->data.mlazy.index = uint32_t(index);
+    v->type = ch == '[' ? LJSON_ARRAY : LJSON_OBJECT;
+    v->flags = LJSON_FLAG_LAZY;
+    return LJSON_PARSE_OK;
+}
+
+int ljson_parse_lazy(ljson_value* v, const char* json, size_t len, ljson_arena* arena) {
+    ljson_context c;
+    int ret;
+    assert(v != nullptr && (json != nullptr || len == 0) && arena != nullptr);
+    ljson_init(v);
+    c.json = json;
+    c.end = json + len;
+    c.insitu = false;
+    /* check the whole json first, with the errors of ljson_parse */
+    ljson_lazy_recorder recorder;
+    ljson_parse_whitespace(&c);
+    if ((ret = ljson_skip_value(&c, recorder)) != LJSON_PARSE_OK)
+        return ret;
+    ljson_parse_whitespace(&c);
+    if (c.json != c.end)
+        return LJSON_PARSE_ROOT_NOT_SINGULAR;
+    size_t count = recorder.mentries.size();
+    ljson_lazy_table::Entry* entries = static_cast<ljson_lazy_table::Entry*>(
+        arena->allocate(count * sizeof(ljson_lazy_table::Entry), alignof(ljson_lazy_table::Entry)));
+    std::copy(recorder.mentries.begin(), recorder.mentries.end(), entries);
+    ljson_lazy_table* table = ljson_create<ljson_lazy_table>(arena);
+    table->arena = arena;
+    table->entries = entries;
+    c.json = ljson_skip_whitespace(json, c.end);
+    size_t next = 0;
+    ljson_dom_handler h(nullptr, arena);
+    return ljson_parse_lazy_value(&c, table, &next, v, h);
+}
+
+/* the flags of a node which another thread may be expanding, see ljson_expand */
+inline unsigned char ljson_load_flags(const ljson_value* v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(&v->flags, __ATOMIC_ACQUIRE);
+#else
+    unsigned char flags = *static_cast<const volatile unsigned char*>(&v->flags);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return flags;
+#endif
+}
+
+inline void ljson_store_flags(ljson_value* v, unsigned char flags) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&v->flags, flags, __ATOMIC_RELEASE);
+#else
+    std::atomic_thread_fence(std::memory_order_release);
+    *static_cast<volatile unsigned char*>(&v->flags) = flags;
+#endif
+}
+
+/*
+ * the children of v may be changed through what the caller gets, so ljson_free must walk v again.
+ * Several readers may call it at once, see ljson_expand
+ */
+inline void ljson_touch(const ljson_value* v) {
+    if (!(ljson_load_flags(v) & LJSON_FLAG_ARENA_TREE))
+        return;
+    unsigned char* flags = &const_cast<ljson_value*>(v)->flags;
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_fetch_and(flags, (unsigned char)~LJSON_FLAG_ARENA_TREE, __ATOMIC_RELAXED);
+#else
+    *static_cast<volatile unsigned char*>(flags) &= (unsigned char)~LJSON_FLAG_ARENA_TREE;
+#endif
+}
+
+/*
+ * the lazy nodes and the lazy trees share a few locks by their address, an expansion is short.
+ * The nodes and the tables have locks of their own, a node is locked first
+ */
+template <typename T>
+static std::mutex & ljson_expand_lock(const T* p) {
+    static std::mutex locks[64];
+    return locks[(reinterpret_cast<uintptr_t>(p) / sizeof(T)) % 64];
+}
+
+int ljson_expand(const ljson_value* cv) {
+    assert(cv != nullptr);
+    if (!(ljson_load_flags(cv) & LJSON_FLAG_LAZY))
+        return LJSON_PARSE_OK;
+    /* the data of cv becomes the container while its flags still say lazy, it is read under the lock */
+    std::lock_guard<std::mutex> node_lock(ljson_expand_lock(cv));
+    if (!(ljson_load_flags(cv) & LJSON_FLAG_LAZY))
+        return LJSON_PARSE_OK;  /* another thread was first */
+    ljson_value* v = const_cast<ljson_value*>(cv);
+    const ljson_lazy_table* table = v->data.mlazy.table;
+    /* the expansions of a tree share its arena, so they take turns */
+    std::lock_guard<std::mutex> tree_lock(ljson_expand_lock(table));
+    ljson_arena* arena = table->arena;
+    size_t index = v->data.mlazy.index, next = index + 1;
+    const ljson_lazy_table::Entry & e = table->entries[index];
+    ljson_context c;
+    int ret = LJSON_PARSE_OK;
+    c.json = e.begin + 1;
+    c.end = e.end - 1;
+    c.insitu = false;
+    ljson_dom_handler h(nullptr, arena);
+    bool tree = true;
+    if (v->type == LJSON_ARRAY) {
+        ljson_array* a = ljson_create<ljson_array>(arena, ljson_allocator<ljson_value>(arena));
+        a->reserve(e.count);
+        for (size_t i = 0; i < e.count; i++) {
+            c.json = ljson_skip_whitespace(c.json + (i != 0), c.end);   /* ',' */
+            a->emplace_back();
+            ret = ljson_parse_lazy_value(&c, table, &next, &a->back(), h);
+            tree = tree && ljson_owns_nothing(&a->back());
+            if (ret != LJSON_PARSE_OK)
+                break;
+            c.json = ljson_skip_whitespace(c.json, c.end);
+        }
+        v->data.marray = a;
+    } else {
+        ljson_map* m = ljson_create<ljson_map>(arena, ljson_allocator<ljson_map::value_type>(arena));
+        m->reserve(e.count);
+        for (size_t i = 0; i < e.count; i++) {
+            const char* key;
+            size_t len = 0;
+            bool copy = false;
+            c.json = ljson_skip_whitespace(c.json + (i != 0), c.end);   /* ',' */
+            /* a long key goes to the arena, an escaped one is decoded there */
+            ret = ljson_parse_string_token(&c, &key, &len, &copy, [arena](size_t size) {
+                return size > ljson_key::SHORT_MAX ? static_cast<char*>(arena->allocate(size + 1, 1)) : nullptr;
+            });
+            if (ret != LJSON_PARSE_OK)
+                break;
+            if (copy && len > ljson_key::SHORT_MAX) {
+                char* s = static_cast<char*>(arena->allocate(len + 1, 1));
+                memcpy(s, key, len);
+                s[len] = '\0';
+                key = s;
+            }
+            auto result = m->emplace(ljson_key::slice(key, len), ljson_value());
+            ljson_value & member = result.first->second;
+            if (!result.second) {
+                /* the last one of the duplicated keys wins */
+                ljson_free(&member);
+                ljson_init(&member);
+            }
+            c.json = ljson_skip_whitespace(ljson_skip_whitespace(c.json, c.end) + 1, c.end);   /* ':' */
+            ret = ljson_parse_lazy_value(&c, table, &next, &member, h);
+            tree = tree && ljson_owns_nothing(&member);
+            if (ret != LJSON_PARSE_OK)
+                break;
+            c.json = ljson_skip_whitespace(c.json, c.end);
+        }
+        v->data.mobject = m;
+    }
+    /* the range passed the check of ljson_parse_lazy, a failure keeps the members before it */
+    assert(ret != LJSON_PARSE_OK || next == index + e.containers);
+    ljson_store_flags(v, LJSON_FLAG_ARENA | (tree ? LJSON_FLAG_ARENA_TREE : 0));
+    return ret;
+}
+
+static void ljson_stringify_string(std::string & str, const char* json_str, size_t len) {
+    static const char hex_digits[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+    str += '"';
+    for (const char* iter = json_str; iter != json_str + len; iter++) {
+        unsigned char ch = (unsigned char)(*iter);
+        switch (ch) {
+            case '\"': str += "\\\""; break;
+            case '\\': str += "\\\\"; break;
+            case '\b': str += "\\b";  break;
+            case '\f': str += "\\f";  break;
+            case '\n': str += "\\n";  break;
+            case '\r': str += "\\r";  break;
+            case '\t': str += "\\t";  break;
+            default:
+                if (ch < 0x20) {
+                    str += "\\u00";
+                    str += hex_digits[ch >> 4];
+                    str += hex_digits[ch & 15];
+                } else {
+                    str += *iter;
+                }
+        }
+    }
+    str += '"';
+}
+
+static const char ljson_digits_lut[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* write the decimal digits of value to buffer, return the end of them */
+static char* ljson_u64toa(uint64_t value, char* buffer) {
+    char temp[20];
+    char* p = temp;
+    while (value >= 100) {
+        unsigned i = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *p++ = ljson_digits_lut[i + 1];
+        *p++ = ljson_digits_lut[i];
+    }
+    if (value < 10)
+        *p++ = char('0' + value);
+    else {
+        unsigned i = (unsigned)value * 2;
+        *p++ = ljson_digits_lut[i + 1];
+        *p++ = ljson_digits_lut[i];
+    }
+    while (p != temp)
+        *buffer++ = *--p;
+    return buffer;
+}
+
+static char* ljson_i64toa(int64_t value, char* buffer) {
+    uint64_t u = (uint64_t)value;
+    if (value < 0) {
+        *buffer++ = '-';
+        u = 0 - u;
+    }
+    return ljson_u64toa(u, buffer);
+}
+
+/* a do-it-yourself floating point f * 2^e, for the double formatting */
+typedef struct {
+    uint64_t f;
+    int e;
+} ljson_diyfp;
+
+static ljson_diyfp ljson_diyfp_make(uint64_t f, int e) {
+    ljson_diyfp r;
+    r.f = f;
+    r.e = e;
+    return r;
+}
+
+/* the product rounded to 64 bits */
+static ljson_diyfp ljson_diyfp_mul(ljson_diyfp a, ljson_diyfp b) {
+    uint64_t hi, lo;
+    ljson_mul128(a.f, b.f, &hi, &lo);
+    if (lo & (uint64_t(1) << 63))
+        hi++;
+    return ljson_diyfp_make(hi, a.e + b.e + 64);
+}
+
+static ljson_diyfp ljson_diyfp_normalize(ljson_diyfp a) {
+    unsigned s = ljson_clz64(a.f);
+    return ljson_diyfp_make(a.f << s, a.e - (int)s);
+}
+
+/* normalized 10^(-348 + 8 * i) */
+static const uint64_t ljson_cached_powers_f[] = {
+    0xFA8FD5A0081C0288ULL, 0xBAAEE17FA23EBF76ULL, 0x8B16FB203055AC76ULL,
+    0xCF42894A5DCE35EAULL, 0x9A6BB0AA55653B2DULL, 0xE61ACF033D1A45DFULL,
+    0xAB70FE17C79AC6CAULL, 0xFF77B1FCBEBCDC4FULL, 0xBE5691EF416BD60CULL,
+    0x8DD01FAD907FFC3CULL, 0xD3515C2831559A83ULL, 0x9D71AC8FADA6C9B5ULL,
+    0xEA9C227723EE8BCBULL, 0xAECC49914078536DULL, 0x823C12795DB6CE57ULL,
+    0xC21094364DFB5637ULL, 0x9096EA6F3848984FULL, 0xD77485CB25823AC7ULL,
+    0xA086CFCD97BF97F4ULL, 0xEF340A98172AACE5ULL, 0xB23867FB2A35B28EULL,
+    0x84C8D4DFD2C63F3BULL, 0xC5DD44271AD3CDBAULL, 0x936B9FCEBB25C996ULL,
+    0xDBAC6C247D62A584ULL, 0xA3AB66580D5FDAF6ULL, 0xF3E2F893DEC3F126ULL,
+    0xB5B5ADA8AAFF80B8ULL, 0x87625F056C7C4A8BULL, 0xC9BCFF6034C13053ULL,
+    0x964E858C91BA2655ULL, 0xDFF9772470297EBDULL, 0xA6DFBD9FB8E5B88FULL,
+    0xF8A95FCF88747D94ULL, 0xB94470938FA89BCFULL, 0x8A08F0F8BF0F156BULL,
+    0xCDB02555653131B6ULL, 0x993FE2C6D07B7FACULL, 0xE45C10C42A2B3B06ULL,
+    0xAA242499697392D3ULL, 0xFD87B5F28300CA0EULL, 0xBCE5086492111AEBULL,
+    0x8CBCCC096F5088CCULL, 0xD1B71758E219652CULL, 0x9C40000000000000ULL,
+    0xE8D4A51000000000ULL, 0xAD78EBC5AC620000ULL, 0x813F3978F8940984ULL,
+    0xC097CE7BC90715B3ULL, 0x8F7E32CE7BEA5C70ULL, 0xD5D238A4ABE98068ULL,
+    0x9F4F2726179A2245ULL, 0xED63A231D4C4FB27ULL, 0xB0DE65388CC8ADA8ULL,
+    0x83C7088E1AAB65DBULL, 0xC45D1DF942711D9AULL, 0x924D692CA61BE758ULL,
+    0xDA01EE641A708DEAULL, 0xA26DA3999AEF774AULL, 0xF209787BB47D6B85ULL,
+    0xB454E4A179DD1877ULL, 0x865B86925B9BC5C2ULL, 0xC83553C5C8965D3DULL,
+    0x952AB45CFA97A0B3ULL, 0xDE469FBD99A05FE3ULL, 0xA59BC234DB398C25ULL,
+    0xF6C69A72A3989F5CULL, 0xB7DCBF5354E9BECEULL, 0x88FCF317F22241E2ULL,
+    0xCC20CE9BD35C78A5ULL, 0x98165AF37B2153DFULL, 0xE2A0B5DC971F303AULL,
+    0xA8D9D1535CE3B396ULL, 0xFB9B7CD9A4A7443CULL, 0xBB764C4CA7A44410ULL,
+    0x8BAB8EEFB6409C1AULL, 0xD01FEF10A657842CULL, 0x9B10A4E5E9913129ULL,
+    0xE7109BFBA19C0C9DULL, 0xAC2820D9623BF429ULL, 0x80444B5E7AA7CF85ULL,
+    0xBF21E44003ACDD2DULL, 0x8E679C2F5E44FF8FULL, 0xD433179D9C8CB841ULL,
+    0x9E19DB92B4E31BA9ULL, 0xEB96BF6EBADF77D9ULL, 0xAF87023B9BF0EE6BULL
+};
+static const int16_t ljson_cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066
+};
+
+/* the cached power c_mk = 10^-K such that the product with 2^e is in a good range for the digit generation */
+static ljson_diyfp ljson_cached_power(int e, int* K) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    if (dk - k > 0.0)
+        k++;
+    unsigned index = (unsigned)((k >> 3) + 1);
+    *K = -(-348 + (int)(index << 3));
+    return ljson_diyfp_make(ljson_cached_powers_f[index], ljson_cached_powers_e[index]);
+}
+
+static void ljson_grisu_round(char* buffer, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static int ljson_count_digits32(uint32_t n) {
+    if (n < 10) return 1;
+    if (n < 100) return 2;
+    if (n < 1000) return 3;
+    if (n < 10000) return 4;
+    if (n < 100000) return 5;
+    if (n < 1000000) return 6;
+    if (n < 10000000) return 7;
+    if (n < 100000000) return 8;
+    if (n < 1000000000) return 9;
+    return 10;
 }
 
-static int ljson_parse_array(ljson_context* c, ljson_value* v) {
-    expect_char(c, '[');
-    int ret;
-    std::vector<ljson_value> vec;
-    ljson_parse_whitespace(c);
-    if (*c->json == ']') {
-        c->json++;
-        v->type = LJSON_ARRAY;
-        v->data.marray = new std::vector<ljson_value>;
-        return LJSON_PARSE_OK;
+static void ljson_grisu_digit_gen(ljson_diyfp W, ljson_diyfp Mp, uint64_t delta, char* buffer, int* len, int* K) {
+    static const uint32_t pow10_32[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    static const uint64_t pow10_64[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+        1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+        1000000000000000000ULL, 10000000000000000000ULL
+    };
+    const ljson_diyfp one = ljson_diyfp_make(uint64_t(1) << -Mp.e, Mp.e);
+    const uint64_t wp_w = Mp.f - W.f;
+    uint32_t p1 = (uint32_t)(Mp.f >> -one.e);
+    uint64_t p2 = Mp.f & (one.f - 1);
+    int kappa = ljson_count_digits32(p1);
+    *len = 0;
+
+    while (kappa > 0) {
+        uint32_t d = p1 / pow10_32[kappa - 1];
+        p1 %= pow10_32[kappa - 1];
+        if (d || *len)
+            buffer[(*len)++] = char('0' + d);
+        kappa--;
+        uint64_t tmp = (uint64_t(p1) << -one.e) + p2;
+        if (tmp <= delta) {
+            *K += kappa;
+            ljson_grisu_round(buffer, *len, delta, tmp, uint64_t(pow10_32[kappa]) << -one.e, wp_w);
+            return;
+        }
     }
-    
+
     for (;;) {
-        ljson_value e;
-        ljson_init(&e);
-        if ((ret = ljson_parse_value(c, &e)) != LJSON_PARSE_OK)
-            break;
-        vec.push_back(e);
-        ljson_parse_whitespace(c);
-        if (*c->json == ',') {
-            c->json++;
-            ljson_parse_whitespace(c);
+        p2 *= 10;
+        delta *= 10;
+        char d = char(p2 >> -one.e);
+        if (d || *len)
+            buffer[(*len)++] = char('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            *K += kappa;
+            int index = -kappa;
+            ljson_grisu_round(buffer, *len, delta, p2, one.f, wp_w * (index < 20 ? pow10_64[index] : 0));
+            return;
         }
-        else if (*c->json == ']') {
-            c->json++;
-            setArray(v, vec, 0);
-            return LJSON_PARSE_OK;
-        } 
-        else{
-            ret = LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
-            break;
-        } 
     }
-    for (auto iter = vec.begin(); iter != vec.end(); iter++)
-            ljson_free(&(*iter));
-    return ret;
 }
 
-static int ljson_parse_object(ljson_context* c, ljson_value* v ) {
-    expect_char(c, '{');
-    int ret;
-    std::map<std::string, ljson_value> m_map;
-    ljson_parse_whitespace(c);
-    if (*c->json == '}') {
-        c->json++;
-        v->type = LJSON_OBJECT;
-        v->data.mobject = new std::map<std::string, ljson_value>;
-        return LJSON_PARSE_OK;
+/* Grisu2: the shortest digits of a positive finite value which read back to it, value = digits * 10^K */
+static void ljson_grisu2(double value, char* buffer, int* len, int* K) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased_e = (int)((bits >> 52) & 0x7FF);
+    uint64_t significand = bits & 0x000FFFFFFFFFFFFFULL;
+    ljson_diyfp v = biased_e != 0
+        ? ljson_diyfp_make(significand | (uint64_t(1) << 52), biased_e - 1075)
+        : ljson_diyfp_make(significand, -1074);
+
+    /* the boundaries m+ and m- with the same exponent */
+    ljson_diyfp w_p = ljson_diyfp_make((v.f << 1) + 1, v.e - 1);
+    while (!(w_p.f & (uint64_t(1) << 53))) {
+        w_p.f <<= 1;
+        w_p.e--;
     }
-    for (;;) {
-        ljson_member m;
-        ljson_init(&m.value);
-        if (*c->json != '"') {
-            ret = LJSON_PARSE_MISS_KEY;
-            break;
-        }
-        if ((ret = ljson_parse_string_raw(c, m.key) != LJSON_PARSE_OK))
-            break;
-        ljson_parse_whitespace(c);
-        if (*c->json != ':') {
-            ret = LJSON_PARSE_MISS_COLON;
-            break;
-        }
-        c->json++;
-        ljson_parse_whitespace(c);
-        if ((ret = ljson_parse_value(c, &m.value)) != LJSON_PARSE_OK)
-            break;
-        m_map[m.key] = m.value;
+    w_p.f <<= 10;
+    w_p.e -= 10;
+    ljson_diyfp w_m = v.f == (uint64_t(1) << 52)
+        ? ljson_diyfp_make((v.f << 2) - 1, v.e - 2)
+        : ljson_diyfp_make((v.f << 1) - 1, v.e - 1);
+    w_m.f <<= w_m.e - w_p.e;
+    w_m.e = w_p.e;
 
-        ljson_parse_whitespace(c);
-        if (*c->json == ',') {
-            c->json++;
-            ljson_parse_whitespace(c);
-        } else if (*c->json == '}') {
-            c->json++;
-            setObject(v, m_map, 0);
-            return LJSON_PARSE_OK;
-        } else {
-            ret = LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
-            break;
+    const ljson_diyfp c_mk = ljson_cached_power(w_p.e, K);
+    const ljson_diyfp W = ljson_diyfp_mul(ljson_diyfp_normalize(v), c_mk);
+    ljson_diyfp Wp = ljson_diyfp_mul(w_p, c_mk);
+    ljson_diyfp Wm = ljson_diyfp_mul(w_m, c_mk);
+    Wm.f++;
+    Wp.f--;
+    ljson_grisu_digit_gen(W, Wp, Wp.f - Wm.f, buffer, len, K);
+}
+
+static char* ljson_write_exponent(int K, char* buffer) {
+    if (K < 0) {
+        *buffer++ = '-';
+        K = -K;
+    }
+    if (K >= 100) {
+        *buffer++ = char('0' + K / 100);
+        K %= 100;
+        *buffer++ = ljson_digits_lut[K * 2];
+        *buffer++ = ljson_digits_lut[K * 2 + 1];
+    } else if (K >= 10) {
+        *buffer++ = ljson_digits_lut[K * 2];
+        *buffer++ = ljson_digits_lut[K * 2 + 1];
+    } else
+        *buffer++ = char('0' + K);
+    return buffer;
+}
+
+/* lay out digits * 10^k as a json number, keep at most max_decimal_places digits after the point */
+static char* ljson_prettify(char* buffer, int length, int k, int max_decimal_places) {
+    const int kk = length + k;     /* 10^(kk - 1) <= v < 10^kk */
+
+    if (0 <= k && kk <= 21) {
+        /* 1234e7 -> 12340000000 */
+        for (int i = length; i < kk; i++)
+            buffer[i] = '0';
+        return &buffer[kk];
+    }
+    if (0 < kk && kk <= 21) {
+        /* 1234e-2 -> 12.34 */
+        memmove(&buffer[kk + 1], &buffer[kk], length - kk);
+        buffer[kk] = '.';
+        if (0 > k + max_decimal_places) {
+            /* truncate, then remove the trailing zeros and a bare point */
+            for (int i = kk + max_decimal_places; i > kk; i--)
+                if (buffer[i] != '0')
+                    return &buffer[i + 1];
+            return &buffer[kk];
         }
+        return &buffer[length + 1];
+    }
+    if (-6 < kk && kk <= 0) {
+        /* 1234e-6 -> 0.001234 */
+        const int offset = 2 - kk;
+        memmove(&buffer[offset], &buffer[0], length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for (int i = 2; i < offset; i++)
+            buffer[i] = '0';
+        if (length - kk > max_decimal_places) {
+            for (int i = max_decimal_places + 1; i > 1; i--)
+                if (buffer[i] != '0')
+                    return &buffer[i + 1];
+            return &buffer[1];
+        }
+        return &buffer[length + offset];
+    }
+    if (kk < -max_decimal_places) {
+        /* truncated to zero */
+        buffer[0] = '0';
+        return &buffer[1];
+    }
+    if (length == 1) {
+        /* 1e30 */
+        buffer[1] = 'e';
+        return ljson_write_exponent(kk - 1, &buffer[2]);
+    }
+    /* 1234e30 -> 1.234e33 */
+    memmove(&buffer[2], &buffer[1], length - 1);
+    buffer[1] = '.';
+    buffer[length + 1] = 'e';
+    return ljson_write_exponent(kk - 1, &buffer[length + 2]);
+}
 
+/* write a finite double to buffer (at least 32 bytes), return the end of it */
+static char* ljson_dtoa(double value, char* buffer, int max_decimal_places) {
+    if (value == 0) {
+        if (std::signbit(value))
+            *buffer++ = '-';
+        buffer[0] = '0';
+        return &buffer[1];
     }
-    for (auto iter = m_map.begin(); iter != m_map.end(); iter++)
-        ljson_free(&(*iter).second);
-    v->type = LJSON_NULL;
-    return ret;
+    if (value < 0) {
+        *buffer++ = '-';
+        value = -value;
+    }
+    int length, K;
+    ljson_grisu2(value, buffer, &length, &K);
+    return ljson_prettify(buffer, length, K, max_decimal_places);
 }
 
-static int ljson_parse_value(ljson_context* c, ljson_value* v) {
-    switch (*c->json) {
-        case 'n':  return ljson_parse_literal(c, v, "null", LJSON_NULL);
-        case 't':  return ljson_parse_literal(c, v, "true", LJSON_TRUE);
-        case 'f':  return ljson_parse_literal(c, v, "false", LJSON_FALSE);
-        case '\"': return ljson_parse_string(c, v);
-        case '[':  return ljson_parse_array(c, v);
-        case '{':  return ljson_parse_object(c, v);
-        case '\0': return LJSON_PARSE_EXPECT_VALUE;
-        default:   return ljson_parse_number(c, v);
+static int ljson_stringify_value(const ljson_value* v, std::string & str, int max_decimal_places) {
+    struct Frame { const ljson_value* v; size_t next; };
+    ljson_walk_stack<Frame> stack;
+    for (;;) {
+        switch (v->type) {
+            case LJSON_NULL:    str += "null";  break;
+            case LJSON_FALSE:   str += "false"; break;
+            case LJSON_TRUE:    str += "true";   break;
+            case LJSON_NUMBER: {
+                /* format right at the end of the output */
+                size_t pos = str.size();
+                str.resize(pos + 32);
+                char* buffer = &str[pos];
+                char* end;
+                if (v->flags & LJSON_FLAG_INT64)
+                    end = ljson_i64toa(v->data.mint64, buffer);
+                else if (v->flags & LJSON_FLAG_UINT64)
+                    end = ljson_u64toa(v->data.muint64, buffer);
+                else if (std::isfinite(v->data.mdouble))
+                    end = ljson_dtoa(v->data.mdouble, buffer, max_decimal_places);
+                else {
+                    /* NaN and infinity are not json numbers */
+                    memcpy(buffer, "null", 4);
+                    end = buffer + 4;
+                }
+                str.resize(end - str.data());
+                break;
+            }
+            case LJSON_STRING: 
+                ljson_stringify_string(str, ljson_string_data(v), ljson_string_size(v));
+                break;
+            case LJSON_ARRAY:
+            case LJSON_OBJECT:
+                ljson_expand(v);
+                str += v->type == LJSON_ARRAY ? '[' : '{';
+                stack.push(Frame{v, 0});
+                break;
+            default:
+                break;
+        }
+        /* the next element or member, after closing the containers which are done */
+        v = nullptr;
+        while (!stack.empty()) {
+            Frame & f = stack.top();
+            bool object = f.v->type == LJSON_OBJECT;
+            if (f.next < ljson_child_count(f.v)) {
+                if (f.next != 0)
+                    str += ',';
+                if (object) {
+                    const ljson_key & key = (f.v->data.mobject->begin() + f.next)->first;
+                    ljson_stringify_string(str, key.data(), key.size());
+                    str += ':';
+                }
+                v = ljson_child(f.v, f.next++);
+                break;
+            }
+            str += object ? '}' : ']';
+            stack.pop();
+        }
+        if (v == nullptr)
+            return LJSON_STRINGIFY_OK;
     }
 }
 
-int ljson_parse(ljson_value* v, const char* json) {
-    ljson_context c;
+int ljson_stringify(const ljson_value* v, std::string & json, int max_decimal_places) {
     int ret;
     assert(v != nullptr);
-    c.json = json;
-    v->type = LJSON_NULL;
-    ljson_parse_whitespace(&c);
-
-    if ((ret = ljson_parse_value(&c, v)) == LJSON_PARSE_OK) {
-        ljson_parse_whitespace(&c);
-        if (*c.json != '\0')
-            ret = LJSON_PARSE_ROOT_NOT_SINGULAR;
+    assert(max_decimal_places >= 1);
+    if ((ret = ljson_stringify_value(v, json, max_decimal_places)) != LJSON_STRINGIFY_OK) {
+        json = "";
+        return ret;
     }
-    return ret;
+    return LJSON_STRINGIFY_OK;
 }
 
-int ljson_parse(ljson_value* v, const std::string & json) {
-    return ljson_parse(v, json.c_str());
+int ljson_stringify(const ljson_value* v, char* json) {
+    std::string str(json);
+    return ljson_stringify(v, str);
 }
 
-static void ljson_stringify_string(std::string & str, const std::string & json_str) {
-    static const char hex_digits[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-    str += '"';
-    for (auto iter = json_str.begin(); iter != json_str.end(); iter++) {
-        unsigned char ch = (unsigned char)(*iter);
-        switch (ch) {
-            case '\"': str += "\\\""; break;
-            case '\\': str += "\\\\"; break;
-            case '\b': str += "\\b";  break;
-            case '\f': str += "\\f";  break;
-            case '\n': str += "\\n";  break;
-            case '\r': str += "\\r";  break;
-            case '\t': str += "\\t";  break;
-            default:
-                if (ch < 0x20) {
-                    str += "\\u00";
-                    str += hex_digits[ch >> 4];
-                    str += hex_digits[ch & 15];
-                } else {
-                    str += *iter;
-                }
+/* builds the tree of ljson_parse_compact, the open containers keep their nodes on one stack */
+class ljson_compact_handler : public ljson_base_handler<ljson_compact_handler> {
+public:
+    ljson_compact_handler(ljson_compact* root, ljson_arena* arena)
+        : mroot(root), marena(arena), mdepth(0), maddress_too_high(false) { }
+
+    bool Null() { return push(ljson_compact::from_tag(ljson_compact::TAG_NULL)); }
+    bool Bool(bool b) { return push(ljson_compact::from_tag(b ? ljson_compact::TAG_TRUE : ljson_compact::TAG_FALSE)); }
+    bool Number(double d) { return push(ljson_compact::from_double(d)); }
+    bool Int64(int64_t i) {
+        if (ljson_compact::fits_int(i))
+            return push(ljson_compact::from_int(i));
+        return big(uint64_t(i), false);
+    }
+    bool Uint64(uint64_t u) { return big(u, true); }
+    bool String(const char* str, size_t len, bool) { return string(str, len); }
+    bool Key(const char* str, size_t len, bool) { return string(str, len); }
+    bool StartObject() {
+        mdepth++;
+        return true;
+    }
+    bool EndObject(size_t count) { return container(ljson_compact::TAG_OBJECT, count, count * 2); }
+    bool StartArray() {
+        mdepth++;
+        return true;
+    }
+    bool EndArray(size_t count) { return container(ljson_compact::TAG_ARRAY, count, count); }
+
+    /*! \brief the parse stopped at a node the arena put beyond 48 bits */
+    bool address_too_high() const { return maddress_too_high; }
+
+private:
+    bool push(ljson_compact v) {
+        if (mdepth == 0)
+            *mroot = v;
+        else
+            mstack.push_back(v);
+        return true;
+    }
+    /* nullptr if the address does not fit the payload of a boxed pointer */
+    uint64_t* allocate(size_t words) {
+        uint64_t* p = static_cast<uint64_t*>(marena->allocate(words * sizeof(uint64_t), alignof(uint64_t)));
+        if ((reinterpret_cast<uintptr_t>(p) >> 48) != 0) {
+            maddress_too_high = true;
+            return nullptr;
         }
+        return p;
     }
-    str += '"';
+    bool big(uint64_t u, bool is_unsigned) {
+        uint64_t* p = allocate(1);
+        if (p == nullptr)
+            return false;
+        *p = u;
+        return push(ljson_compact::from_tag(ljson_compact::TAG_BIG, (uint64_t)reinterpret_cast<uintptr_t>(p) | (is_unsigned ? 1 : 0)));
+    }
+    bool string(const char* str, size_t len) {
+        uint64_t* p = allocate(1 + (len + sizeof(uint64_t)) / sizeof(uint64_t));
+        if (p == nullptr)
+            return false;
+        *p = len;
+        char* s = reinterpret_cast<char*>(p + 1);
+        memcpy(s, str, len);
+        s[len] = '\0';
+        return push(ljson_compact::from_pointer(ljson_compact::TAG_STRING, p));
+    }
+    /* the last nodes of the stack become the container of size members */
+    bool container(ljson_compact::tag_type tag, size_t size, size_t nodes) {
+        uint64_t* p = allocate(1 + nodes);
+        if (p == nullptr)
+            return false;
+        *p = size;
+        if (nodes != 0)
+            memcpy(p + 1, mstack.data() + mstack.size() - nodes, nodes * sizeof(ljson_compact));
+        mstack.resize(mstack.size() - nodes);
+        mdepth--;
+        return push(ljson_compact::from_pointer(tag, p));
+    }
+
+    ljson_compact* mroot;
+    ljson_arena* marena;
+    size_t mdepth;
+    std::vector<ljson_compact> mstack;
+    bool maddress_too_high;
+};
+
+int ljson_parse_compact(ljson_compact* v, const char* json, size_t len, ljson_arena* arena) {
+    assert(v != nullptr && arena != nullptr && (json != nullptr || len == 0));
+    *v = ljson_compact();
+    ljson_compact_handler h(v, arena);
+    int ret = ljson_parse_sax(h, json, len);
+    if (ret == LJSON_PARSE_TERMINATED && h.address_too_high())
+        ret = LJSON_PARSE_ADDRESS_TOO_HIGH;
+    if (ret != LJSON_PARSE_OK)
+        *v = ljson_compact();
+    return ret;
 }
 
-static int ljson_stringify_value(const ljson_value* v, std::string & str) {
-    switch (v->type) {
+int ljson_parse_compact(ljson_compact* v, const std::string & json, ljson_arena* arena) {
+    return ljson_parse_compact(v, json.data(), json.size(), arena);
+}
+
+static void ljson_stringify_compact(ljson_compact v, std::string & str, int max_decimal_places) {
+    const ljson_compact* nodes;
+    size_t size;
+    switch (getType(v)) {
         case LJSON_NULL:    str += "null";  break;
         case LJSON_FALSE:   str += "false"; break;
-        case LJSON_TRUE:    str += "true";   break;
-        case LJSON_NUMBER:
-            char buffer[32];
-            sprintf(buffer, "%.17g", v->data.mdouble);  
-            str += buffer;
+        case LJSON_TRUE:    str += "true";  break;
+        case LJSON_NUMBER: {
+            size_t pos = str.size();
+            str.resize(pos + 32);
+            char* buffer = &str[pos];
+            char* end;
+            if (!v.is_double() && v.tag() == ljson_compact::TAG_INT)
+                end = ljson_i64toa(v.as_int(), buffer);
+            else if (!v.is_double())
+                end = v.big_unsigned() ? ljson_u64toa(*v.as_pointer(), buffer) : ljson_i64toa((int64_t)*v.as_pointer(), buffer);
+            else if (std::isfinite(v.as_double()))
+                end = ljson_dtoa(v.as_double(), buffer, max_decimal_places);
+            else {
+                memcpy(buffer, "null", 4);
+                end = buffer + 4;
+            }
+            str.resize(end - str.data());
             break;
-        case LJSON_STRING: 
-            ljson_stringify_string(str, *(v->data.mstring)); 
+        }
+        case LJSON_STRING:
+            ljson_stringify_string(str, v.chars(), v.size());
             break;
         case LJSON_ARRAY:
+            nodes = v.nodes();
+            size = v.size();
             str += '[';
-            for (auto iter = v->data.marray->begin(); iter != v->data.marray->end(); iter++) {
-                if (iter != v->data.marray->begin())
+            for (size_t i = 0; i < size; i++) {
+                if (i != 0)
                     str += ',';
-                ljson_stringify_value(&(*iter), str);
+                ljson_stringify_compact(nodes[i], str, max_decimal_places);
             }
             str += ']';
             break;
         case LJSON_OBJECT:
+            nodes = v.nodes();
+            size = v.size();
             str += '{';
-            for (auto iter = v->data.mobject->begin(); iter != v->data.mobject->end(); iter++) {
-                if (iter != v->data.mobject->begin())
+            for (size_t i = 0; i < size; i++) {
+                if (i != 0)
                     str += ',';
-                ljson_stringify_string(str, (*iter).first);
+                ljson_stringify_string(str, nodes[2 * i].chars(), nodes[2 * i].size());
                 str += ':';
-                ljson_stringify_value(&(*iter).second, str);
+                ljson_stringify_compact(nodes[2 * i + 1], str, max_decimal_places);
             }
             str += '}';
             break;
         default:
             break;
     }
+}
+
+int ljson_stringify(ljson_compact v, std::string & json, int max_decimal_places) {
+    assert(max_decimal_places >= 1);
+    ljson_stringify_compact(v, json, max_decimal_places);
     return LJSON_STRINGIFY_OK;
 }
 
-int ljson_stringify(const ljson_value* v, std::string & json) {
-    int ret;
-    assert(v != nullptr);
-    if ((ret = ljson_stringify_value(v, json)) != LJSON_STRINGIFY_OK) {
-        json = "";
-        return ret;
+ljson_type getType(ljson_compact v) {
+    if (v.is_double())
+        return LJSON_NUMBER;
+    switch (v.tag()) {
+        case ljson_compact::TAG_NULL:   return LJSON_NULL;
+        case ljson_compact::TAG_FALSE:  return LJSON_FALSE;
+        case ljson_compact::TAG_TRUE:   return LJSON_TRUE;
+        case ljson_compact::TAG_STRING: return LJSON_STRING;
+        case ljson_compact::TAG_ARRAY:  return LJSON_ARRAY;
+        case ljson_compact::TAG_OBJECT: return LJSON_OBJECT;
+        default:                        return LJSON_NUMBER;
     }
-    return LJSON_STRINGIFY_OK;
 }
 
-int ljson_stringify(const ljson_value* v, char* json) {
-    std::string str(json);
-    return ljson_stringify(v, str);
+double getNumber(ljson_compact v) {
+    assert(getType(v) == LJSON_NUMBER);
+    if (v.is_double())
+        return v.as_double();
+    if (v.tag() == ljson_compact::TAG_INT)
+        return (double)v.as_int();
+    return v.big_unsigned() ? (double)*v.as_pointer() : (double)(int64_t)*v.as_pointer();
+}
+
+ljson_number_type getNumberType(ljson_compact v) {
+    assert(getType(v) == LJSON_NUMBER);
+    if (v.is_double())
+        return LJSON_NUMBER_DOUBLE;
+    return v.tag() == ljson_compact::TAG_BIG && v.big_unsigned() ? LJSON_NUMBER_UINT64 : LJSON_NUMBER_INT64;
+}
+
+int64_t getInt64(ljson_compact v) {
+    assert(getNumberType(v) == LJSON_NUMBER_INT64);
+    return v.tag() == ljson_compact::TAG_INT ? v.as_int() : (int64_t)*v.as_pointer();
+}
+
+uint64_t getUint64(ljson_compact v) {
+    assert(getNumberType(v) == LJSON_NUMBER_UINT64);
+    return *v.as_pointer();
+}
+
+bool getBool(ljson_compact v) {
+    assert(getType(v) == LJSON_TRUE || getType(v) == LJSON_FALSE);
+    return v.tag() == ljson_compact::TAG_TRUE;
+}
+
+std::string getString(ljson_compact v) {
+    assert(getType(v) == LJSON_STRING);
+    return std::string(v.chars(), v.size());
+}
+
+size_t getStringLength(ljson_compact v) {
+    assert(getType(v) == LJSON_STRING);
+    return v.size();
+}
+
+ljson_compact getArrayElement(ljson_compact v, const size_t index) {
+    assert(getType(v) == LJSON_ARRAY && index < v.size());
+    return v.nodes()[index];
+}
+
+size_t getArraySize(ljson_compact v) {
+    assert(getType(v) == LJSON_ARRAY);
+    return v.size();
+}
+
+/* the last member named key, nullptr if there is none */
+static const ljson_compact* ljson_compact_find(ljson_compact v, const std::string & key) {
+    assert(getType(v) == LJSON_OBJECT);
+    const ljson_compact* nodes = v.nodes();
+    for (size_t i = v.size(); i-- > 0; ) {
+        ljson_compact k = nodes[2 * i];
+        if (k.size() == key.size() && memcmp(k.chars(), key.data(), key.size()) == 0)
+            return &nodes[2 * i + 1];
+    }
+    return nullptr;
+}
+
+bool objectFindKey(ljson_compact v, const std::string & key) {
+    return ljson_compact_find(v, key) != nullptr;
+}
+
+ljson_compact getObjElement(ljson_compact v, const std::string & key) {
+    const ljson_compact* value = ljson_compact_find(v, key);
+    return value != nullptr ? *value : ljson_compact();
+}
+
+size_t getObjectSize(ljson_compact v) {
+    assert(getType(v) == LJSON_OBJECT);
+    return v.size();
+}
+
+void ljson_value::copyfrom(const ljson_value & copy) {
+    struct Frame { const ljson_value* from; ljson_value* to; size_t next; };
+    ljson_walk_stack<Frame> stack;
+    const ljson_value* from = &copy;
+    ljson_value* to = this;
+    free();
+    for (;;) {
+        ljson_expand(from);
+        switch (from->type) {
+            case LJSON_NUMBER:
+                to->data.muint64 = from->data.muint64;
+                to->flags = from->flags;
+                break;
+            case LJSON_STRING:
+                if (ljson_string_size(from) <= LJSON_SHORT_STRING_MAX)
+                    ljson_set_short(to, ljson_string_data(from), ljson_string_size(from));
+                else
+                    to->data.mstring = new std::string(ljson_string_data(from), ljson_string_size(from));
+                break;
+            case LJSON_ARRAY:
+                /* the children are added in place, so the storage is reserved at once */
+                to->data.marray = new ljson_array;
+                to->data.marray->reserve(from->data.marray->size());
+                stack.push(Frame{from, to, 0});
+                break;
+            case LJSON_OBJECT:
+                to->data.mobject = new ljson_map;
+                to->data.mobject->reserve(from->data.mobject->size());
+                stack.push(Frame{from, to, 0});
+                break;
+            default:
+                break;
+        }
+        to->type = from->type;
+        /* the next child to copy, the containers which are done are left */
+        from = nullptr;
+        while (!stack.empty()) {
+            Frame & f = stack.top();
+            if (f.next < ljson_child_count(f.from)) {
+                if (f.from->type == LJSON_ARRAY) {
+                    f.to->data.marray->emplace_back();
+                    to = &f.to->data.marray->back();
+                } else {
+                    /* a deep copy owns its keys, they do not point into the storage of the original */
+                    const ljson_key & key = (f.from->data.mobject->begin() + f.next)->first;
+                    to = &f.to->data.mobject->emplace(ljson_key(key.data(), key.size()), ljson_value()).first->second;
+                }
+                from = ljson_child(f.from, f.next++);
+                break;
+            }
+            stack.pop();
+        }
+        if (from == nullptr)
+            return;
+    }
 }
 
 void ljson_reset(ljson_value* v_old, const ljson_value & v_new) {
     v_old->copyfrom(v_new);
 }
+
+KeyPool::~KeyPool() {
+    for (auto & shard : mshards)
+        for (auto e : shard.slots)
+            delete e;
+}
+
+void KeyPool::add_slot(Shard & shard, Entry* e) {
+    size_t mask = shard.slots.size() - 1;
+    size_t i = (size_t)e->hash & mask;
+    while (shard.slots[i] != nullptr)
+        i = (i + 1) & mask;
+    shard.slots[i] = e;
+}
+
+const KeyPool::Entry* KeyPool::Intern(const char* key, size_t len) {
+    assert(key != nullptr || len == 0);
+    uint64_t hash = ljson_hash(key, len);
+    Shard & shard = mshards[hash >> (64 - SHARD_BITS)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!shard.slots.empty()) {
+        size_t mask = shard.slots.size() - 1;
+        for (size_t i = (size_t)hash & mask; shard.slots[i] != nullptr; i = (i + 1) & mask) {
+            Entry* e = shard.slots[i];
+            if (e->hash == hash && e->key.size() == len && memcmp(e->key.data(), key, len) == 0)
+                return e;
+        }
+    }
+    if (msize.fetch_add(1) >= mmax_keys) {
+        msize--;
+        return nullptr;
+    }
+    if ((shard.count + 1) * 2 > shard.slots.size()) {
+        std::vector<Entry*> old(std::max<size_t>(16, shard.slots.size() * 2), nullptr);
+        old.swap(shard.slots);
+        for (auto e : old)
+            if (e != nullptr)
+                add_slot(shard, e);
+    }
+    Entry* e = new Entry{hash, std::string(key, len)};
+    add_slot(shard, e);
+    shard.count++;
+    return e;
+}
+
+void ljson_index_objects(ljson_value* v) {
+    struct Frame { ljson_value* v; size_t next; };
+    ljson_walk_stack<Frame> stack;
+    assert(v != nullptr);
+    for (;;) {
+        if (!(v->flags & LJSON_FLAG_LAZY) && (v->type == LJSON_ARRAY || v->type == LJSON_OBJECT)) {
+            if (v->type == LJSON_OBJECT && !v->data.mobject->indexed())
+                v->data.mobject->index();
+            stack.push(Frame{v, 0});
+        }
+        v = nullptr;
+        while (!stack.empty()) {
+            Frame & f = stack.top();
+            if (f.next < ljson_child_count(f.v)) {
+                v = ljson_child(f.v, f.next++);
+                break;
+            }
+            stack.pop();
+        }
+        if (v == nullptr)
+            return;
+    }
+}
 void ljson_reset(ljson_value* v_old, const ljson_value * v_new) {
     ljson_reset(v_old, *v_new);
 }
@@ -719,10 +5921,58 @@ void setNumber(ljson_value & v, double n) { return setNumber(&v, n); }
 
 double getNumber(const ljson_value* v) {
     assert(v != nullptr && v->type == LJSON_NUMBER);
+    if (v->flags & LJSON_FLAG_INT64)
+        return (double)v->data.mint64;
+    if (v->flags & LJSON_FLAG_UINT64)
+        return (double)v->data.muint64;
     return v->data.mdouble;
 }
 double getNumber(const ljson_value & v) { return getNumber(&v); };
 
+ljson_number_type getNumberType(const ljson_value* v) {
+    assert(v != nullptr && v->type == LJSON_NUMBER);
+    if (v->flags & LJSON_FLAG_INT64)
+        return LJSON_NUMBER_INT64;
+    if (v->flags & LJSON_FLAG_UINT64)
+        return LJSON_NUMBER_UINT64;
+    return LJSON_NUMBER_DOUBLE;
+}
+ljson_number_type getNumberType(const ljson_value & v) { return getNumberType(&v); }
+
+void setInt64(ljson_value* v, int64_t n) {
+    ljson_free(v);
+    v->data.mint64 = n;
+    v->flags = LJSON_FLAG_INT64;
+    v->type = LJSON_NUMBER;
+}
+void setInt64(ljson_value & v, int64_t n) { setInt64(&v, n); }
+
+int64_t getInt64(const ljson_value* v) {
+    assert(v != nullptr && v->type == LJSON_NUMBER);
+    if (v->flags & LJSON_FLAG_INT64)
+        return v->data.mint64;
+    if (v->flags & LJSON_FLAG_UINT64)
+        return (int64_t)v->data.muint64;
+    return (int64_t)v->data.mdouble;
+}
+int64_t getInt64(const ljson_value & v) { return getInt64(&v); }
+
+void setUint64(ljson_value* v, uint64_t n) {
+    ljson_free(v);
+    v->data.muint64 = n;
+    v->flags = n <= uint64_t(INT64_MAX) ? LJSON_FLAG_INT64 : LJSON_FLAG_UINT64;
+    v->type = LJSON_NUMBER;
+}
+void setUint64(ljson_value & v, uint64_t n) { setUint64(&v, n); }
+
+uint64_t getUint64(const ljson_value* v) {
+    assert(v != nullptr && v->type == LJSON_NUMBER);
+    if (v->flags & (LJSON_FLAG_INT64 | LJSON_FLAG_UINT64))
+        return v->data.muint64;
+    return (uint64_t)v->data.mdouble;
+}
+uint64_t getUint64(const ljson_value & v) { return getUint64(&v); }
+
 void setBool(ljson_value* v, ljson_type b) {
     ljson_free(v);
     v->type = b;
@@ -744,6 +5994,10 @@ bool getBool(const ljson_value & v) { return getBool(&v); }
 void setString(ljson_value* v, const char* s, size_t len) {
     assert(v != nullptr && (s != nullptr || len == 0));
     ljson_free(v);
+    if (len <= LJSON_SHORT_STRING_MAX) {
+        ljson_set_short(v, s, len);
+        return;
+    }
     v->data.mstring = new std::string();
     v->data.mstring->assign(s, len);
     v->type = LJSON_STRING;
@@ -753,38 +6007,65 @@ void setString(ljson_value* v, const std::string & s) {
     assert(v != nullptr);
     assert(&s != v->data.mstring);
     ljson_free(v);
+    if (s.size() <= LJSON_SHORT_STRING_MAX) {
+        ljson_set_short(v, s.data(), s.size());
+        return;
+    }
     v->data.mstring = new std::string();
     v->data.mstring->assign(s);
     v->type = LJSON_STRING;
 }
 
-std::string & getString(const ljson_value* v) {
+std::string & getString(ljson_value* v) {
     assert(v != nullptr && v->type == LJSON_STRING);
+    if (v->flags & (LJSON_FLAG_SLICE | LJSON_FLAG_SHORT)) {
+        /* the caller wants a std::string, copy the chars out */
+        std::string* s = new std::string(ljson_string_data(v), ljson_string_size(v));
+        v->data.mstring = s;
+        v->flags &= ~(LJSON_FLAG_SLICE | LJSON_FLAG_SHORT);
+    }
     return *(v->data.mstring);
 }
 
+std::string getString(const ljson_value* v) {
+    assert(v != nullptr && v->type == LJSON_STRING);
+    return std::string(ljson_string_data(v), ljson_string_size(v));
+}
+
+const char* getStringData(const ljson_value* v) {
+    assert(v != nullptr && v->type == LJSON_STRING);
+    return ljson_string_data(v);
+}
+
 size_t getStringLength(const ljson_value* v){
     assert(v != nullptr && v->type == LJSON_STRING);
-    return v->data.mstring->length();
+    return ljson_string_size(v);
 }
 
 void setString(ljson_value & v, const char* s, size_t len) { setString(&v, s, len); }
 void setString(ljson_value & v, const std::string & s) { setString(&v, s); }
-std::string & getString(const ljson_value & v) { return getString(&v); }
+std::string & getString(ljson_value & v) { return getString(&v); }
+std::string getString(const ljson_value & v) { return getString(&v); }
+const char* getStringData(const ljson_value & v) { return getStringData(&v); }
 size_t getStringLength(const ljson_value& v) { return getStringLength(&v); };
 
+#ifdef LJSON_HAS_STRING_VIEW
+std::string_view getStringView(const ljson_value* v) { return std::string_view(getStringData(v), getStringLength(v)); }
+std::string_view getStringView(const ljson_value & v) { return getStringView(&v); }
+#endif
+
 
 
 void setArray(ljson_value* v, const std::vector<ljson_value> & vec, bool deep_copy) {
     assert(v != nullptr);
     ljson_free(v);
     if (!deep_copy) {
-        v->data.marray = new std::vector<ljson_value>;
+        v->data.marray = new ljson_array;
         v->data.marray->assign(vec.begin(), vec.end());
     }
     else {
         size_t sz = vec.size();
-        v->data.marray = new std::vector<ljson_value>(sz);
+        v->data.marray = new ljson_array(sz);
         for (size_t i = 0; i < sz; i++) {
             ljson_init(&(*v->data.marray)[i]);
             ljson_reset(&((*v->data.marray)[i]), vec[i]);
@@ -793,39 +6074,72 @@ void setArray(ljson_value* v, const std::vector<ljson_value> & vec, bool deep_co
     v->type = LJSON_ARRAY;
 } 
 
-std::vector<ljson_value> & getArray(const ljson_value* v) {
+void setArray(ljson_value* v, std::vector<ljson_value> && vec) {
+    assert(v != nullptr);
+    ljson_free(v);
+    v->data.marray = new ljson_array(std::make_move_iterator(vec.begin()), std::make_move_iterator(vec.end()));
+    v->type = LJSON_ARRAY;
+    vec.clear();
+}
+
+void setArray(ljson_value* v, ljson_array && vec) {
+    assert(v != nullptr);
+    ljson_free(v);
+    v->data.marray = new ljson_array(std::move(vec));
+    v->type = LJSON_ARRAY;
+}
+
+ljson_array & getArray(const ljson_value* v) {
     assert(v != nullptr && v->type == LJSON_ARRAY);
+    ljson_expand(v);
+    ljson_touch(v);
     return *(v->data.marray);
 }
 
 void setArrayElement(ljson_value* v, size_t index, const ljson_value & content) {
     assert(v != nullptr && v->type == LJSON_ARRAY);
+    ljson_expand(v);
+    ljson_touch(v);
     assert(index < v->data.marray->size());
     ljson_reset(&((*v->data.marray)[index]), content);
 }
 
+void setArrayElement(ljson_value* v, size_t index, ljson_value && content) {
+    assert(v != nullptr && v->type == LJSON_ARRAY);
+    ljson_expand(v);
+    ljson_touch(v);
+    assert(index < v->data.marray->size());
+    (*v->data.marray)[index] = std::move(content);
+}
+
 ljson_value & getArrayElement(const ljson_value* v, size_t index){
     assert(v != nullptr && v->type == LJSON_ARRAY);
+    ljson_expand(v);
+    ljson_touch(v);
     assert(index < v->data.marray->size());
     return (*v->data.marray)[index];
 }
 
 size_t getArraySize(const ljson_value* v) {
     assert(v != nullptr && v->type == LJSON_ARRAY);
+    ljson_expand(v);
     return v->data.marray->size();
 }
 
 void setArray(ljson_value & v, const std::vector<ljson_value> & vec, bool deep_copy) { setArray(&v, vec, deep_copy); }
-std::vector<ljson_value> & getArray(const ljson_value& v) { return getArray(&v); }
+void setArray(ljson_value & v, std::vector<ljson_value> && vec) { setArray(&v, std::move(vec)); }
+void setArray(ljson_value & v, ljson_array && vec) { setArray(&v, std::move(vec)); }
+ljson_array & getArray(const ljson_value& v) { return getArray(&v); }
 ljson_value & getArrayElement(const ljson_value & v, const size_t index) { return getArrayElement(&v, index); }
 void setArrayElement(ljson_value & v, const size_t index, const ljson_value & content) { setArrayElement(&v, index, content); }
+void setArrayElement(ljson_value & v, const size_t index, ljson_value && content) { setArrayElement(&v, index, std::move(content)); }
 size_t getArraySize(const ljson_value & v) { return getArraySize(&v); }
 
 
 void setObject(ljson_value* v, const std::map<std::string, ljson_value> & vec, bool deep_copy) {
     assert(v != nullptr);
     ljson_free(v);
-    v->data.mobject = new std::map<std::string, ljson_value>;
+    v->data.mobject = new ljson_map;
     v->type = LJSON_OBJECT;
     if (!deep_copy) 
         v->data.mobject->insert(vec.begin(), vec.end());
@@ -836,41 +6150,69 @@ void setObject(ljson_value* v, const std::map<std::string, ljson_value> & vec, b
         }
 }
 
+void setObject(ljson_value* v, std::map<std::string, ljson_value> && vec) {
+    assert(v != nullptr);
+    ljson_free(v);
+    v->data.mobject = new ljson_map;
+    v->type = LJSON_OBJECT;
+    for (auto iter = vec.begin(); iter != vec.end(); iter++)
+        v->data.mobject->emplace(iter->first, std::move(iter->second));
+    vec.clear();
+}
+
+void setObject(ljson_value* v, ljson_map && vec) {
+    assert(v != nullptr);
+    ljson_free(v);
+    v->data.mobject = new ljson_map(std::move(vec));
+    v->type = LJSON_OBJECT;
+}
+
 size_t getObjectSize(const ljson_value* v) {
     assert(v != nullptr && v->type == LJSON_OBJECT);
+    ljson_expand(v);
     return v->data.mobject->size();
 }
 
 bool objectFindKey(const ljson_value* v, const std::string & mkey) {
+    ljson_expand(v);
     return v->data.mobject->find(mkey) != v->data.mobject->end();
 }
 
 ljson_value & getObjElement(const ljson_value* v, const std::string & key) {
     assert(v != nullptr && v->type == LJSON_OBJECT);
-    assert(objectFindKey(v, key));
-    return (*v->data.mobject)[key];
+    ljson_expand(v);
+    ljson_touch(v);
+    auto iter = v->data.mobject->find(key);
+    assert(iter != v->data.mobject->end());
+    return iter->second;
 }
 void setObjElement(ljson_value* v, const std::string key, const ljson_value & content) {
-    assert(v != nullptr && v->type == LJSON_OBJECT);
-    assert(objectFindKey(v, key));
-    ljson_reset(&((*v->data.mobject)[key]), content);
+    ljson_reset(&getObjElement(v, key), content);
+}
+
+void setObjElement(ljson_value* v, const std::string key, ljson_value && content) {
+    getObjElement(v, key) = std::move(content);
 }
 
-std::map<std::string, ljson_value> & getObject(const ljson_value* v) {
+ljson_map & getObject(const ljson_value* v) {
     assert(v != nullptr && v->type == LJSON_OBJECT);
+    ljson_expand(v);
+    ljson_touch(v);
     return *(v->data.mobject);
 }
 
 ljson_value & objectAccess(ljson_value* v, const std::string & mkey) {
-    assert(objectFindKey(v, mkey));
-    return (*v->data.mobject)[mkey];
+    return getObjElement(v, mkey);
 }
 
 void setObject(ljson_value & v, const std::map<std::string, ljson_value> & vec, bool deep_copy) { setObject(&v, vec, deep_copy); }
+void setObject(ljson_value & v, std::map<std::string, ljson_value> && vec) { setObject(&v, std::move(vec)); }
+void setObject(ljson_value & v, ljson_map && vec) { setObject(&v, std::move(vec)); }
 bool objectFindKey(const ljson_value & v, const std::string & mkey) { return objectFindKey(&v, mkey); }
-std::map<std::string, ljson_value> & getObject(const ljson_value & v) { return getObject(&v); }
+ljson_map & getObject(const ljson_value & v) { return getObject(&v); }
 ljson_value & getObjElement(const ljson_value & v, const std::string key) { return getObjElement(&v, key); }
 void setObjElement(ljson_value & v, const std::string key, const ljson_value & content) { setObjElement(&v, key, content); }
+void setObjElement(ljson_value & v, const std::string key, ljson_value && content) { setObjElement(&v, key, std::move(content)); }
 size_t getObjectSize(const ljson_value & v) { return getObjectSize(&v); }
 ljson_value & objectAccess(ljson_value & v, const std::string & mkey) { return objectAccess(&v, mkey); }
 
@@ -1,10 +1,38 @@
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include "lightjson.h"
 #include "gtest/gtest.h"
 
 using namespace ljson;
 
+/* every operator new of the program is counted, for the tests of the parses without allocation */
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+/* new[] need not go through operator new, the keys of ljson_key are new char[] */
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void* p) noexcept {
+    operator delete(p);
+}
+
 inline void test_number(double expect, const char* json) {
     ljson_value v;
     ljson_init(&v);
@@ -501,4 +529,1857 @@ TEST(test_set_get, test_access_array) {
     //EXPECT_STREQ("Hello", getString(getArrayElement(&v, 0)).c_str());
     ljson_free(&(vec[0]));
     ljson_free(&v);
-}
\ No newline at end of file
+}
+TEST(test_arena, parse_with_arena) {
+    ljson_arena arena(64);
+    ljson_value v;
+    ljson_init(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v,
+        "{\"a\":[1,\"a string longer than the small string buffer\",[]],\"o\":{\"k\":\"v\"},\"s\":\"\"}", &arena));
+    EXPECT_EQ(LJSON_OBJECT, getType(&v));
+    EXPECT_EQ(size_t(3), getObjectSize(&v));
+    ljson_value & a = getObjElement(&v, "a");
+    EXPECT_EQ(size_t(3), getArraySize(&a));
+    EXPECT_EQ(size_t(44), getStringLength(getArrayElement(&a, 1)));
+    EXPECT_STREQ("a string longer than the small string buffer", getString(getArrayElement(&a, 1)).c_str());
+    EXPECT_STREQ("v", getString(getObjElement(getObjElement(&v, "o"), "k")).c_str());
+    EXPECT_STREQ("", getString(getObjElement(&v, "s")).c_str());
+    getArray(&a).push_back(getArrayElement(&a, 0));
+    getObject(&v)["n"] = getArrayElement(&a, 0);
+
+    std::string json;
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(&v, json));
+    EXPECT_EQ("{\"a\":[1,\"a string longer than the small string buffer\",[],1],\"o\":{\"k\":\"v\"},\"s\":\"\",\"n\":1}", json);
+    ljson_free(&v);
+}
+
+TEST(test_arena, copy_out_of_arena) {
+    ljson_value v, copy;
+    ljson_init(&v);
+    ljson_init(&copy);
+    {
+        ljson_arena arena;
+        EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "[\"abc\",{\"1\":[true]}]", &arena));
+        copy.copyfrom(v);
+        ljson_free(&v);
+    }
+    std::string json;
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(&copy, json));
+    EXPECT_EQ("[\"abc\",{\"1\":[true]}]", json);
+    ljson_free(&copy);
+}
+
+TEST(test_arena, arena_tree) {
+    // a tree of the arena is released without a walk, until a child is handed out for writing
+    Document js;
+    std::string json("{\"a\":[1,\"a string longer than the small string buffer\"],\"o\":{\"k\":[{}]},"
+                     "\"a key longer than the small buffer of std::string\":null}");
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json));
+    ljson_value* v = js.GetValue();
+    EXPECT_EQ(LJSON_FLAG_ARENA | LJSON_FLAG_ARENA_TREE, v->flags);
+    EXPECT_EQ(2u, getArraySize(getObjElement(v, "a")));
+    EXPECT_EQ(0, v->flags & LJSON_FLAG_ARENA_TREE);
+    EXPECT_NE(0, getObjElement(v, "o").flags & LJSON_FLAG_ARENA_TREE);
+    js["a"][1].SetString(std::string(100, 'x'));
+    EXPECT_EQ(0, getObjElement(v, "a").flags & LJSON_FLAG_ARENA_TREE);
+    EXPECT_NE(0, getObjElement(v, "o").flags & LJSON_FLAG_ARENA_TREE);
+    EXPECT_EQ(std::string(100, 'x'), js["a"][1].GetString());
+    js.Reset();
+    EXPECT_EQ(LJSON_NULL, getType(v));
+
+    // a value from the heap keeps its parents walked
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json));
+    js["o"]["k"][0].SetString(std::string(100, 'y'));
+    EXPECT_EQ(0, v->flags & LJSON_FLAG_ARENA_TREE);
+    EXPECT_EQ(0, getObjElement(v, "o").flags & LJSON_FLAG_ARENA_TREE);
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json));
+    EXPECT_EQ(LJSON_FLAG_ARENA | LJSON_FLAG_ARENA_TREE, v->flags);
+
+    // without an arena nothing is skipped
+    ljson_value heap;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&heap, json));
+    EXPECT_EQ(0, heap.flags);
+    ljson_free(&heap);
+}
+
+TEST(test_arena, document_reparse) {
+    Document js;
+    std::string json("{\"s\":\"hello\",\"a\":[1,2]}");
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json));
+    js["s"].SetString("world");
+    EXPECT_STREQ("world", js["s"].GetString().c_str());
+    std::string json2("[\"x\"]");
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json2));
+    EXPECT_STREQ("x", js[0].GetString().c_str());
+}
+
+TEST(test_parse, parse_whitespace) {
+    const char ws[] = " \t\n\r";
+    for (size_t offset = 0; offset < 32; offset++) {
+        for (size_t n = 0; n < 80; n += 7) {
+            std::string json(offset, 'x');
+            json += '[';
+            for (size_t i = 0; i < n; i++)
+                json += ws[i % 4];
+            json += "1";
+            for (size_t i = 0; i < n; i++)
+                json += ws[(i + 1) % 4];
+            json += ",true]";
+            json.append(n, ' ');
+            ljson_value v;
+            ljson_init(&v);
+            EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json.c_str() + offset));
+            EXPECT_EQ(size_t(2), getArraySize(&v));
+            ljson_free(&v);
+        }
+    }
+    test_error(LJSON_PARSE_EXPECT_VALUE, "                                                                  ");
+    test_error(LJSON_PARSE_ROOT_NOT_SINGULAR, "null                                                  x");
+}
+
+/* parse json from a heap block of its exact size, so that a read past the end is caught by the sanitizers */
+inline int parse_exact(ljson_value* v, const std::string & json) {
+    std::unique_ptr<char[]> block(new char[json.size()]);
+    memcpy(block.get(), json.data(), json.size());
+    return ljson_parse(v, block.get(), json.size());
+}
+
+TEST(test_parse, parse_whitespace_at_end) {
+    for (size_t n = 0; n < 80; n++) {
+        ljson_value v;
+        EXPECT_EQ(LJSON_PARSE_OK, parse_exact(&v, "[1, 2]" + std::string(n, n % 2 ? ' ' : '\n')));
+        ljson_free(&v);
+        EXPECT_EQ(LJSON_PARSE_EXPECT_VALUE, parse_exact(&v, "[" + std::string(n, '\t')));
+    }
+}
+
+TEST(test_parse, parse_long_string) {
+    for (size_t offset = 0; offset < 32; offset++) {
+        for (size_t n = 0; n < 100; n += 9) {
+            std::string expect;
+            for (size_t i = 0; i < n; i++)
+                expect += (i % 3) ? char('a' + i % 26) : '\xC3';
+            std::string json = std::string(offset, ' ') + "\"" + expect + "\\n" + expect + "\"";
+            test_string(expect + "\n" + expect, json.c_str());
+
+            ljson_arena arena;
+            ljson_value v;
+            ljson_init(&v);
+            EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "[\"" + expect + "\",\"" + expect + "\\t\"]", &arena));
+            EXPECT_EQ(expect, getString(getArrayElement(&v, 0)));
+            EXPECT_EQ(expect + "\t", getString(getArrayElement(&v, 1)));
+            ljson_free(&v);
+
+            test_error(LJSON_PARSE_INVALID_STRING_CHAR, ("\"" + expect + "\x1F\"").c_str());
+            test_error(LJSON_PARSE_MISS_QUOTATION_MARK, ("\"" + expect).c_str());
+        }
+    }
+}
+
+TEST(test_parse, parse_string_at_end) {
+    for (size_t n = 0; n < 80; n++) {
+        std::string expect(n, 'a' + n % 26);
+        ljson_value v;
+        EXPECT_EQ(LJSON_PARSE_OK, parse_exact(&v, "\"" + expect + "\""));
+        EXPECT_EQ(expect, getString(&v));
+        ljson_free(&v);
+        EXPECT_EQ(LJSON_PARSE_MISS_QUOTATION_MARK, parse_exact(&v, "\"" + expect));
+    }
+#ifdef LJSON_HAS_MMAP
+    /* the json ends right before a page which can not be read */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char* pages = static_cast<char*>(mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    ASSERT_TRUE(pages != MAP_FAILED);
+    ASSERT_EQ(0, mprotect(pages + page, page, PROT_NONE));
+    for (size_t n = 0; n < 80; n++) {
+        char* json = pages + page - (n + 2);
+        json[0] = '"';
+        memset(json + 1, 'x', n);
+        json[n + 1] = '"';
+        ljson_value v;
+        EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json, n + 2));
+        EXPECT_EQ(n, getStringLength(&v));
+        ljson_free(&v);
+        EXPECT_EQ(LJSON_PARSE_MISS_QUOTATION_MARK, ljson_parse(&v, json, n + 1));
+        json[n + 1] = ' ';
+        EXPECT_EQ(LJSON_PARSE_MISS_QUOTATION_MARK, ljson_parse(&v, json, n + 2));
+    }
+    munmap(pages, 2 * page);
+#endif
+}
+
+TEST(test_parse, parse_escaped_string) {
+    for (size_t n = 0; n < 40; n += 3) {
+        std::string raw(n, 'k'), expect(n, 'k');
+        raw.insert(n / 2, "\\\"\\u00E9\\n");
+        expect.insert(n / 2, "\"\xC3\xA9\n");
+        std::string json = "{\"" + raw + "\":[\"" + raw + "\",\"" + raw + "\"]}";
+        for (int mode = 0; mode < 3; mode++) {
+            ljson_arena arena;
+            KeyPool pool;
+            ljson_parse_buffers buffers;
+            ljson_value v;
+            ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json.data(), json.size(), mode == 1 ? &arena : nullptr,
+                &buffers, mode == 2 ? &pool : nullptr)) << json;
+            EXPECT_EQ(expect, getObject(v).begin()->first.str());
+            ljson_value* a = &getObjElement(v, expect);
+            EXPECT_EQ(expect, getString(getArrayElement(a, 0)));
+            EXPECT_EQ(expect, getString(getArrayElement(a, 1)));
+            ljson_free(&v);
+        }
+        test_error(LJSON_PARSE_INVALID_UNICODE_HEX, ("[\"" + raw + "\\u12\"]").c_str());
+        test_error(LJSON_PARSE_INVALID_UNICODE_HEX, ("{\"" + raw + "\\u12\":1}").c_str());
+        test_error(LJSON_PARSE_MISS_QUOTATION_MARK, ("[\"" + raw).c_str());
+        test_error(LJSON_PARSE_INVALID_STRING_ESCAPE, ("[\"" + raw + "\\").c_str());
+    }
+
+    // an escaped string is decoded into the place it keeps, it costs no more than an unescaped one
+    std::string plain(60, 'x'), escaped = plain + "\\n";
+    for (int mode = 0; mode < 2; mode++) {
+        size_t counts[2];
+        for (int i = 0; i < 2; i++) {
+            const std::string & s = i ? escaped : plain;
+            std::string json = "{\"" + s + "\":\"" + s + "\"}";
+            ljson_arena arena;
+            ljson_parse_buffers buffers;
+            ljson_value v;
+            ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json.data(), json.size(), mode ? &arena : nullptr, &buffers));
+            ljson_free(&v);
+            size_t before = allocations;
+            ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json.data(), json.size(), mode ? &arena : nullptr, &buffers));
+            counts[i] = allocations - before;
+            EXPECT_EQ(i ? plain + "\n" : plain, getString(getObjElement(v, i ? plain + "\n" : plain)));
+            ljson_free(&v);
+        }
+        EXPECT_EQ(counts[0], counts[1]);
+    }
+}
+
+inline void test_number_bits(const std::string & json) {
+    ljson_value v;
+    ljson_init(&v);
+    double expect = strtod(json.c_str(), nullptr);
+    if (std::isinf(expect)) {
+        EXPECT_EQ(LJSON_PARSE_NUMBER_TOO_BIG, ljson_parse(&v, json)) << json;
+        return;
+    }
+    ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json)) << json;
+    double actual = getNumber(&v);
+    EXPECT_EQ(0, memcmp(&expect, &actual, sizeof(double))) << json;
+    ljson_free(&v);
+}
+
+TEST(test_parse, parse_number_exact) {
+    test_number_bits("9007199254740993");                   /* 2^53 + 1, half way */
+    test_number_bits("9007199254740993.0000000000000000001");
+    test_number_bits("2.2250738585072011e-308");
+    test_number_bits("7.038531e-26");
+    test_number_bits("1448997445238699");
+    test_number_bits("123456789012345678901234567890");
+    test_number_bits("0.000000000000000000000000000000000000000000001");
+    test_number_bits("4.9406564584124654e-324");
+    test_number_bits("2.4703282292062327e-324");                /* half of the minimum denormal */
+    test_number_bits("2.4703282292062328e-324");
+    test_number_bits("1.7976931348623158e+308");                /* rounds down to the max double */
+    test_number_bits("0.1e-400");
+    test_number_bits("1" + std::string(400, '0') + "e-400");
+    test_number_bits("0." + std::string(800, '0') + "1e801");
+    test_number_bits("1." + std::string(1000, '0') + "1");
+    test_number_bits("8.98846567431158e307");
+    test_error(LJSON_PARSE_NUMBER_TOO_BIG, "1.7976931348623159e+308");
+    test_error(LJSON_PARSE_NUMBER_TOO_BIG, ("1" + std::string(400, '0')).c_str());
+}
+
+TEST(test_parse, parse_number_random) {
+    uint64_t seed = 88172645463325252ULL;
+    auto next = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    };
+    char buffer[64];
+    for (int i = 0; i < 100000; i++) {
+        uint64_t bits = next();
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        if (std::isnan(d) || std::isinf(d))
+            continue;
+        sprintf(buffer, "%.*g", int(next() % 17) + 1, d);
+        test_number_bits(buffer);
+    }
+    for (int i = 0; i < 100000; i++) {
+        std::string json = std::to_string(next() % 10);
+        size_t digits = next() % 40;
+        if (json == "0" || next() % 2) json += '.';
+        for (size_t j = 0; j < digits; j++)
+            json += char('0' + next() % 10);
+        if (json.back() == '.') json += '5';
+        json += "e" + std::to_string(int(next() % 700) - 350);
+        test_number_bits(json);
+    }
+}
+
+TEST(test_parse, parse_integer) {
+    ljson_value v;
+    ljson_init(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "9007199254740993"));
+    EXPECT_EQ(LJSON_NUMBER_INT64, getNumberType(&v));
+    EXPECT_EQ(INT64_C(9007199254740993), getInt64(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "-9223372036854775808"));
+    EXPECT_EQ(LJSON_NUMBER_INT64, getNumberType(&v));
+    EXPECT_EQ(INT64_MIN, getInt64(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "9223372036854775807"));
+    EXPECT_EQ(INT64_MAX, getInt64(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "9223372036854775808"));
+    EXPECT_EQ(LJSON_NUMBER_UINT64, getNumberType(&v));
+    EXPECT_EQ(UINT64_C(9223372036854775808), getUint64(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "18446744073709551615"));
+    EXPECT_EQ(LJSON_NUMBER_UINT64, getNumberType(&v));
+    EXPECT_EQ(UINT64_MAX, getUint64(&v));
+    EXPECT_DOUBLE_EQ(18446744073709551615.0, getNumber(&v));
+
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "18446744073709551616"));
+    EXPECT_EQ(LJSON_NUMBER_DOUBLE, getNumberType(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "-9223372036854775809"));
+    EXPECT_EQ(LJSON_NUMBER_DOUBLE, getNumberType(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "-0"));
+    EXPECT_EQ(LJSON_NUMBER_DOUBLE, getNumberType(&v));
+    EXPECT_TRUE(std::signbit(getNumber(&v)));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "1.0"));
+    EXPECT_EQ(LJSON_NUMBER_DOUBLE, getNumberType(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "1e2"));
+    EXPECT_EQ(LJSON_NUMBER_DOUBLE, getNumberType(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "0"));
+    EXPECT_EQ(LJSON_NUMBER_INT64, getNumberType(&v));
+    EXPECT_EQ(0, getInt64(&v));
+
+    setUint64(&v, 7);
+    EXPECT_EQ(LJSON_NUMBER_INT64, getNumberType(&v));
+    setNumber(&v, 7.5);
+    EXPECT_EQ(LJSON_NUMBER_DOUBLE, getNumberType(&v));
+    EXPECT_EQ(7, getInt64(&v));
+    ljson_free(&v);
+}
+
+TEST(test_stringify, stringify_integer) {
+    test_roundtrip("0");
+    test_roundtrip("-1");
+    test_roundtrip("[9007199254740993,-9223372036854775808,9223372036854775807,18446744073709551615]");
+    test_roundtrip("[1,10,99,100,1000,123456789,-42]");
+}
+
+inline std::string stringify_double(double d, int max_decimal_places = LJSON_MAX_DECIMAL_PLACES) {
+    ljson_value v;
+    ljson_init(&v);
+    setNumber(&v, d);
+    std::string json;
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(&v, json, max_decimal_places));
+    return json;
+}
+
+TEST(test_stringify, stringify_double) {
+    EXPECT_EQ("0", stringify_double(0.0));
+    EXPECT_EQ("-0", stringify_double(-0.0));
+    EXPECT_EQ("0.1", stringify_double(0.1));
+    EXPECT_EQ("1", stringify_double(1.0));
+    EXPECT_EQ("124", stringify_double(124));
+    EXPECT_EQ("12340000000", stringify_double(1234e7));
+    EXPECT_EQ("-1.5", stringify_double(-1.5));
+    EXPECT_EQ("3.1416", stringify_double(3.1416));
+    EXPECT_EQ("100000000000000000000", stringify_double(1e20));
+    EXPECT_EQ("1e30", stringify_double(1e30));
+    EXPECT_EQ("1.234e-10", stringify_double(1.234e-10));
+    EXPECT_EQ("0.001234", stringify_double(0.001234));
+    EXPECT_EQ("5e-324", stringify_double(4.9406564584124654e-324));
+    EXPECT_EQ("1.7976931348623157e308", stringify_double(1.7976931348623157e308));
+    EXPECT_EQ("null", stringify_double(HUGE_VAL));
+    EXPECT_EQ("null", stringify_double(-HUGE_VAL));
+    EXPECT_EQ("null", stringify_double(std::numeric_limits<double>::quiet_NaN()));
+
+    EXPECT_EQ("3.14", stringify_double(3.14159, 2));
+    EXPECT_EQ("1.1", stringify_double(1.102, 2));
+    EXPECT_EQ("1", stringify_double(1.0, 2));
+    EXPECT_EQ("1", stringify_double(1.001, 2));
+    EXPECT_EQ("0.001", stringify_double(0.001234, 3));
+    EXPECT_EQ("0", stringify_double(0.0001234, 3));
+    EXPECT_EQ("0", stringify_double(1.234e-10, 3));
+    EXPECT_EQ("1e30", stringify_double(1e30, 3));
+}
+
+TEST(test_stringify, stringify_double_roundtrip) {
+    uint64_t seed = 2463534242ULL;
+    for (int i = 0; i < 100000; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        double d;
+        memcpy(&d, &seed, sizeof(d));
+        if (!std::isfinite(d))
+            continue;
+        std::string json = stringify_double(d);
+        ljson_value v;
+        ljson_init(&v);
+        ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json)) << json;
+        double actual = getNumber(&v);
+        EXPECT_EQ(0, memcmp(&d, &actual, sizeof(d))) << json;
+    }
+}
+
+TEST(test_insitu, parse_insitu) {
+    char buf[] = "{\"k\\u00e9y\":[\"abc\",\"a\\nb\\\\c\",\"\\uD834\\uDD1E!\"],\"e\":\"\"}";
+    ljson_value v;
+    ljson_init(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_insitu(&v, buf, sizeof(buf) - 1));
+    ljson_value* a = &getObjElement(&v, "k\xC3\xA9y");
+    ljson_value* s = &getArrayElement(a, 1);
+    EXPECT_EQ(LJSON_FLAG_INSITU, s->flags);
+    EXPECT_TRUE(s->data.mslice.ptr > buf && s->data.mslice.ptr < buf + sizeof(buf));
+    EXPECT_EQ(size_t(5), getStringLength(s));
+    EXPECT_STREQ("a\nb\\c", s->data.mslice.ptr);
+    EXPECT_EQ("abc", getString(getArrayElement(a, 0)));
+    EXPECT_EQ("\xF0\x9D\x84\x9E!", getString(getArrayElement(a, 2)));
+    EXPECT_EQ("", getString(getObjElement(&v, "e")));
+    std::string json;
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(s, json));
+    EXPECT_EQ("\"a\\nb\\\\c\"", json);
+    ljson_free(&v);
+
+    // the keys point into the buffer too: long keys cost no more allocations than short ones
+    char short_keys[] = "{\"a\":1,\"b\":{\"k\":2}}";
+    char keys[] = "{\"a key longer than a short one\":1,\"another\\tlong key of it\":{\"k\":2}}";
+    size_t before = allocations;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_insitu(&v, short_keys, sizeof(short_keys) - 1));
+    size_t expect = allocations - before;
+    ljson_free(&v);
+    before = allocations;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_insitu(&v, keys, sizeof(keys) - 1));
+    EXPECT_EQ(expect, allocations - before);
+    const ljson_key & first = getObject(v).begin()->first;
+    const ljson_key & second = (getObject(v).begin() + 1)->first;
+    EXPECT_FALSE(first.owned());
+    EXPECT_EQ(keys + 2, first.data());
+    EXPECT_EQ("another\tlong key of it", second.str());
+    EXPECT_TRUE(second.data() > keys && second.data() < keys + sizeof(keys));
+    EXPECT_EQ(2.0, getNumber(getObjElement(getObjElement(&v, "another\tlong key of it"), "k")));
+    ljson_free(&v);
+}
+
+inline void test_error_insitu(ljson_state error, const char* json) {
+    std::string buf(json);
+    ljson_value v;
+    ljson_init(&v);
+    EXPECT_EQ(error, ljson_parse_insitu(&v, &buf[0], buf.size())) << json;
+    ljson_free(&v);
+}
+
+TEST(test_insitu, parse_insitu_error) {
+    test_error_insitu(LJSON_PARSE_MISS_QUOTATION_MARK, "[\"a\\nb");
+    test_error_insitu(LJSON_PARSE_INVALID_STRING_CHAR, "\"a\\nb\x01\"");
+    test_error_insitu(LJSON_PARSE_INVALID_STRING_ESCAPE, "\"\\q\"");
+    test_error_insitu(LJSON_PARSE_INVALID_UNICODE_HEX, "{\"\\u12\":1}");
+    test_error_insitu(LJSON_PARSE_INVALID_UNICODE_SURROGATE, "\"\\uD800\\n\"");
+    test_error_insitu(LJSON_PARSE_MISS_COLON, "{\"a\\tb\" 1}");
+    test_error_insitu(LJSON_PARSE_ROOT_NOT_SINGULAR, "\"a\\tb\" x");
+}
+
+TEST(test_insitu, document_insitu) {
+    std::string buf("{\"s\":\"x\\ty\",\"a\":[1,\"\\\"\"]}");
+    Document js;
+    EXPECT_EQ(LJSON_PARSE_OK, js.ParseInsitu(&buf[0], buf.size()));
+    EXPECT_EQ("x\ty", js["s"].GetString());
+    EXPECT_EQ("\"", js["a"][1].GetString());
+}
+
+inline void test_error_len(ljson_state error, const char* json, size_t len) {
+    ljson_value v;
+    ljson_init(&v);
+    EXPECT_EQ(error, ljson_parse(&v, json, len)) << std::string(json, len);
+    ljson_free(&v);
+}
+
+TEST(test_parse, parse_length) {
+    /* every value is parsed from a heap block of its exact length, so reading past the end is caught */
+    const char* jsons[] = {
+        "null", "true", "1", "-0.5", "123456789012345678", "1.2345678901234567e+300", "\"\"", "\"abc\"",
+        "\"a\\u00e9\\n\"", "[]", "[1,2]", "{}", "{\"a\":[true,{\"b\":null}]}", "   \"x\"   "
+    };
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        size_t len = strlen(jsons[i]);
+        std::unique_ptr<char[]> buf(new char[len]);
+        memcpy(buf.get(), jsons[i], len);
+        ljson_value v, expect;
+        ljson_init(&v);
+        ljson_init(&expect);
+        EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, buf.get(), len)) << jsons[i];
+        EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&expect, jsons[i]));
+        std::string json, json2;
+        ljson_stringify(&v, json);
+        ljson_stringify(&expect, json2);
+        EXPECT_EQ(json2, json);
+        ljson_free(&v);
+        ljson_free(&expect);
+    }
+
+    const char* truncated[] = { "nul", "tru", "fals", "-", "1.", "1e", "1e+", "\"abc", "\"a\\", "\"\\u12", "[1", "[1,", "{\"a\"", "{\"a\":" };
+    for (size_t i = 0; i < sizeof(truncated) / sizeof(truncated[0]); i++) {
+        size_t len = strlen(truncated[i]);
+        std::unique_ptr<char[]> buf(new char[len]);
+        memcpy(buf.get(), truncated[i], len);
+        ljson_value v;
+        ljson_init(&v);
+        EXPECT_NE(LJSON_PARSE_OK, ljson_parse(&v, buf.get(), len)) << truncated[i];
+        ljson_free(&v);
+    }
+}
+
+TEST(test_parse, parse_length_slice) {
+    /* whatever follows the slice is not part of the input */
+    const char json[] = "[1,2] trailing 12345 \"abc";
+    test_error_len(LJSON_PARSE_OK, json, 5);
+    test_error_len(LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, json, 4);
+    test_error_len(LJSON_PARSE_EXPECT_VALUE, json, 0);
+    test_error_len(LJSON_PARSE_ROOT_NOT_SINGULAR, json, 7);
+    ljson_value v;
+    ljson_init(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json + 15, 3));
+    EXPECT_EQ(123, getInt64(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json + 15, 1));
+    EXPECT_EQ(1, getInt64(&v));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "12345678901234567890", 9));
+    EXPECT_EQ(123456789, getInt64(&v));
+    test_error_len(LJSON_PARSE_MISS_QUOTATION_MARK, json + 21, 3);
+
+    /* an embedded NUL no longer ends the input */
+    test_error_len(LJSON_PARSE_ROOT_NOT_SINGULAR, "1\0", 2);
+    test_error_len(LJSON_PARSE_INVALID_STRING_CHAR, "\"a\0b\"", 5);
+    EXPECT_EQ(LJSON_PARSE_ROOT_NOT_SINGULAR, ljson_parse(&v, std::string("[1]\0", 4)));
+    ljson_free(&v);
+
+    Document js;
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse("{\"a\":1}}}", 7));
+    EXPECT_EQ(1, js["a"].GetInt64());
+}
+
+class EventRecorder : public ljson_base_handler<EventRecorder> {
+public:
+    std::string events;
+    bool Null() { events += "N "; return true; }
+    bool Bool(bool b) { events += b ? "T " : "F "; return true; }
+    bool Number(double d) { events += "D" + std::to_string(d) + " "; return true; }
+    bool Int64(int64_t i) { events += "I" + std::to_string(i) + " "; return true; }
+    bool Uint64(uint64_t u) { events += "U" + std::to_string(u) + " "; return true; }
+    bool String(const char* str, size_t len, bool copy) {
+        events += (copy ? "S" : "s") + std::string(str, len) + " ";
+        return true;
+    }
+    bool Key(const char* str, size_t len, bool) { events += "K" + std::string(str, len) + " "; return true; }
+    bool StartObject() { events += "{ "; return true; }
+    bool EndObject(size_t count) { events += "}" + std::to_string(count) + " "; return true; }
+    bool StartArray() { events += "[ "; return true; }
+    bool EndArray(size_t count) { events += "]" + std::to_string(count) + " "; return true; }
+};
+
+TEST(test_sax, parse_sax) {
+    EventRecorder h;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_sax(h,
+        "{\"a\":[null,true,false,-1,18446744073709551615,0.5],\"b\\n\":{},\"c\":[],\"d\":\"x\\ty\"}"));
+    EXPECT_EQ("{ Ka [ N T F I-1 U18446744073709551615 D0.500000 ]6 Kb\n { }0 Kc [ ]0 Kd Sx\ty }4 ", h.events);
+
+    EventRecorder h2;
+    char buf[] = "[\"a\\\"b\",\"c\"]";
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_sax_insitu(h2, buf, sizeof(buf) - 1));
+    EXPECT_EQ("[ sa\"b sc ]2 ", h2.events);
+
+    EventRecorder h3;
+    EXPECT_EQ(LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, ljson_parse_sax(h3, std::string("[1,{\"a\":2} 3]")));
+    EXPECT_EQ("[ I1 { Ka I2 }1 ", h3.events);
+}
+
+/* sums the numbers under the key "n" and stops at the first "stop" */
+class SumHandler : public ljson_base_handler<SumHandler> {
+public:
+    double sum = 0;
+    bool in_n = false;
+    bool Key(const char* str, size_t len, bool) {
+        in_n = std::string(str, len) == "n";
+        return std::string(str, len) != "stop";
+    }
+    bool Number(double d) {
+        if (in_n)
+            sum += d;
+        return true;
+    }
+};
+
+TEST(test_sax, handler_defaults_and_terminate) {
+    SumHandler h;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_sax(h, "[{\"n\":1,\"m\":10},{\"n\":2.5},{\"n\":18446744073709551615}]"));
+    EXPECT_DOUBLE_EQ(3.5 + 18446744073709551615.0, h.sum);
+
+    SumHandler h2;
+    EXPECT_EQ(LJSON_PARSE_TERMINATED, ljson_parse_sax(h2, "[{\"n\":1},{\"stop\":0},{\"n\":2}]"));
+    EXPECT_DOUBLE_EQ(1, h2.sum);
+}
+
+TEST(test_parse, parse_duplicated_key) {
+    ljson_value v;
+    ljson_init(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "{\"a\":\"first\",\"b\":1,\"a\":[\"second\"]}"));
+    EXPECT_EQ(size_t(2), getObjectSize(&v));
+    EXPECT_EQ("second", getString(getArrayElement(getObjElement(&v, "a"), 0)));
+    ljson_free(&v);
+}
+
+/* feed json in chunks of chunk bytes, each one in its own heap block */
+inline int stream_parse(ljson_value* v, const std::string & json, size_t chunk) {
+    ljson_dom_handler h(v, nullptr);
+    StreamParser<ljson_dom_handler> parser(h);
+    int ret = LJSON_PARSE_INCOMPLETE;
+    for (size_t i = 0; i < json.size(); i += chunk) {
+        size_t n = std::min(chunk, json.size() - i);
+        std::unique_ptr<char[]> buf(new char[n]);
+        memcpy(buf.get(), json.data() + i, n);
+        ret = parser.Feed(buf.get(), n);
+        if (ret != LJSON_PARSE_INCOMPLETE && ret != LJSON_PARSE_OK)
+            return ret;
+    }
+    return parser.Finish();
+}
+
+TEST(test_stream, stream_parse) {
+    const char* jsons[] = {
+        "{\"a\\u00e9\":[null,true,false,-1.5e-3,18446744073709551615,\"x\\\"y\\\\\",\"\\uD834\\uDD1E\"],"
+            " \"b\" : { \"c\" : [ [], {} ] } , \"long\":\"0123456789abcdefghijklmnopqrstuvwxyz0123456789\"}",
+        "  123456789.25  ", "-0", "\"\\n\"", "[1,[2,[3]],{\"k\":\"v\"}]", "true"
+    };
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        ljson_value expect;
+        ljson_init(&expect);
+        ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&expect, jsons[i]));
+        std::string expect_json;
+        ljson_stringify(&expect, expect_json);
+        for (size_t chunk = 1; chunk <= strlen(jsons[i]); chunk++) {
+            ljson_value v;
+            ljson_init(&v);
+            EXPECT_EQ(LJSON_PARSE_OK, stream_parse(&v, jsons[i], chunk)) << jsons[i] << " " << chunk;
+            std::string json;
+            ljson_stringify(&v, json);
+            EXPECT_EQ(expect_json, json) << chunk;
+            ljson_free(&v);
+        }
+        ljson_free(&expect);
+    }
+}
+
+TEST(test_stream, stream_state) {
+    EventRecorder h;
+    StreamParser<EventRecorder> parser(h);
+    EXPECT_EQ(LJSON_PARSE_INCOMPLETE, parser.Feed("[\"ab", 4));
+    EXPECT_EQ("[ ", h.events);
+    EXPECT_EQ(LJSON_PARSE_INCOMPLETE, parser.Feed("\\", 1));
+    EXPECT_EQ(LJSON_PARSE_INCOMPLETE, parser.Feed("\"c\",12", 6));
+    EXPECT_EQ("[ Sab\"c ", h.events);
+    EXPECT_EQ(LJSON_PARSE_INCOMPLETE, parser.Feed("3", 1));
+    EXPECT_EQ(LJSON_PARSE_OK, parser.Feed("]  ", 3));
+    EXPECT_EQ("[ Sab\"c I123 ]2 ", h.events);
+    EXPECT_EQ(LJSON_PARSE_OK, parser.Feed(" \n", 2));
+    EXPECT_EQ(LJSON_PARSE_OK, parser.Finish());
+    EXPECT_EQ(LJSON_PARSE_ROOT_NOT_SINGULAR, parser.Feed("1", 1));
+    EXPECT_EQ(LJSON_PARSE_ROOT_NOT_SINGULAR, parser.Finish());
+
+    EventRecorder h2;
+    StreamParser<EventRecorder> parser2(h2);
+    EXPECT_EQ(LJSON_PARSE_INCOMPLETE, parser2.Feed("42", 2));
+    EXPECT_EQ("", h2.events);
+    EXPECT_EQ(LJSON_PARSE_OK, parser2.Finish());
+    EXPECT_EQ("I42 ", h2.events);
+}
+
+TEST(test_stream, stream_error) {
+    /* the same errors as ljson_parse, wherever the input is cut */
+    const char* jsons[] = {
+        "", " ", "nul", "?", "+0", "1.", "1e", "nullx", "[1x]", "01", "1e309", "\"abc", "\"\\v\"", "\"\x01\"",
+        "\"\\u12\"", "\"\\uD800\"", "[1", "[1,", "[1}", "[", "{", "{1:1}", "{\"a\"", "{\"a\" 1}", "{\"a\":1",
+        "{\"a\":1]", "{\"a\":1,", "{\"a\":}", "[1] x", "[\"a\"x]"
+    };
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        ljson_value v;
+        ljson_init(&v);
+        int expect = ljson_parse(&v, jsons[i]);
+        ljson_free(&v);
+        EXPECT_NE(LJSON_PARSE_OK, expect) << jsons[i];
+        for (size_t chunk = 1; chunk <= strlen(jsons[i]) + 1; chunk++) {
+            EXPECT_EQ(expect, stream_parse(&v, jsons[i], chunk)) << jsons[i] << " " << chunk;
+            ljson_free(&v);
+        }
+    }
+}
+
+TEST(test_reader, reader) {
+    std::string json("{\"id\":7,\"meta\":{\"tags\":[\"a\",[1,{\"x\":null}],\"b\\u00e9\"],\"ok\":true},"
+                     "\"items\":[{\"name\":\"pen\",\"price\":1.5},{\"price\":2,\"name\":\"ink\\n\"},{}],\"tail\":null}");
+    Reader r(json);
+    ASSERT_TRUE(r.EnterObject());
+    ASSERT_TRUE(r.FindKey("items"));
+    ASSERT_EQ(LJSON_ARRAY, r.Peek());
+    ASSERT_TRUE(r.EnterArray());
+    double total = 0;
+    std::vector<std::string> names;
+    while (r.NextElement()) {
+        ASSERT_TRUE(r.EnterObject());
+        std::string key;
+        while (r.NextKey(key)) {
+            if (key == "price") {
+                double d;
+                ASSERT_TRUE(r.GetNumber(&d));
+                total += d;
+            } else if (key == "name") {
+                std::string name;
+                EXPECT_FALSE(r.GetNull());
+                ASSERT_TRUE(r.GetString(name));
+                names.push_back(name);
+            }
+        }
+    }
+    EXPECT_DOUBLE_EQ(3.5, total);
+    ASSERT_EQ(size_t(2), names.size());
+    EXPECT_EQ("pen", names[0]);
+    EXPECT_EQ("ink\n", names[1]);
+    ASSERT_TRUE(r.FindKey("tail"));
+    EXPECT_TRUE(r.GetNull());
+    EXPECT_FALSE(r.FindKey("none"));
+    EXPECT_EQ(LJSON_PARSE_OK, r.Finish());
+
+    Reader r2(json);
+    ASSERT_TRUE(r2.EnterObject());
+    int64_t id;
+    bool ok;
+    const char* key;
+    size_t len;
+    ASSERT_TRUE(r2.NextKey(&key, &len));
+    EXPECT_EQ("id", std::string(key, len));
+    EXPECT_FALSE(r2.GetBool(&ok));
+    ASSERT_TRUE(r2.GetInt64(&id));
+    EXPECT_EQ(7, id);
+    ASSERT_TRUE(r2.FindKey("meta"));
+    ASSERT_TRUE(r2.EnterObject());
+    ASSERT_TRUE(r2.FindKey("ok"));
+    ASSERT_TRUE(r2.GetBool(&ok));
+    EXPECT_TRUE(ok);
+    EXPECT_FALSE(r2.NextKey(&key, &len));
+    ASSERT_TRUE(r2.NextKey(&key, &len));
+    EXPECT_EQ("items", std::string(key, len));
+    EXPECT_TRUE(r2.SkipValue());
+    ASSERT_TRUE(r2.NextKey(&key, &len));
+    EXPECT_TRUE(r2.SkipValue());
+    EXPECT_FALSE(r2.NextKey(&key, &len));
+    EXPECT_EQ(LJSON_PARSE_OK, r2.Finish());
+}
+
+TEST(test_reader, reader_error) {
+    const char* jsons[] = {
+        "", "nul", "?", "01", "1.", "\"abc", "\"\\v\"", "\"\x01\"", "\"\\u12\"", "[1", "[1,", "[1}",
+        "{1:1}", "{\"a\" 1}", "{\"a\":1", "{\"a\":1]", "[1] x", "{\"a\":[1,{\"b\":tru}]}",
+        "\"\\uD800\"", "[\"\\uD800x\"]", "{\"a\":\"\\uDBFF\\u0041\"}", "[1e400]"
+    };
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        ljson_value v;
+        ljson_init(&v);
+        int expect = ljson_parse(&v, jsons[i]);
+        ljson_free(&v);
+        Reader r(jsons[i], strlen(jsons[i]));
+        EXPECT_EQ(expect, r.Finish()) << jsons[i];
+    }
+
+    Reader r("{\"a\":1 \"b\":2}", 13);
+    std::string key;
+    EXPECT_TRUE(r.EnterObject());
+    EXPECT_TRUE(r.NextKey(key));
+    EXPECT_FALSE(r.NextKey(key));
+    EXPECT_EQ(LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET, r.GetState());
+    EXPECT_FALSE(r.SkipValue());
+
+    // a skipped string checks its surrogates as GetString does
+    Reader rs("[\"\\uD800\",1]", 12);
+    EXPECT_TRUE(rs.EnterArray());
+    EXPECT_TRUE(rs.NextElement());
+    EXPECT_FALSE(rs.SkipValue());
+    EXPECT_EQ(LJSON_PARSE_INVALID_UNICODE_SURROGATE, rs.GetState());
+
+    // an invalid token is an error, not a null
+    ljson_type type;
+    Reader r2("[null,?]", 8);
+    EXPECT_TRUE(r2.EnterArray());
+    EXPECT_TRUE(r2.NextElement());
+    EXPECT_TRUE(r2.Peek(&type));
+    EXPECT_EQ(LJSON_NULL, type);
+    EXPECT_TRUE(r2.GetNull());
+    EXPECT_TRUE(r2.NextElement());
+    EXPECT_FALSE(r2.Peek(&type));
+    EXPECT_EQ(LJSON_PARSE_INVALID_VALUE, r2.GetState());
+    EXPECT_FALSE(r2.GetNull());
+    Reader r3("", 0);
+    EXPECT_FALSE(r3.Peek(&type));
+    EXPECT_EQ(LJSON_PARSE_EXPECT_VALUE, r3.GetState());
+}
+
+TEST(test_lazy, parse_lazy) {
+    std::string json(" {\"i\":1,\"s\":\"x\\ty\",\"o\":{\"1\":[1,{\"deep\":true}],\"2\":\"two\"},"
+                     "\"a\":[{\"k\":null},[],\"e\"],\"big\":[1,2,3,[4,[5]]]} ");
+    ljson_arena arena;
+    ljson_value v;
+    ljson_init(&v);
+    ASSERT_EQ(LJSON_PARSE_OK, ljson_parse_lazy(&v, json.data(), json.size(), &arena));
+    EXPECT_EQ(LJSON_OBJECT, getType(&v));
+    EXPECT_TRUE((v.flags & LJSON_FLAG_LAZY) != 0);
+
+    ljson_value & o = getObjElement(&v, "o");
+    EXPECT_EQ(0, v.flags & LJSON_FLAG_LAZY);
+    EXPECT_EQ(LJSON_OBJECT, getType(&o));
+    EXPECT_TRUE((o.flags & LJSON_FLAG_LAZY) != 0);
+    EXPECT_EQ(LJSON_ARRAY, getType(getObjElement(&v, "big")));
+    EXPECT_TRUE((getObjElement(&v, "big").flags & LJSON_FLAG_LAZY) != 0);
+    EXPECT_EQ(1, getInt64(getObjElement(&v, "i")));
+    EXPECT_EQ("x\ty", getString(getObjElement(&v, "s")));
+    EXPECT_TRUE(getBool(getObjElement(getArrayElement(getObjElement(&o, "1"), 1), "deep")));
+    EXPECT_TRUE((getObjElement(&v, "big").flags & LJSON_FLAG_LAZY) != 0);
+
+    std::string out, expect;
+    ljson_stringify(&v, out);
+    ljson_value full;
+    ljson_init(&full);
+    ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&full, json));
+    ljson_stringify(&full, expect);
+    EXPECT_EQ(expect, out);
+
+    ljson_value copy;
+    ljson_init(&copy);
+    ASSERT_EQ(LJSON_PARSE_OK, ljson_parse_lazy(&copy, json.data(), json.size(), &arena));
+    ljson_value copy2;
+    ljson_init(&copy2);
+    copy2.copyfrom(copy);
+    out.clear();
+    ljson_stringify(&copy2, out);
+    EXPECT_EQ(expect, out);
+    ljson_free(&copy);
+    ljson_free(&copy2);
+    ljson_free(&full);
+    ljson_free(&v);
+
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_lazy(&v, "12", 2, &arena));
+    EXPECT_EQ(12, getInt64(&v));
+    EXPECT_EQ(LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, ljson_parse_lazy(&v, "{\"a\":[1 2]}", 11, &arena));
+    EXPECT_EQ(LJSON_NULL, getType(&v));
+    EXPECT_EQ(LJSON_PARSE_ROOT_NOT_SINGULAR, ljson_parse_lazy(&v, "[] x", 4, &arena));
+    EXPECT_EQ(LJSON_PARSE_EXPECT_VALUE, ljson_parse_lazy(&v, "", 0, &arena));
+    EXPECT_EQ(LJSON_PARSE_NUMBER_TOO_BIG, ljson_parse_lazy(&v, "[1e400]", 7, &arena));
+    EXPECT_EQ(LJSON_PARSE_NUMBER_TOO_BIG, ljson_parse_lazy(&v, "{\"a\":[-1E309]}", 14, &arena));
+    EXPECT_EQ(LJSON_PARSE_INVALID_UNICODE_SURROGATE, ljson_parse_lazy(&v, "[\"\\uD800\"]", 10, &arena));
+    EXPECT_EQ(LJSON_PARSE_INVALID_UNICODE_SURROGATE, ljson_parse_lazy(&v, "[\"\\uD800x\"]", 11, &arena));
+    EXPECT_EQ(LJSON_PARSE_INVALID_UNICODE_SURROGATE, ljson_parse_lazy(&v, "{\"\\uDBFF\\u0041\":1}", 18, &arena));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_lazy(&v, "[1e308,\"\\uD834\\uDD1E\"]", 22, &arena));
+    EXPECT_EQ(1e308, getNumber(getArrayElement(&v, 0)));
+    EXPECT_EQ("\xF0\x9D\x84\x9E", getString(getArrayElement(&v, 1)));
+    ljson_free(&v);
+}
+
+TEST(test_lazy, concurrent_read) {
+    std::string json("{\"a\":[[1,2],{\"x\":[3]}],\"o\":{\"k\":{\"deep\":[true]}},\"s\":\"short\"}");
+    for (int round = 0; round < 20; round++) {
+        ljson_arena arena;
+        ljson_value v;
+        ljson_init(&v);
+        ASSERT_EQ(LJSON_PARSE_OK, ljson_parse_lazy(&v, json.data(), json.size(), &arena));
+        const ljson_value & root = v;
+        std::atomic<int> good(0);
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; i++) {
+            readers.emplace_back([&]() {
+                const ljson_value & a = getObjElement(root, "a");
+                bool ok = getArraySize(a) == 2 && getArraySize(getArrayElement(a, 0)) == 2
+                          && getInt64(getArrayElement(getObjElement(getArrayElement(a, 1), "x"), 0)) == 3
+                          && getBool(getArrayElement(getObjElement(getObjElement(getObjElement(root, "o"), "k"), "deep"), 0));
+                const ljson_value & s = getObjElement(root, "s");
+                ok = ok && getString(s) == "short" && (s.flags & LJSON_FLAG_SHORT) != 0;
+                if (ok)
+                    good++;
+            });
+        }
+        for (auto & t : readers)
+            t.join();
+        EXPECT_EQ(4, good.load());
+        ljson_free(&v);
+    }
+}
+
+TEST(test_lazy, document_lazy) {
+    std::string json("{\"i\":1,\"o\":{\"1\":2,\"2\":[\"a\"]},\"skip\":[[[[]]]]}");
+    Document js;
+    ASSERT_EQ(LJSON_PARSE_OK, js.ParseLazy(json));
+    EXPECT_EQ(1, js["i"].GetInt64());
+    EXPECT_EQ(2, js["o"]["1"].GetInt64());
+    EXPECT_EQ("a", js["o"]["2"][0].GetString());
+}
+
+TEST(test_lazy, lazy_expand_in_arena) {
+    std::string json = "{\"list\":[";
+    for (int i = 0; i < 500; i++)
+        json += std::string(i ? "," : "") + "{\"id\":" + std::to_string(i) + ",\"name\":\"item\\t" + std::to_string(i)
+                + "\",\"a key longer than fourteen chars\":[" + std::to_string(i) + ",{}],\"id\":-" + std::to_string(i) + "}";
+    json += "], \"s\" : \"tail\" }";
+    ljson_value full;
+    ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&full, json));
+    std::string expect;
+    ljson_stringify(&full, expect);
+    ljson_free(&full);
+
+    // the expansions take their containers, strings and keys from the arena and nothing from the heap
+    ljson_arena arena(1 << 20);
+    ljson_value v;
+    ASSERT_EQ(LJSON_PARSE_OK, ljson_parse_lazy(&v, json.data(), json.size(), &arena));
+    const std::string list_key = "list", id = "id", name = "name", long_key = "a key longer than fourteen chars";
+    size_t before = allocations;
+    const ljson_value & list = getObjElement(&v, list_key);
+    ASSERT_EQ(500u, getArraySize(list));
+    EXPECT_EQ(LJSON_FLAG_ARENA | LJSON_FLAG_ARENA_TREE, list.flags);
+    size_t good = 0;
+    for (size_t i = 0; i < 500; i++) {
+        const ljson_value & item = getArrayElement(list, i);
+        const ljson_value & s = getObjElement(&item, name);
+        good += getInt64(getObjElement(&item, id)) == -int64_t(i) && getStringLength(s) == size_t(6 + (i > 9) + (i > 99))
+                && memcmp(getStringData(s), "item\t", 5) == 0 && getObjectSize(getArrayElement(getObjElement(&item, long_key), 1)) == 0;
+    }
+    EXPECT_EQ(before, allocations.load());
+    EXPECT_EQ(500u, good);
+
+    std::string out;
+    ljson_stringify(&v, out);
+    EXPECT_EQ(expect, out);
+    ljson_free(&v);
+}
+
+inline void test_parallel(const std::string & json, unsigned threads) {
+    ljson_value expect, v;
+    ljson_init(&expect);
+    ljson_init(&v);
+    int expect_ret = ljson_parse(&expect, json.data(), json.size());
+    EXPECT_EQ(expect_ret, ljson_parse_parallel(&v, json.data(), json.size(), threads));
+    if (expect_ret == LJSON_PARSE_OK) {
+        std::string a, b;
+        ljson_stringify(&expect, a);
+        ljson_stringify(&v, b);
+        EXPECT_EQ(a, b);
+    }
+    ljson_free(&v);
+    // the shared parser of ljson_parse_parallel has one thread per core, this one cuts the json the same on any machine
+    ParallelParser parser(threads);
+    EXPECT_EQ(expect_ret, parser.Parse(&v, json.data(), json.size()));
+    if (expect_ret == LJSON_PARSE_OK) {
+        std::string a, b;
+        ljson_stringify(&expect, a);
+        ljson_stringify(&v, b);
+        EXPECT_EQ(a, b);
+    }
+    ljson_free(&expect);
+    ljson_free(&v);
+}
+
+TEST(test_parallel, parse_parallel) {
+    std::string json = " [ ";
+    for (size_t i = 0; i < 20000; i++) {
+        if (i)
+            json += ", ";
+        json += "{\"id\":" + std::to_string(i) + ",\"name\":\"a,\\\"]b\",\"tags\":[1,[2,{}],\"x]\"],\"ok\":true}";
+    }
+    json += " ] ";
+    test_parallel(json, 4);
+    test_parallel(json, 3);
+    test_parallel(json, 1);
+    test_parallel(json, 0);
+
+    ljson_value v;
+    ljson_init(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_parallel(&v, json.data(), json.size(), 4));
+    EXPECT_EQ(LJSON_ARRAY, getType(&v));
+    EXPECT_EQ(20000u, getArraySize(&v));
+    ljson_free(&v);
+}
+
+TEST(test_parallel, parse_parallel_error) {
+    std::string json = "[";
+    for (size_t i = 0; i < 20000; i++)
+        json += std::string(i ? "," : "") + "[\"abcdefgh\",12345678]";
+    test_parallel(json + "]", 4);
+    test_parallel(json, 4);
+    test_parallel(json + ",]", 4);
+    test_parallel(json + "] x", 4);
+    std::string broken = json + "]";
+    broken[broken.size() / 2] = '}';
+    test_parallel(broken, 4);
+    broken[broken.size() / 2] = ':';
+    test_parallel(broken, 4);
+    test_parallel("{\"a\":" + json + "]}", 4);
+    test_parallel("[]", 4);
+    test_parallel("", 4);
+}
+
+TEST(test_parallel, parse_parallel_concurrent) {
+    // the calls share one parser, the ones which find it busy parse on their own thread
+    std::string json = "[";
+    for (size_t i = 0; i < 20000; i++)
+        json += std::string(i ? "," : "") + "{\"id\":" + std::to_string(i) + ",\"s\":\"x\\ty\"}";
+    json += "]";
+    ljson_value expect;
+    ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&expect, json));
+    std::string a;
+    ljson_stringify(&expect, a);
+    ljson_free(&expect);
+    std::atomic<int> good(0);
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 4; t++) {
+        callers.emplace_back([&, t]() {
+            for (int round = 0; round < 5; round++) {
+                ljson_arena arena;
+                ljson_value v;
+                std::string b;
+                if (ljson_parse_parallel(&v, json.data(), json.size(), t, t % 2 ? &arena : nullptr) == LJSON_PARSE_OK
+                        && ljson_stringify(&v, b) == LJSON_STRINGIFY_OK && a == b)
+                    good++;
+                ljson_free(&v);
+            }
+        });
+    }
+    for (auto & t : callers)
+        t.join();
+    EXPECT_EQ(20, good.load());
+}
+
+TEST(test_parallel, parallel_parser) {
+    std::string json = "[";
+    for (size_t i = 0; i < 20000; i++)
+        json += std::string(i ? "," : "") + "{\"id\":" + std::to_string(i) + ",\"name\":\"a string longer than a short one\"}";
+    json += "]";
+    ljson_value expect;
+    ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&expect, json));
+    std::string expect_json;
+    ljson_stringify(&expect, expect_json);
+    ljson_free(&expect);
+
+    /* the same workers and the same arena parse again and again */
+    ParallelParser parser(4);
+    EXPECT_EQ(4u, parser.GetThreads());
+    ljson_arena arena;
+    for (int round = 0; round < 3; round++) {
+        ljson_value v;
+        ASSERT_EQ(LJSON_PARSE_OK, parser.Parse(&v, json, &arena));
+        EXPECT_EQ(LJSON_FLAG_ARENA | LJSON_FLAG_ARENA_TREE, v.flags);
+        EXPECT_EQ(20000u, getArraySize(&v));
+        std::string out;
+        ljson_stringify(&v, out);
+        EXPECT_EQ(expect_json, out);
+        ljson_free(&v);
+        arena.reset();
+        ASSERT_EQ(LJSON_PARSE_OK, parser.Parse(&v, json));
+        EXPECT_EQ(0, v.flags);
+        ljson_free(&v);
+    }
+    ljson_value v;
+    EXPECT_EQ(LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, parser.Parse(&v, json.substr(0, json.size() - 1) + "}", &arena));
+    EXPECT_EQ(LJSON_PARSE_OK, parser.Parse(&v, "[" + std::string(200 * 1024, ' ') + "]", &arena));
+    EXPECT_EQ(0u, getArraySize(&v));
+    ljson_free(&v);
+}
+
+TEST(test_parallel, parse_parallel_blocks) {
+    /* strings, escapes and brackets across the 64 byte blocks of the splitter */
+    const char* pieces[] = { "\"ab\\\\\"", "\"\\\"x]\\\"\"", "12345.678", "true", "\"\\\\\\\\\"", "{\"k\\\\\":\"v,\\\"\"}", "[]" };
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t i = 0; i < sizeof(pieces) / sizeof(pieces[0]); i++) {
+            std::string group(offset, ' ');
+            for (size_t n = 0; n < 12; n++)
+                group += std::string(n ? "," : "") + pieces[(i + n) % 7] + std::string(n % 3, ' ');
+            /* the group is no multiple of 64 bytes, so its copies meet the blocks everywhere */
+            std::string json = "[" + group;
+            while (json.size() < 2 * 64 * 1024)
+                json += "," + group;
+            json += "]";
+            test_parallel(json, 2);
+            test_parallel(json.substr(0, json.size() - 1), 2);
+            test_parallel(json + "x", 2);
+        }
+    }
+}
+
+TEST(test_ndjson, ndjson_reader) {
+    std::string json;
+    for (size_t i = 0; i < 5000; i++) {
+        if (i % 100 == 7)
+            json += "{\"n\":" + std::to_string(i) + ",";
+        else if (i % 100 == 8)
+            json += "  \r";
+        else
+            json += "{\"n\":" + std::to_string(i) + ",\"s\":\"a\\tb\"}" + (i % 2 ? "\r" : "");
+        json += "\n";
+    }
+    for (int ordered = 0; ordered < 2; ordered++) {
+        NdjsonReader reader(4, ordered != 0);
+        EXPECT_EQ(4u, reader.GetThreads());
+        for (int round = 0; round < 2; round++) {
+            std::vector<size_t> lines;
+            size_t errors = reader.Parse(json, [&](size_t line, int state, ljson_value* v) {
+                lines.push_back(line);
+                if ((line - 1) % 100 == 7) {
+                    EXPECT_EQ(LJSON_PARSE_MISS_KEY, state);
+                    EXPECT_EQ(LJSON_NULL, getType(v));
+                } else {
+                    EXPECT_EQ(LJSON_PARSE_OK, state);
+                    EXPECT_EQ(double(line - 1), getNumber(getObjElement(v, "n")));
+                    EXPECT_EQ("a\tb", getString(getObjElement(v, "s")));
+                }
+            });
+            EXPECT_EQ(50u, errors);
+            EXPECT_EQ(4950u, lines.size());
+            if (ordered) {
+                EXPECT_TRUE(std::is_sorted(lines.begin(), lines.end()));
+            }
+            std::sort(lines.begin(), lines.end());
+            EXPECT_TRUE(std::adjacent_find(lines.begin(), lines.end()) == lines.end());
+        }
+    }
+
+    NdjsonReader reader(2);
+    size_t calls = 0;
+    EXPECT_EQ(0u, reader.Parse("", [&](size_t, int, ljson_value*) { calls++; }));
+    EXPECT_EQ(1u, reader.Parse("\n [1] \n\n2 3", [&](size_t line, int state, ljson_value*) {
+        EXPECT_EQ(calls ? 4u : 2u, line);
+        EXPECT_EQ(calls ? LJSON_PARSE_ROOT_NOT_SINGULAR : LJSON_PARSE_OK, state);
+        calls++;
+    }));
+    EXPECT_EQ(2u, calls);
+}
+
+TEST(test_ndjson, ndjson_reader_sax) {
+    std::string json;
+    for (size_t i = 0; i < 3000; i++)
+        json += "{\"n\":" + std::to_string(i) + "}\n" + (i % 1000 == 0 ? "{\"stop\":1}\n" : "");
+    NdjsonReader reader(3);
+    std::vector<SumHandler> handlers(reader.GetThreads());
+    size_t terminated = 0;
+    EXPECT_EQ(3u, reader.ParseSax(json.data(), json.size(), handlers, [&](size_t, int state) {
+        if (state == LJSON_PARSE_TERMINATED)
+            terminated++;
+    }));
+    EXPECT_EQ(3u, terminated);
+    double sum = 0;
+    for (size_t i = 0; i < handlers.size(); i++)
+        sum += handlers[i].sum;
+    EXPECT_DOUBLE_EQ(2999.0 * 3000 / 2, sum);
+}
+
+class LineCountHandler : public ljson_base_handler<LineCountHandler> {
+public:
+    std::atomic<size_t>* parsed = nullptr;
+    bool Number(double) { (*parsed)++; return true; }
+};
+
+TEST(test_ndjson, ndjson_reader_bounded) {
+    /* 1024 lines a batch, the workers wait while the first batch is delivered slowly */
+    std::string json;
+    for (size_t i = 0; i < 100 * 1024; i++)
+        json += "1\n";
+    for (int ordered = 0; ordered < 2; ordered++) {
+        NdjsonReader reader(2, ordered != 0);
+        std::atomic<size_t> parsed(0);
+        std::vector<LineCountHandler> handlers(reader.GetThreads());
+        for (size_t i = 0; i < handlers.size(); i++)
+            handlers[i].parsed = &parsed;
+        size_t delivered = 0, most = 0;
+        EXPECT_EQ(0u, reader.ParseSax(json.data(), json.size(), handlers, [&](size_t, int) {
+            if (delivered++ == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            most = std::max<size_t>(most, parsed - delivered);
+        }));
+        EXPECT_EQ(100u * 1024, delivered);
+        EXPECT_LE(most, 2u * reader.GetThreads() * 1024);
+    }
+}
+
+TEST(test_ndjson, ndjson_reader_file) {
+    std::string json;
+    for (size_t i = 0; i < 2000; i++)
+        json += (i % 500 == 3 ? "[{\"open\":[1," : "{\"n\":" + std::to_string(i) + ",\"s\":\"x\\ty\"}") + std::string("\n");
+    std::ofstream("ndjson_file.ndjson") << json;
+    NdjsonReader reader(2);
+    double sum = 0;
+    EXPECT_EQ(4u, reader.ParseFile("ndjson_file.ndjson", [&](size_t line, int state, ljson_value* v) {
+        if ((line - 1) % 500 == 3) {
+            EXPECT_EQ(LJSON_PARSE_EXPECT_VALUE, state);
+            EXPECT_EQ(LJSON_NULL, getType(v));
+            return;
+        }
+        EXPECT_EQ(LJSON_PARSE_OK, state);
+        EXPECT_EQ("x\ty", getString(getObjElement(v, "s")));
+        sum += getNumber(getObjElement(v, "n"));
+    }));
+    EXPECT_DOUBLE_EQ(1999.0 * 2000 / 2 - (3 + 503 + 1003 + 1503), sum);
+
+    std::vector<SumHandler> handlers(reader.GetThreads());
+    EXPECT_EQ(4u, reader.ParseSaxFile("ndjson_file.ndjson", handlers));
+    std::remove("ndjson_file.ndjson");
+
+    size_t calls = 0;
+    EXPECT_EQ(1u, reader.ParseFile("no_such_file.ndjson", [&](size_t line, int state, ljson_value* v) {
+        EXPECT_EQ(0u, line);
+        EXPECT_EQ(LJSON_PARSE_FILE_ERROR, state);
+        EXPECT_EQ(LJSON_NULL, getType(v));
+        calls++;
+    }));
+    EXPECT_EQ(1u, calls);
+    EXPECT_EQ(1u, reader.ParseSaxFile("no_such_file.ndjson", handlers));
+}
+
+TEST(test_file, parse_file) {
+    std::ifstream json_file("../example.json");
+    std::string str((std::istreambuf_iterator<char>(json_file)),
+                    std::istreambuf_iterator<char>());
+    ljson_value expect, v;
+    ljson_init(&expect);
+    ljson_init(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&expect, str));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_file(&v, "../example.json"));
+    std::string a, b;
+    ljson_stringify(&expect, a);
+    ljson_stringify(&v, b);
+    EXPECT_EQ(a, b);
+    ljson_free(&expect);
+    ljson_free(&v);
+
+    EXPECT_EQ(LJSON_PARSE_FILE_ERROR, ljson_parse_file(&v, "no_such_file.json"));
+    EXPECT_EQ(LJSON_NULL, getType(&v));
+    std::ofstream("empty_file.json").close();
+    EXPECT_EQ(LJSON_PARSE_EXPECT_VALUE, ljson_parse_file(&v, "empty_file.json"));
+    std::remove("empty_file.json");
+}
+
+TEST(test_file, document_file) {
+    std::string json = "{\"s\":\"a\\nb\",\"t\":\"plain\",\"a\":[1,2,3]}";
+    std::ofstream("document_file.json") << json;
+    {
+        ljson::Document js;
+        EXPECT_EQ(LJSON_PARSE_OK, js.ParseFile(std::string("document_file.json")));
+        EXPECT_EQ("a\nb", js["s"].GetString());
+        EXPECT_EQ("plain", js["t"].GetString());
+        EXPECT_EQ(3.0, js["a"][2].GetNumber());
+        EXPECT_EQ(LJSON_PARSE_FILE_ERROR, js.ParseFile("no_such_file.json"));
+        EXPECT_EQ(LJSON_PARSE_OK, js.ParseFile("document_file.json"));
+        EXPECT_EQ(LJSON_PARSE_OK, js.Parse("[1]", 3));
+    }
+    /* the document writes to a private copy only */
+    std::ifstream in("document_file.json");
+    EXPECT_EQ(json, std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>()));
+    in.close();
+    std::remove("document_file.json");
+}
+
+TEST(test_document, document_reuse) {
+    std::string json = "{\"id\":12345,\"name\":\"a name which is longer than the small buffer\","
+                       "\"text\":\"escaped \\\"quotes\\\" and \\u00e9 in a long enough string\","
+                       "\"tags\":[\"x\",\"y\",[1,2.5,true,null]],\"o\":{\"a\":{\"b\":[{}]}},"
+                       "\"a key longer than the small buffer of std::string\":0}";
+    ljson::Document js;
+    for (int i = 0; i < 3; i++)
+        EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json.data(), json.size()));
+    size_t before = allocations;
+    for (int i = 0; i < 100; i++)
+        EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json.data(), json.size()));
+    EXPECT_EQ(before, size_t(allocations));
+    EXPECT_EQ("escaped \"quotes\" and \xc3\xa9 in a long enough string", js["text"].GetString());
+    EXPECT_EQ(2.5, js["tags"][2][1].GetNumber());
+
+    /* a failed parse leaves nothing behind */
+    EXPECT_EQ(LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, js.Parse("[[1,{\"a\":[2}]]", 15));
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse("[1]", 3));
+    EXPECT_EQ(1.0, js[0].GetNumber());
+    js.Reset();
+    EXPECT_EQ(LJSON_NULL, getType(js.GetValue()));
+}
+
+TEST(test_move, value_move) {
+    ljson_value a;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&a, "[\"a string which is not small\",{\"k\":[1,2]}]"));
+    const ljson_value* first = &getArrayElement(&a, 0);
+    ljson_value b(std::move(a));
+    EXPECT_EQ(LJSON_NULL, getType(&a));
+    EXPECT_EQ(first, &getArrayElement(&b, 0));
+
+    ljson_value c;
+    setString(&c, "freed by the move");
+    c = std::move(b);
+    EXPECT_EQ(LJSON_NULL, getType(&b));
+    EXPECT_EQ(first, &getArrayElement(&c, 0));
+
+    ljson_value d;
+    setNumber(&d, 1);
+    d.swap(c);
+    EXPECT_EQ(LJSON_NUMBER, getType(&c));
+    EXPECT_EQ(first, &getArrayElement(&d, 0));
+    ljson_free(&c);
+    ljson_free(&d);
+}
+
+TEST(test_move, move_sinks) {
+    ljson_value v, e;
+    setString(&e, "a string which is not small");
+    const std::string* str = e.data.mstring;
+
+    std::vector<ljson_value> vec(2);
+    vec[1] = std::move(e);
+    setArray(&v, std::move(vec));
+    EXPECT_TRUE(vec.empty());
+    EXPECT_EQ(str, getArrayElement(&v, 1).data.mstring);
+
+    ljson_array a(1);
+    setNumber(&a[0], 3);
+    const ljson_value* data = a.data();
+    ljson_value w;
+    setArray(&w, std::move(a));
+    EXPECT_EQ(data, &getArrayElement(&w, 0));
+    setArrayElement(&w, 0, std::move(v));
+    EXPECT_EQ(LJSON_NULL, getType(&v));
+    EXPECT_EQ(str, getArrayElement(getArrayElement(&w, 0), 1).data.mstring);
+
+    std::map<std::string, ljson_value> m;
+    m["a"] = std::move(w);
+    setObject(&v, std::move(m));
+    EXPECT_EQ(str, getArrayElement(getArrayElement(getObjElement(&v, "a"), 0), 1).data.mstring);
+    setObjElement(&v, "a", std::move(getArrayElement(getArrayElement(getObjElement(&v, "a"), 0), 1)));
+    EXPECT_EQ(str, getObjElement(&v, "a").data.mstring);
+    ljson_free(&v);
+}
+
+TEST(test_move, document_move) {
+    std::string json = "{\"a\":[1,{\"b\":\"c\"}],\"d\":{\"e\":2}}";
+    ljson::Document js;
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json));
+    const ljson_value* inner = &getArrayElement(js["a"].GetValue(), 1);
+    ljson::Value a = js["a"];
+    ljson::Value d = js["d"];
+    a.Swap(d);
+    EXPECT_EQ(2.0, js["a"]["e"].GetNumber());
+    EXPECT_EQ(inner, js["d"][1].GetValue());
+    js["a"].MoveFrom(js["d"][1]);
+    EXPECT_EQ("c", js["a"]["b"].GetString());
+    EXPECT_EQ(LJSON_NULL, getType(js["d"][1].GetValue()));
+    js["d"].SetValue(js);
+    EXPECT_EQ("c", js["d"]["a"]["b"].GetString());
+    EXPECT_EQ(LJSON_NULL, getType(js["d"]["d"][1].GetValue()));
+    js["d"].MoveFrom(js["d"]["a"]);
+    EXPECT_EQ("c", js["d"]["b"].GetString());
+
+    ljson::Document moved(std::move(js));
+    EXPECT_EQ("c", moved["d"]["b"].GetString());
+    EXPECT_EQ(LJSON_NULL, getType(js.GetValue()));
+    js = std::move(moved);
+    EXPECT_EQ("c", js["a"]["b"].GetString());
+    EXPECT_EQ(LJSON_NULL, getType(moved.GetValue()));
+    EXPECT_EQ(LJSON_PARSE_OK, moved.Parse("[1]", 3));
+}
+
+/* every array of the tree is allocated once, at its final size */
+inline void expect_final_size(const ljson_value* v) {
+    if (getType(v) == LJSON_ARRAY) {
+        EXPECT_EQ(getArray(v).size(), getArray(v).capacity());
+        for (size_t i = 0; i < getArraySize(v); i++)
+            expect_final_size(&getArrayElement(v, i));
+    } else if (getType(v) == LJSON_OBJECT) {
+        for (auto iter = getObject(v).begin(); iter != getObject(v).end(); iter++)
+            expect_final_size(&iter->second);
+    }
+}
+
+TEST(test_parse, parse_final_size) {
+    std::string json = "[[1,2,3,4,5],{\"a\":[true,false,null],\"b\":[[],[[\"x\",\"y\",\"z\"]]]},[";
+    for (int i = 0; i < 1000; i++)
+        json += std::to_string(i) + ",";
+    json += "{}]]";
+    ljson_value v;
+    ljson::Document js;
+    ljson_arena arena;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json));
+    expect_final_size(&v);
+    ljson_free(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json, &arena));
+    expect_final_size(&v);
+    ljson_free(&v);
+    ljson_arena lazy_arena;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_lazy(&v, json.data(), json.size(), &lazy_arena));
+    expect_final_size(&v);
+    ljson_free(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json));
+    expect_final_size(js.GetValue());
+}
+
+TEST(test_parse, parse_short_string) {
+    EXPECT_EQ(16u, sizeof(ljson_value));
+    ljson_value v;
+    std::string json = "[\"\",\"ok\",\"a\\tb\\u4e2d\",\"1234567890123\",\"12345678901234\"]";
+    // the short strings cost no more allocations than numbers
+    size_t before = allocations;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "[1,2,3,4]"));
+    size_t numbers = allocations - before;
+    ljson_free(&v);
+    before = allocations;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "[\"a\",\"bb\",\"\",\"1234567890123\"]"));
+    EXPECT_EQ(numbers, allocations - before);
+    ljson_free(&v);
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json));
+    EXPECT_EQ(LJSON_FLAG_SHORT, getArrayElement(v, 0).flags);
+    EXPECT_EQ(0u, getStringLength(getArrayElement(v, 0)));
+    EXPECT_EQ(6u, getStringLength(getArrayElement(v, 2)));
+    EXPECT_EQ(LJSON_FLAG_SHORT, getArrayElement(v, 3).flags);
+    EXPECT_EQ(LJSON_SHORT_STRING_MAX, getStringLength(getArrayElement(v, 3)));
+    EXPECT_EQ(0, getArrayElement(v, 4).flags);
+    std::string out;
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(&v, out));
+    EXPECT_EQ("[\"\",\"ok\",\"a\\tb\xe4\xb8\xad\",\"1234567890123\",\"12345678901234\"]", out);
+
+    ljson_value copy;
+    copy.copyfrom(v);
+    EXPECT_EQ(LJSON_FLAG_SHORT, getArrayElement(copy, 1).flags);
+    /* getStringData reads a string in any storage and leaves it as it is, getString copies it out */
+    const ljson_value & ok = getArrayElement(v, 1);
+    EXPECT_EQ("ok", std::string(getStringData(ok), getStringLength(ok)));
+    EXPECT_EQ(LJSON_FLAG_SHORT, ok.flags);
+    EXPECT_EQ("ok", getString(ok));
+    EXPECT_EQ(LJSON_FLAG_SHORT, ok.flags);
+    EXPECT_EQ("ok", getString(getArrayElement(v, 1)));
+    EXPECT_EQ(0, getArrayElement(v, 1).flags);
+    EXPECT_EQ("1234567890123", getString(getArrayElement(copy, 3)));
+    ljson_free(&copy);
+    ljson_free(&v);
+
+    before = allocations;
+    setString(v, "status", 6);
+    EXPECT_EQ(before, size_t(allocations));
+    EXPECT_EQ(6u, getStringLength(v));
+    setString(v, std::string(14, 'x'));
+    EXPECT_EQ(14u, getStringLength(v));
+    EXPECT_EQ(std::string(14, 'x'), getString(v));
+    ljson_free(&v);
+
+    char buf[] = "[\"a string which is longer than a short one\"]";
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_insitu(&v, buf, strlen(buf)));
+    const ljson_value & slice = getArrayElement(v, 0);
+    EXPECT_EQ(buf + 2, getStringData(slice));
+    EXPECT_EQ(LJSON_FLAG_INSITU, slice.flags);
+    ljson_free(&v);
+}
+
+TEST(test_object, object_order_and_index) {
+    for (size_t n : { size_t(3), size_t(100) }) {
+        std::string json = "{";
+        for (size_t i = n; i > 0; i--)
+            json += "\"k" + std::to_string(i) + "\":" + std::to_string(i) + ",";
+        json += "\"k1\":0}";
+        ljson_value v;
+        EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json));
+        EXPECT_EQ(n, getObjectSize(&v));
+        /* the members keep the order of the json, a duplicated key keeps its first place */
+        std::string out;
+        ljson_stringify(&v, out);
+        EXPECT_EQ(json.substr(0, json.rfind(",\"k1\":1")) + ",\"k1\":0}", out);
+        for (size_t i = 2; i <= n; i++)
+            EXPECT_EQ(double(i), getNumber(getObjElement(&v, "k" + std::to_string(i))));
+        EXPECT_FALSE(objectFindKey(&v, "k0"));
+        EXPECT_FALSE(objectFindKey(&v, "k"));
+
+        ljson_map & m = getObject(&v);
+        setNumber(&m["new"], -1);
+        EXPECT_EQ(n + 1, m.size());
+        EXPECT_EQ("new", (m.end() - 1)->first);
+        EXPECT_EQ(size_t(1), m.erase("k2"));
+        EXPECT_EQ(size_t(0), m.erase("k2"));
+        EXPECT_FALSE(objectFindKey(&v, "k2"));
+        EXPECT_EQ(-1.0, getNumber(getObjElement(&v, "new")));
+        EXPECT_EQ(0.0, getNumber(getObjElement(&v, "k1")));
+        ljson_free(&v);
+    }
+}
+
+TEST(test_object, object_hash_index) {
+    std::string json = "{";
+    for (size_t i = 0; i < 20000; i++)
+        json += std::string(i ? "," : "") + "\"user" + std::to_string(i * 7919 % 20000) + "\":" + std::to_string(i);
+    json += "}";
+    ljson_value v;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json));
+    ljson_map & m = getObject(&v);
+    EXPECT_TRUE(m.indexed());
+    EXPECT_EQ(size_t(20000), m.size());
+    EXPECT_EQ("user0", m.begin()->first);
+    EXPECT_EQ("user7919", (m.begin() + 1)->first);
+    for (size_t i = 0; i < 20000; i++)
+        EXPECT_EQ(double(i), getNumber(getObjElement(&v, "user" + std::to_string(i * 7919 % 20000))));
+    EXPECT_FALSE(objectFindKey(&v, "user20000"));
+    EXPECT_EQ(size_t(1), m.erase("user7919"));
+    EXPECT_FALSE(objectFindKey(&v, "user7919"));
+    EXPECT_EQ(1.0 * 2, getNumber(getObjElement(&v, "user" + std::to_string(2 * 7919 % 20000))));
+    setNumber(&m[""], -1);
+    EXPECT_EQ(-1.0, getNumber(getObjElement(&v, "")));
+    EXPECT_EQ(size_t(20000), m.size());
+    ljson_free(&v);
+
+    ljson_map small;
+    small["a"];
+    EXPECT_FALSE(small.indexed());
+    small.index();
+    EXPECT_TRUE(small.indexed());
+    for (int i = 0; i < 100; i++)
+        small[std::to_string(i)];
+    EXPECT_TRUE(small.find("a") == small.begin());
+    EXPECT_TRUE(small.find("99") == small.end() - 1);
+}
+
+TEST(test_object, object_map_members) {
+    /* the members of std::map which the callers of getObject use */
+    ljson_value v;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "{\"b\":1,\"a\":2}"));
+    ljson_map & m = getObject(&v);
+    EXPECT_EQ(1u, m.count("a"));
+    EXPECT_EQ(0u, m.count("c"));
+    EXPECT_EQ(2.0, getNumber(m.at("a")));
+    const ljson_map & cm = m;
+    EXPECT_EQ(1.0, getNumber(cm.at("b")));
+    EXPECT_THROW(m.at("c"), std::out_of_range);
+    ljson_value three;
+    setNumber(&three, 3);
+    EXPECT_TRUE(m.insert(std::make_pair(std::string("c"), three)).second);
+    EXPECT_FALSE(m.insert(std::make_pair(std::string("a"), three)).second);
+    EXPECT_EQ(2.0, getNumber(m.at("a")));
+    /* the order of the json, not the order of the keys */
+    std::string keys;
+    for (auto iter = m.begin(); iter != m.end(); iter++)
+        keys += iter->first.str();
+    EXPECT_EQ("bac", keys);
+    ljson_free(&v);
+}
+
+TEST(test_object, document_index_objects) {
+    std::string json = "{\"a\":{\"b\":[{\"c\":1}]},\"d\":2}";
+    ljson::Document js;
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json));
+    EXPECT_FALSE(getObject(js.GetValue()).indexed());
+    js.SetIndexObjects(true);
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(json));
+    EXPECT_TRUE(getObject(js.GetValue()).indexed());
+    EXPECT_TRUE(getObject(js["a"].GetValue()).indexed());
+    EXPECT_TRUE(getObject(js["a"]["b"][0].GetValue()).indexed());
+    EXPECT_EQ(1.0, js["a"]["b"][0]["c"].GetNumber());
+    EXPECT_EQ(2.0, js["d"].GetNumber());
+}
+
+TEST(test_object, key_pool) {
+    KeyPool pool(3);
+    const KeyPool::Entry* a = pool.Intern("a", 1);
+    EXPECT_TRUE(a != nullptr);
+    EXPECT_EQ(a, pool.Intern(std::string("a")));
+    EXPECT_TRUE(pool.Intern("b", 1) != a);
+    EXPECT_TRUE(pool.Intern("", 0) != nullptr);
+    EXPECT_TRUE(pool.Intern("c", 1) == nullptr);
+    EXPECT_EQ(3u, pool.Size());
+    EXPECT_TRUE(ljson_key(a) == ljson_key("a"));
+    EXPECT_TRUE(ljson_key(a) != ljson_key(pool.Intern("b", 1)));
+
+    // keys over the limit are owned by the members, the others are shared between the parses
+    ljson_value v1, v2;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_insitu(&v1, &std::string("{\"a\":1,\"c\":2}")[0], 13, nullptr, nullptr, &pool));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_insitu(&v2, &std::string("{\"c\":3,\"a\":4}")[0], 13, nullptr, nullptr, &pool));
+    EXPECT_EQ(a, getObject(v1).begin()->first.entry());
+    EXPECT_EQ(a, (getObject(v2).end() - 1)->first.entry());
+    EXPECT_TRUE(getObject(v1).find("c")->first.entry() == nullptr);
+    EXPECT_EQ(2.0, getNumber(getObjElement(v1, "c")));
+    EXPECT_EQ(4.0, getNumber(getObjElement(v2, "a")));
+    ljson_value copy;
+    copy.copyfrom(v1);
+    EXPECT_TRUE(getObject(copy).find("a")->first.entry() == nullptr);
+    std::string s1, s2;
+    ljson_stringify(&v1, s1);
+    ljson_stringify(&copy, s2);
+    EXPECT_EQ(s1, s2);
+    ljson_free(&copy);
+    ljson_free(&v1);
+    ljson_free(&v2);
+}
+
+TEST(test_object, key_pool_shared) {
+    KeyPool pool;
+    std::string json;
+    for (size_t i = 0; i < 2000; i++)
+        json += "{\"id\":" + std::to_string(i) + ",\"k" + std::to_string(i % 50) + "\":true}\n";
+    NdjsonReader reader(4);
+    reader.SetKeyPool(&pool);
+    const KeyPool::Entry* id = pool.Intern("id", 2);
+    std::atomic<size_t> shared(0);
+    EXPECT_EQ(0u, reader.Parse(json, [&](size_t line, int state, ljson_value* v) {
+        EXPECT_EQ(LJSON_PARSE_OK, state);
+        EXPECT_EQ(double(line - 1), getNumber(getObjElement(v, "id")));
+        if (getObject(v).begin()->first.entry() == id)
+            shared++;
+    }));
+    EXPECT_EQ(2000u, shared.load());
+    EXPECT_EQ(51u, pool.Size());
+
+    ljson::Document js;
+    std::string doc = "{\"id\":7,\"k3\":false}";
+    js.SetKeyPool(&pool);
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(doc));
+    EXPECT_EQ(id, getObject(js.GetValue()).begin()->first.entry());
+    EXPECT_EQ(7.0, js["id"].GetNumber());
+    EXPECT_FALSE(js["k3"].GetBool());
+    EXPECT_EQ(51u, pool.Size());
+}
+
+TEST(test_object, object_key) {
+    EXPECT_EQ(16u, sizeof(ljson_key));
+    // a short key is stored in place, a long one is allocated unless it is a slice
+    std::string chars(ljson_key::SHORT_MAX + 1, 'k');
+    size_t before = allocations;
+    ljson_key empty, small(chars.data(), ljson_key::SHORT_MAX), slice = ljson_key::slice(chars.data(), chars.size());
+    EXPECT_EQ(before, size_t(allocations));
+    ljson_key owned(chars), copy(owned);
+    EXPECT_EQ(before + 2, size_t(allocations));
+    EXPECT_TRUE(owned.owned());
+    EXPECT_FALSE(slice.owned());
+    EXPECT_NE(owned.data(), copy.data());
+    EXPECT_EQ(chars.data(), slice.data());
+    EXPECT_EQ("", empty.str());
+    EXPECT_EQ(chars.substr(1), small.str());
+    EXPECT_EQ(chars, owned.c_str());
+    EXPECT_TRUE(owned == slice && copy == slice && !(small == slice));
+    EXPECT_TRUE(small < owned && !(owned < slice));
+    EXPECT_EQ(owned.hash(), slice.hash());
+    ljson_key moved(std::move(owned));
+    EXPECT_EQ(0u, owned.size());
+    EXPECT_EQ(chars, moved.str());
+    copy = small;
+    EXPECT_EQ(small, copy);
+}
+
+TEST(test_compact, parse_compact) {
+    EXPECT_EQ(8u, sizeof(ljson_compact));
+    ljson_arena arena;
+    ljson_compact v;
+    std::string json = "{\"n\":null,\"t\":true,\"f\":false,\"i\":-42,\"d\":-1.5e-3,"
+                       "\"big\":-9223372036854775808,\"u\":18446744073709551615,\"w\":140737488355328,"
+                       "\"s\":\"a\\tb\\u4e2d\",\"e\":\"\",\"a\":[[],{},[1,\"x\"]],\"i\":7}";
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_compact(&v, json, &arena));
+    EXPECT_EQ(LJSON_OBJECT, getType(v));
+    EXPECT_EQ(12u, getObjectSize(v));
+    EXPECT_EQ(LJSON_NULL, getType(getObjElement(v, "n")));
+    EXPECT_TRUE(getBool(getObjElement(v, "t")));
+    EXPECT_FALSE(getBool(getObjElement(v, "f")));
+    EXPECT_EQ(7, getInt64(getObjElement(v, "i")));
+    EXPECT_EQ(-1.5e-3, getNumber(getObjElement(v, "d")));
+    EXPECT_EQ(LJSON_NUMBER_DOUBLE, getNumberType(getObjElement(v, "d")));
+    EXPECT_EQ(INT64_MIN, getInt64(getObjElement(v, "big")));
+    EXPECT_EQ(UINT64_MAX, getUint64(getObjElement(v, "u")));
+    EXPECT_EQ(LJSON_NUMBER_UINT64, getNumberType(getObjElement(v, "u")));
+    EXPECT_EQ(int64_t(1) << 47, getInt64(getObjElement(v, "w")));
+    EXPECT_EQ("a\tb\xe4\xb8\xad", getString(getObjElement(v, "s")));
+    EXPECT_EQ(0u, getStringLength(getObjElement(v, "e")));
+    ljson_compact a = getObjElement(v, "a");
+    EXPECT_EQ(3u, getArraySize(a));
+    EXPECT_EQ(0u, getArraySize(getArrayElement(a, 0)));
+    EXPECT_EQ(0u, getObjectSize(getArrayElement(a, 1)));
+    EXPECT_EQ(1.0, getNumber(getArrayElement(getArrayElement(a, 2), 0)));
+    EXPECT_EQ("x", getString(getArrayElement(getArrayElement(a, 2), 1)));
+    EXPECT_FALSE(objectFindKey(v, "x"));
+    EXPECT_EQ(LJSON_NULL, getType(getObjElement(v, "x")));
+
+    // the same json as the tree of ljson_parse
+    std::string s1, s2;
+    ljson_value dom;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&dom, "[0.1,-0,1e300,-140737488355329,\"\\\"\",{\"k\":[true]}]"));
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(&dom, s1));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_compact(&v, "[0.1,-0,1e300,-140737488355329,\"\\\"\",{\"k\":[true]}]", &arena));
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(v, s2));
+    EXPECT_EQ(s1, s2);
+    ljson_free(&dom);
+
+    EXPECT_EQ(LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, ljson_parse_compact(&v, "[1,[2}", &arena));
+    EXPECT_EQ(LJSON_NULL, getType(v));
+    EXPECT_EQ(LJSON_PARSE_ROOT_NOT_SINGULAR, ljson_parse_compact(&v, "1 2", &arena));
+    EXPECT_EQ(LJSON_NULL, getType(v));
+}
+
+TEST(test_compact, compact_values) {
+    EXPECT_EQ(LJSON_NULL, getType(ljson_compact()));
+    EXPECT_EQ(LJSON_NUMBER, getType(ljson_compact::from_double(-std::numeric_limits<double>::quiet_NaN())));
+    EXPECT_EQ(LJSON_NUMBER, getType(ljson_compact::from_double(-std::numeric_limits<double>::infinity())));
+    EXPECT_EQ(-0.0, getNumber(ljson_compact::from_double(-0.0)));
+    EXPECT_TRUE(std::signbit(getNumber(ljson_compact::from_double(-0.0))));
+    EXPECT_EQ(-(int64_t(1) << 47), getInt64(ljson_compact::from_int(-(int64_t(1) << 47))));
+    EXPECT_FALSE(ljson_compact::fits_int(int64_t(1) << 47));
+
+    // the numbers are stored in the nodes, which are at most half of the nodes of ljson_parse
+    EXPECT_GE(sizeof(ljson_value), 2 * sizeof(ljson_compact));
+    std::string json = "[";
+    for (int i = 0; i < 1000; i++)
+        json += std::to_string(i) + ".5,";
+    json += "0]";
+    ljson_arena arena;
+    ljson_compact v;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_compact(&v, json, &arena));
+    EXPECT_EQ(1001u, getArraySize(v));
+    EXPECT_EQ(999.5, getNumber(getArrayElement(v, 999)));
+    EXPECT_TRUE(v.nodes()[999].is_double());
+    EXPECT_EQ(999.5, v.nodes()[999].as_double());
+}
+
+/* the deepest nesting of the events */
+class DepthHandler : public ljson_base_handler<DepthHandler> {
+public:
+    size_t depth = 0, max_depth = 0, numbers = 0;
+    bool StartArray() { max_depth = std::max(max_depth, ++depth); return true; }
+    bool EndArray(size_t count) { EXPECT_EQ(1u, count); depth--; return true; }
+    bool Number(double) { numbers++; return true; }
+    bool Int64(int64_t) { numbers++; return true; }
+};
+
+inline std::string nested_json(size_t depth, const char* open, const char* value, char close) {
+    std::string json;
+    for (size_t i = 0; i < depth; i++)
+        json += open;
+    json += value;
+    json.append(depth, close);
+    return json;
+}
+
+TEST(test_parse, parse_depth) {
+    ljson_value v;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, nested_json(LJSON_MAX_DEPTH, "[", "1", ']')));
+    ljson_free(&v);
+    EXPECT_EQ(LJSON_PARSE_DEPTH_EXCEEDED, ljson_parse(&v, nested_json(LJSON_MAX_DEPTH + 1, "[", "1", ']')));
+    EXPECT_EQ(LJSON_PARSE_DEPTH_EXCEEDED, ljson_parse(&v, nested_json(LJSON_MAX_DEPTH + 1, "{\"a\":", "{}", '}')));
+    ljson_arena arena;
+    EXPECT_EQ(LJSON_PARSE_DEPTH_EXCEEDED, ljson_parse_lazy(&v, nested_json(LJSON_MAX_DEPTH + 1, "[", "[]", ']').data(),
+                                                           LJSON_MAX_DEPTH * 2 + 4, &arena));
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse(&v, "[[],{\"a\":[{\"b\":[1,{}]},2]},[[3]]]"));
+    std::string out;
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(&v, out));
+    EXPECT_EQ("[[],{\"a\":[{\"b\":[1,{}]},2]},[[3]]]", out);
+    ljson_free(&v);
+
+    ljson::Document js;
+    std::string doc;
+    js.SetMaxDepth(2);
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(doc = "[[1],{\"a\":2}]"));
+    EXPECT_EQ(LJSON_PARSE_DEPTH_EXCEEDED, js.Parse(doc = "[1,{\"a\":[]}]"));
+    EXPECT_EQ(LJSON_PARSE_MISS_COMMA_OR_CURLY_BRACKET, js.Parse(doc = "[{\"a\":1]"));
+    EXPECT_EQ(LJSON_PARSE_OK, js.Parse(doc = "{\"a\":[3]}"));
+    EXPECT_EQ(3.0, js["a"][0].GetNumber());
+}
+
+TEST(test_parse, parse_depth_stream) {
+    for (size_t depth = LJSON_MAX_DEPTH; depth <= LJSON_MAX_DEPTH + 1; depth++) {
+        std::string json = nested_json(depth, "[", "1", ']');
+        DepthHandler h;
+        StreamParser<DepthHandler> parser(h);
+        int ret = parser.Feed(json.data(), json.size());
+        if (ret == LJSON_PARSE_OK)
+            ret = parser.Finish();
+        EXPECT_EQ(depth == LJSON_MAX_DEPTH ? LJSON_PARSE_OK : LJSON_PARSE_DEPTH_EXCEEDED, ret);
+        EXPECT_EQ(LJSON_MAX_DEPTH, h.max_depth);
+    }
+    std::string json = nested_json(3, "[", "1", ']');
+    DepthHandler h;
+    StreamParser<DepthHandler> parser(h);
+    parser.SetMaxDepth(2);
+    EXPECT_EQ(LJSON_PARSE_DEPTH_EXCEEDED, parser.Feed(json.data(), json.size()));
+}
+
+TEST(test_parse, parse_depth_parallel) {
+    /* the elements are parsed apart from the root array, which is one level of them */
+    for (size_t depth = LJSON_MAX_DEPTH; depth <= LJSON_MAX_DEPTH + 1; depth++) {
+        std::string json = "[";
+        while (json.size() < 4 * 64 * 1024)
+            json += "[\"abcdefgh\",12345678],";
+        json += nested_json(depth - 1, "[", "1", ']') + "]";
+        ljson_value v;
+        ljson_init(&v);
+        EXPECT_EQ(depth == LJSON_MAX_DEPTH ? LJSON_PARSE_OK : LJSON_PARSE_DEPTH_EXCEEDED,
+                  ljson_parse_parallel(&v, json.data(), json.size(), 4));
+        ljson_free(&v);
+    }
+}
+
+TEST(test_parse, parse_depth_unlimited) {
+    // a million levels would overflow the stack of a recursive parser
+    std::string json = nested_json(1000000, "[", "1", ']');
+    DepthHandler h;
+    EXPECT_EQ(LJSON_PARSE_OK, ljson_parse_sax(h, json.data(), json.size(), SIZE_MAX));
+    EXPECT_EQ(1000000u, h.max_depth);
+    EXPECT_EQ(0u, h.depth);
+    EXPECT_EQ(1u, h.numbers);
+    DepthHandler h2;
+    EXPECT_EQ(LJSON_PARSE_DEPTH_EXCEEDED, ljson_parse_sax(h2, json.data(), json.size()));
+    EXPECT_EQ(LJSON_MAX_DEPTH, h2.max_depth);
+    json.pop_back();
+    EXPECT_EQ(LJSON_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, ljson_parse_sax(h, json.data(), json.size(), SIZE_MAX));
+}
+
+TEST(test_parse, parse_depth_unlimited_tree) {
+    // the walks over a tree are iterative too, a recursion would overflow the stack here
+    const size_t depth = 200000;
+    std::string json;
+    for (size_t i = 0; i < depth / 2; i++)
+        json += "{\"k\":[";
+    json += "\"a string longer than a short one\"";
+    for (size_t i = 0; i < depth / 2; i++)
+        json += "]}";
+    ljson_parse_buffers buffers;
+    buffers.max_depth = SIZE_MAX;
+    ljson_value v;
+    ljson_init(&v);
+    ASSERT_EQ(LJSON_PARSE_OK, ljson_parse(&v, json.data(), json.size(), nullptr, &buffers));
+    std::string out;
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(&v, out));
+    EXPECT_EQ(json, out);
+    ljson_value copy;
+    copy.copyfrom(v);
+    ljson_index_objects(&copy);
+    out.clear();
+    EXPECT_EQ(LJSON_STRINGIFY_OK, ljson_stringify(&copy, out));
+    EXPECT_EQ(json, out);
+    ljson_free(&copy);
+    ljson_free(&v);
+
+    ljson::Document js;
+    js.SetMaxDepth(SIZE_MAX);
+    js.SetIndexObjects(true);
+    ASSERT_EQ(LJSON_PARSE_OK, js.Parse(json));
+    EXPECT_EQ(json, js.cpp_str());
+    ASSERT_EQ(LJSON_PARSE_OK, js.Parse(json));
+}
+
+TEST(test_reader, reader_skip_without_allocation) {
+    // the skipped values are nested as deep as the default limit allows
+    std::string json = "{\"skip\":" + nested_json(LJSON_MAX_DEPTH, "{\"a\":", "null", '}') +
+                       ",\"list\":[[1,[2]],{\"x\":[{}]},3],\"last\":" + nested_json(LJSON_MAX_DEPTH, "[", "1", ']') + "}";
+    size_t before = allocations;
+    Reader r(json);
+    const char* key;
+    size_t len;
+    ASSERT_TRUE(r.EnterObject());
+    ASSERT_TRUE(r.NextKey(&key, &len));
+    ASSERT_TRUE(r.NextKey(&key, &len));
+    ASSERT_TRUE(r.EnterArray());
+    while (r.NextElement())
+        ;
+    ASSERT_TRUE(r.NextKey(&key, &len));
+    EXPECT_TRUE(r.SkipValue());
+    EXPECT_FALSE(r.NextKey(&key, &len));
+    EXPECT_EQ(LJSON_PARSE_OK, r.Finish());
+    EXPECT_EQ(before, size_t(allocations));
+}